@@ -32,5 +32,5 @@ void autoDetectDockPosition(WindowInfo* winInfo) {
     }
 }
 void addAutoDetectDockPosition() {
-    addEvent(WINDOW_MOVE, DEFAULT_EVENT(autoDetectDockPosition, LOWER_PRIORITY));
+    addEvent(WINDOW_MOVE, DEFAULT_EVENT(autoDetectDockPosition, LOWER_PRIORITY, .precondition = {.flags = DOCKS_ONLY}));
 }
@@ -11,9 +11,7 @@
 #include "containers.h"
 
 static xcb_atom_t MPX_CONTAINER = 0;
-static void initContainerAtoms() {
-    CREATE_ATOM(MPX_CONTAINER);
-}
+static const AtomBinding containerAtoms[] = {ATOM_BINDING(MPX_CONTAINER)};
 
 
 WindowInfo* getWindowInfoForContainer(MonitorID mon) {
@@ -97,9 +95,9 @@ void toggleContainer(WindowInfo* winInfo) {
 }
 
 void addContainerRules() {
-    addEvent(X_CONNECTION, DEFAULT_EVENT(initContainerAtoms, HIGHEST_PRIORITY));
-    addEvent(XCB_MAP_NOTIFY, DEFAULT_EVENT(onContainerMapEvent));
-    addEvent(XCB_UNMAP_NOTIFY, DEFAULT_EVENT(onContainerUnmapEvent));
+    addAtomsToCreate(containerAtoms, LEN(containerAtoms));
+    addEvent(XCB_MAP_NOTIFY, DEFAULT_EVENT(onContainerMapEvent, .precondition = {.flags = MANAGED_WINDOWS_ONLY}));
+    addEvent(XCB_UNMAP_NOTIFY, DEFAULT_EVENT(onContainerUnmapEvent, .precondition = {.flags = MANAGED_WINDOWS_ONLY}));
     addEvent(UNREGISTER_WINDOW, DEFAULT_EVENT(onContainerUnregegister));
     addEvent(WINDOW_MOVE, DEFAULT_EVENT(updateContainerMonitorOnWindowMove));
 }
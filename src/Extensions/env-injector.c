@@ -29,9 +29,10 @@ void setClientMasterEnvVar(void) {
         if(getFocusedWindow()) {
             sprintf(strValue, "%u", getFocusedWindow()->id);
             setenv("_WIN_ID", strValue, 1);
-            setenv("_WIN_TITLE", getFocusedWindow()->title, 1);
-            setenv("_WIN_CLASS", getFocusedWindow()->className, 1);
-            setenv("_WIN_INSTANCE", getFocusedWindow()->instanceName, 1);
+            WindowProperties* properties = getWindowProperties(getFocusedWindow());
+            setenv("_WIN_TITLE", properties->title, 1);
+            setenv("_WIN_CLASS", properties->className, 1);
+            setenv("_WIN_INSTANCE", properties->instanceName, 1);
             setEnvRect("WIN", getFocusedWindow()->geometry);
         }
         Monitor* m = getActiveWorkspace() ? getMonitor(getActiveWorkspace()) : NULL;
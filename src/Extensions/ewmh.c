@@ -21,8 +21,8 @@
 xcb_ewmh_client_source_type_t source = XCB_EWMH_CLIENT_SOURCE_TYPE_OTHER;
 
 bool isMPXManagerRunningAsWM(void) {
-    xcb_get_selection_owner_reply_t* ownerReply = xcb_get_selection_owner_reply(dis, xcb_get_selection_owner(dis,
-                WM_SELECTION_ATOM), NULL);
+    xcb_get_selection_owner_reply_t* ownerReply = X_ROUND_TRIP(xcb_get_selection_owner_reply(dis, xcb_get_selection_owner(dis,
+                WM_SELECTION_ATOM), NULL));
     bool result = 0;
     if(ownerReply && ownerReply->owner) {
         char buffer[MAX_NAME_LEN];
@@ -89,8 +89,8 @@ void updateWorkspaceNames() {
 
 WorkspaceID getSavedWorkspaceIndex(WindowID win) {
     WorkspaceID workspaceIndex = getActiveWorkspaceIndex();
-    if((xcb_ewmh_get_wm_desktop_reply(ewmh,
-                xcb_ewmh_get_wm_desktop(ewmh, win), &workspaceIndex, NULL))) {
+    if((X_ROUND_TRIP(xcb_ewmh_get_wm_desktop_reply(ewmh,
+                xcb_ewmh_get_wm_desktop(ewmh, win), &workspaceIndex, NULL)))) {
         if(workspaceIndex != NO_WORKSPACE && workspaceIndex >= getNumberOfWorkspaces()) {
             workspaceIndex = getNumberOfWorkspaces() - 1;
         }
@@ -119,7 +119,7 @@ void setXWindowStateFromMaskAndUnsyncedAtoms(WindowInfo* winInfo, xcb_atom_t* at
     INFO("Setting X State for window %d from masks  %d %s; Add %d", winInfo->id, winInfo->mask,
         getMaskAsString(winInfo->mask & getMasksToSync(winInfo), NULL), action);
     xcb_ewmh_get_atoms_reply_t reply;
-    bool hasState = xcb_ewmh_get_wm_state_reply(ewmh, xcb_ewmh_get_wm_state(ewmh, winInfo->id), &reply, NULL);
+    bool hasState = X_ROUND_TRIP(xcb_ewmh_get_wm_state_reply(ewmh, xcb_ewmh_get_wm_state(ewmh, winInfo->id), &reply, NULL));
     xcb_atom_t windowState[sizeof(WindowMask) * 8 + (hasState ? reply.atoms_len : 0)];
     int n = 0;
 
@@ -173,8 +173,8 @@ void updateXWindowStateForAllWindows() {
 
 bool setWindowStateFromAtomInfo(WindowInfo* winInfo, const xcb_atom_t* atoms, uint32_t numberOfAtoms, int action) {
     assert(numberOfAtoms);
-    INFO("Setting window masks for window %d %s current masks %d from %d atoms; Action %d", winInfo->id, winInfo->title,
-        winInfo->mask,  numberOfAtoms, action);
+    INFO("Setting window masks for window %d %s current masks %d from %d atoms; Action %d", winInfo->id,
+        getWindowProperties(winInfo)->title, winInfo->mask,  numberOfAtoms, action);
     LOG_RUN(LOG_LEVEL_DEBUG, dumpAtoms(atoms, numberOfAtoms));
     WindowMask mask = 0;
     for(unsigned int i = 0; i < numberOfAtoms; i++) {
@@ -193,7 +193,7 @@ bool setWindowStateFromAtomInfo(WindowInfo* winInfo, const xcb_atom_t* atoms, ui
 }
 void loadSavedAtomState(WindowInfo* winInfo) {
     xcb_ewmh_get_atoms_reply_t reply;
-    if(xcb_ewmh_get_wm_state_reply(ewmh, xcb_ewmh_get_wm_state(ewmh, winInfo->id), &reply, NULL)) {
+    if(X_ROUND_TRIP(xcb_ewmh_get_wm_state_reply(ewmh, xcb_ewmh_get_wm_state(ewmh, winInfo->id), &reply, NULL))) {
         if(reply.atoms_len)
             setWindowStateFromAtomInfo(winInfo, reply.atoms, reply.atoms_len, XCB_EWMH_WM_STATE_ADD);
         xcb_ewmh_get_atoms_reply_wipe(&reply);
@@ -206,13 +206,13 @@ void loadDockProperties(WindowInfo* winInfo) {
     TRACE("Reloading dock properties");
     xcb_window_t win = winInfo->id;
     xcb_ewmh_wm_strut_partial_t strut;
-    if(xcb_ewmh_get_wm_strut_partial_reply(ewmh,
-            xcb_ewmh_get_wm_strut_partial(ewmh, win), &strut, NULL)) {
+    if(X_ROUND_TRIP(xcb_ewmh_get_wm_strut_partial_reply(ewmh,
+            xcb_ewmh_get_wm_strut_partial(ewmh, win), &strut, NULL))) {
         setDockProperties(winInfo, (int*)&strut, 1);
     }
-    else if(xcb_ewmh_get_wm_strut_reply(ewmh,
+    else if(X_ROUND_TRIP(xcb_ewmh_get_wm_strut_reply(ewmh,
             xcb_ewmh_get_wm_strut(ewmh, win),
-            (xcb_ewmh_get_extents_reply_t*) &strut, NULL))
+            (xcb_ewmh_get_extents_reply_t*) &strut, NULL)))
         setDockProperties(winInfo, (int*)&strut, 0);
     else {
         TRACE("could not read struct data");
@@ -244,13 +244,13 @@ void setShowingDesktop(int value) {
 
 bool isShowingDesktop(void) {
     unsigned int value = 0;
-    xcb_ewmh_get_showing_desktop_reply(ewmh, xcb_ewmh_get_showing_desktop(ewmh, defaultScreenNumber), &value, NULL);
+    X_ROUND_TRIP(xcb_ewmh_get_showing_desktop_reply(ewmh, xcb_ewmh_get_showing_desktop(ewmh, defaultScreenNumber), &value, NULL));
     return value;
 }
 
 void syncShowingDesktop() {
     unsigned int value = 0;
-    xcb_ewmh_get_showing_desktop_reply(ewmh, xcb_ewmh_get_showing_desktop(ewmh, defaultScreenNumber), &value, NULL);
+    X_ROUND_TRIP(xcb_ewmh_get_showing_desktop_reply(ewmh, xcb_ewmh_get_showing_desktop(ewmh, defaultScreenNumber), &value, NULL));
     setShowingDesktop(value);
 }
 
@@ -442,13 +442,14 @@ void addEWMHRules() {
     addBatchEvent(IDLE, DEFAULT_EVENT(updateXWindowStateForAllWindows));
     addBatchEvent(UNREGISTER_WINDOW, DEFAULT_EVENT(updateEWMHClientList));
     addEvent(CLIENT_MAP_ALLOW, DEFAULT_EVENT(autoResumeWorkspace));
-    addEvent(CLIENT_MAP_ALLOW, DEFAULT_EVENT(loadDockProperties));
+    addEvent(CLIENT_MAP_ALLOW, DEFAULT_EVENT(loadDockProperties, .precondition = {.flags = DOCKS_ONLY}));
     addEvent(CLIENT_MAP_ALLOW, DEFAULT_EVENT(loadSavedAtomState));
     addEvent(IDLE, DEFAULT_EVENT(setActiveProperties));
     addEvent(WORKSPACE_WINDOW_ADD, DEFAULT_EVENT(setSavedWorkspaceIndex));
     addEvent(XCB_CLIENT_MESSAGE, DEFAULT_EVENT(onClientMessage));
-    addEvent(XCB_MAP_NOTIFY, DEFAULT_EVENT(autoFocus));
-    addEvent(XCB_PROPERTY_NOTIFY, DEFAULT_EVENT(updateDockProperties));
+    addEvent(XCB_MAP_NOTIFY, DEFAULT_EVENT(autoFocus, .precondition = {.flags = MANAGED_WINDOWS_ONLY}));
+    addEvent(XCB_PROPERTY_NOTIFY, DEFAULT_EVENT(updateDockProperties,
+            .precondition = {MAPPED_MASK, .flags = DOCKS_ONLY}));
     addEvent(X_CONNECTION, DEFAULT_EVENT(broadcastEWMHCompilence, HIGHER_PRIORITY));
     addEvent(X_CONNECTION, DEFAULT_EVENT(syncShowingDesktop));
 }
@@ -48,7 +48,7 @@ void printStatusMethod(void) {
     if(getFocusedWindow() && isNotInInvisibleWorkspace(getFocusedWindow())) {
         if(isLogging(LOG_LEVEL_DEBUG))
             dprintf(STATUS_FD, "%0x ", getFocusedWindow()->id);
-        dprintf(STATUS_FD, "^fg(%s)%s^fg()", "green", getFocusedWindow()->title);
+        dprintf(STATUS_FD, "^fg(%s)%s^fg()", "green", getWindowProperties(getFocusedWindow())->title);
     }
     else {
         dprintf(STATUS_FD, "Focused on %x (root: %x)", getActiveFocus(), root);
@@ -78,13 +78,11 @@ void addDesktopRule() {
 static void stickyPrimaryMonitor() {
     Monitor* primary = getPrimaryMonitor();
     if(primary) {
-        FOR_EACH(WindowInfo*, winInfo, getAllWindows()) {
-            if(hasMask(winInfo, PRIMARY_MONITOR_MASK)) {
-                if(getWorkspaceOfWindow(winInfo) && getWorkspaceOfMonitor(primary))
-                    moveToWorkspace(winInfo, getWorkspaceOfMonitor(primary)->id);
-                else
-                    arrangeNonTileableWindow(winInfo, primary);
-            }
+        FOR_EACH_WINDOW_WITH_MASK(winInfo, PRIMARY_MONITOR_MASK) {
+            if(getWorkspaceOfWindow(winInfo) && getWorkspaceOfMonitor(primary))
+                moveToWorkspace(winInfo, getWorkspaceOfMonitor(primary)->id);
+            else
+                arrangeNonTileableWindow(winInfo, primary);
         }
     }
 }
@@ -104,20 +102,20 @@ void addKeepTransientsOnTopRule() {
     addEvent(WINDOW_MOVE, DEFAULT_EVENT(keepTransientsOnTop));
 }
 void shiftWindowToPositionInWorkspaceStack(WindowInfo* winInfo, InsertWindowPosition arg) {
-    ArrayList* stack = getWorkspaceWindowStack(getWorkspaceOfWindow(winInfo));
-    if(winInfo->creationTime && peek(stack) == winInfo) {
-        int index = getFocusedWindow() ? getIndex(stack, getFocusedWindow(), sizeof(WindowID)) : -1;
+    WindowStack* stack = getWorkspaceWindowStack(getWorkspaceOfWindow(winInfo));
+    if(winInfo->creationTime && stack->data[stack->size - 1] == winInfo) {
+        int index = getFocusedWindow() ? WindowStackIndexOf(stack, getFocusedWindow()) : -1;
         if(index == -1 && arg != HEAD_OF_STACK)
             return;
         switch(arg) {
             case HEAD_OF_STACK:
-                shiftToHead(stack, stack->size - 1);
+                WindowStackMove(stack, stack->size - 1, 0);
                 break;
             case BEFORE_FOCUSED:
-                shiftToPos(stack, stack->size - 1, index);
+                WindowStackMove(stack, stack->size - 1, index);
                 break;
             case AFTER_FOCUSED:
-                shiftToPos(stack, stack->size - 1, index + 1);
+                WindowStackMove(stack, stack->size - 1, index + 1);
         }
     }
 }
@@ -160,7 +158,8 @@ static bool unregisterNonTopLevelWindows(xcb_reparent_notify_event_t* event) {
 }
 
 void addIgnoreNonTopLevelWindowsRule() {
-    addEvent(XCB_REPARENT_NOTIFY, FILTER_EVENT(unregisterNonTopLevelWindows, .abort = 1));
+    addEvent(XCB_REPARENT_NOTIFY, FILTER_EVENT(unregisterNonTopLevelWindows, .abort = 1,
+            .precondition = {.flags = MANAGED_WINDOWS_ONLY}));
 }
 void onReparentEvent(xcb_reparent_notify_event_t* event) {
     WindowInfo* winInfo = getWindowInfo(event->window);
@@ -84,7 +84,7 @@ static inline void attachAllSlavesToMaster(Master* currentMaster, Master* newMas
 
 Master* createNewMaster() {
     char name[32];
-    sprintf(name, "dummy%d", getTime());
+    sprintf(name, "dummy%lu", getTime());
     createMasterDevice(name);
     initCurrentMasters();
     return getMasterByName(name);
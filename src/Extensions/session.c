@@ -50,19 +50,19 @@ typedef struct {
 } MonitorIDBounds;
 
 
-static void initSessionAtoms() {
-    CREATE_ATOM(MPX_WM_ACTIVE_MASTER);
-    CREATE_ATOM(MPX_WM_FAKE_MONITORS);
-    CREATE_ATOM(MPX_WM_FAKE_MONITORS_NAMES);
-    CREATE_ATOM(MPX_WM_MASKS);
-    CREATE_ATOM(MPX_WM_MASKS_STR);
-    CREATE_ATOM(MPX_WM_MASTER_WINDOWS);
-    CREATE_ATOM(MPX_WM_MASTER_WORKSPACES);
-    CREATE_ATOM(MPX_WM_WORKSPACE_LAYOUT_INDEXES);
-    CREATE_ATOM(MPX_WM_WORKSPACE_LAYOUT_NAMES);
-    CREATE_ATOM(MPX_WM_WORKSPACE_MONITORS);
-    CREATE_ATOM(MPX_WM_WORKSPACE_ORDER);
-}
+static const AtomBinding sessionAtoms[] = {
+    ATOM_BINDING(MPX_WM_ACTIVE_MASTER),
+    ATOM_BINDING(MPX_WM_FAKE_MONITORS),
+    ATOM_BINDING(MPX_WM_FAKE_MONITORS_NAMES),
+    ATOM_BINDING(MPX_WM_MASKS),
+    ATOM_BINDING(MPX_WM_MASKS_STR),
+    ATOM_BINDING(MPX_WM_MASTER_WINDOWS),
+    ATOM_BINDING(MPX_WM_MASTER_WORKSPACES),
+    ATOM_BINDING(MPX_WM_WORKSPACE_LAYOUT_INDEXES),
+    ATOM_BINDING(MPX_WM_WORKSPACE_LAYOUT_NAMES),
+    ATOM_BINDING(MPX_WM_WORKSPACE_MONITORS),
+    ATOM_BINDING(MPX_WM_WORKSPACE_ORDER),
+};
 
 static void loadSavedLayouts() {
     xcb_get_property_reply_t* reply = getWindowProperty(root, MPX_WM_WORKSPACE_LAYOUT_NAMES, ewmh->UTF8_STRING);
@@ -169,7 +169,8 @@ static void loadSavedWorkspaceWindows() {
                 WindowInfo* winInfo = getWindowInfo(wid[i]);
                 if(winInfo && getWorkspaceIndexOfWindow(winInfo) == workspaceID) {
                     Workspace* w = getWorkspace(workspaceID);
-                    shiftToEnd(getWorkspaceWindowStack(w), getIndex(getWorkspaceWindowStack(w), winInfo, sizeof(WindowID)));
+                    WindowStackMove(getWorkspaceWindowStack(w), WindowStackIndexOf(getWorkspaceWindowStack(w), winInfo),
+                        getWorkspaceWindowStack(w)->size - 1);
                 }
             }
     }
@@ -310,7 +311,7 @@ void saveCustomState(void) {
         layoutOffsets[i] = getLayoutOffset(getWorkspace(i));
         Layout* layout = getLayout(getWorkspace(i));
         addString(&joiner, (layout ? layout->name : ""));
-        FOR_EACH(WindowInfo*, winInfo, getWorkspaceWindowStack(getWorkspace(i))) {
+        FOR_EACH_VALUE(WindowInfo*, winInfo, getWorkspaceWindowStack(getWorkspace(i))) {
             workspaceWindows[numWorkspaceWindows++] = winInfo->id;
         }
         workspaceWindows[numWorkspaceWindows++] = 0;
@@ -333,11 +334,11 @@ void saveCustomState(void) {
     freeBuffer(&joiner);
 }
 void addResumeCustomStateRules() {
+    addAtomsToCreate(sessionAtoms, LEN(sessionAtoms));
     addBatchEvent(MONITOR_WORKSPACE_CHANGE, DEFAULT_EVENT(saveMonitorWorkspaceMapping, LOWEST_PRIORITY));
     addBatchEvent(SCREEN_CHANGE, DEFAULT_EVENT(loadSavedMonitorWorkspaceMapping));
     addBatchEvent(SCREEN_CHANGE, DEFAULT_EVENT(saveMonitorWorkspaceMapping, LOWEST_PRIORITY));
     addEvent(IDLE, DEFAULT_EVENT(saveCustomState, LOWER_PRIORITY));
-    addEvent(X_CONNECTION, DEFAULT_EVENT(initSessionAtoms, HIGHEST_PRIORITY));
     addEvent(X_CONNECTION, DEFAULT_EVENT(loadSavedNonWindowState, HIGHER_PRIORITY));
     addEvent(X_CONNECTION, DEFAULT_EVENT(loadSavedWindowState));
 }
@@ -3,6 +3,7 @@
 #include "../tester.h"
 #include "../test-wm-helper.h"
 #include "../../Extensions/env-injector.h"
+#include "../../util/string-table.h"
 static void childEnvSetup() {
     onChildSpawn = setClientMasterEnvVar;
 }
@@ -11,9 +12,9 @@ SCUTEST_ITER(spawn_env, 2) {
     bool large = _i;
     createSimpleEnv();
     WindowInfo* winInfo = addFakeWindowInfo(large ? 1 << 31 : 1);
-    strcpy(winInfo->title,"someTitle");
-    strcpy(winInfo->className,"someClass");
-    strcpy(winInfo->instanceName,"someInstance");
+    strcpy(getWindowProperties(winInfo)->title,"someTitle");
+    replaceInternedString(&getWindowProperties(winInfo)->className, "someClass");
+    replaceInternedString(&getWindowProperties(winInfo)->instanceName, "someInstance");
     onWindowFocus(winInfo->id);
     Monitor*m=addFakeMonitor((Rect) {0, -3, 2, (large ? 1<<16 -1 : 1)});
     assignUnusedMonitorsToWorkspaces();
@@ -26,9 +27,9 @@ SCUTEST_ITER(spawn_env, 2) {
         assertEqualsStr(getenv(DEFAULT_POINTER_ENV_VAR_NAME), buffer) ;
         sprintf(buffer, "%u", winInfo->id);
         assertEqualsStr(getenv("_WIN_ID"), buffer);
-        assertEqualsStr(getenv("_WIN_TITLE"), winInfo->title);
-        assertEqualsStr(getenv("_WIN_CLASS"), winInfo->className);
-        assertEqualsStr(getenv("_WIN_INSTANCE"), winInfo->instanceName);
+        assertEqualsStr(getenv("_WIN_TITLE"), getWindowProperties(winInfo)->title);
+        assertEqualsStr(getenv("_WIN_CLASS"), getWindowProperties(winInfo)->className);
+        assertEqualsStr(getenv("_WIN_INSTANCE"), getWindowProperties(winInfo)->instanceName);
         assertEqualsStr(getenv("_MON_X"),"0");
         sprintf(buffer, "%u", m->base.y);
         assertEqualsStr(getenv("_MON_Y"), buffer);
@@ -92,7 +92,7 @@ SCUTEST(client_list) {
     assert(xcb_ewmh_get_client_list_reply(ewmh, xcb_ewmh_get_client_list(ewmh, defaultScreenNumber), &reply, NULL));
     int size = reply.windows_len;
     assertEquals(size, getAllWindows()->size);
-    verifyWindowStack(getAllWindows(), reply.windows);
+    verifyWindowList(getAllWindows(), reply.windows);
     xcb_ewmh_get_windows_reply_wipe(&reply);
     // we get focus out event before destroy event
     CRASH_ON_ERRORS = 0;
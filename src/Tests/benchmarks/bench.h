@@ -0,0 +1,21 @@
+#ifndef MPX_BENCH_H_
+#define MPX_BENCH_H_
+
+#include <stdio.h>
+
+#include "../../util/time.h"
+#include "../tester.h"
+
+/**
+ * Runs code iter times and prints the average cost of a single iteration
+ *
+ * @param name label of the benchmark
+ * @param size the size of the input; used to compare runs of the same benchmark
+ * @param iter number of times to run code
+ */
+#define BENCHMARK(name, size, iter, code...) do { \
+    long __start = getTimeNs(); \
+    for(long __n = 0; __n < (iter); __n++) { code; } \
+    printf("%-40s %8ld %12.2f ns/op\n", name, (long)(size), (getTimeNs() - __start) / (double)(iter)); \
+} while(0)
+#endif
@@ -0,0 +1,44 @@
+#include "../../boundfunction.h"
+#include "../../util/histogram.h"
+
+#include "bench.h"
+
+static void noop() {}
+
+SCUTEST(bench_histogram) {
+    static Histogram histogram;
+    BENCHMARK("addHistogramValue", 1, 10000000, addHistogramValue(&histogram, __n * 7919));
+    BENCHMARK("getTimeNs", 1, 10000000, addHistogramValue(&histogram, getTimeNs()));
+}
+SCUTEST(bench_apply_event_rules) {
+    int sizes[] = {0, 1, 10, 50};
+    int n = 0;
+    for(int i = 0; i < LEN(sizes); i++) {
+        for(; n < sizes[i]; n++)
+            addEvent(0, DEFAULT_EVENT(noop, n % 3 - 1));
+        BENCHMARK("applyEventRules", sizes[i], 1000000, applyEventRules(0, NULL));
+    }
+}
+SCUTEST(bench_apply_batch_event_rules) {
+    for(int i = 0; i < NUMBER_OF_MPX_EVENTS; i++)
+        addBatchEvent(i, DEFAULT_EVENT(noop));
+    int sizes[] = {0, 1, 10};
+    for(int i = 0; i < LEN(sizes); i++)
+        BENCHMARK("applyBatchEventRules", sizes[i], 1000000,
+            for(int type = 0; type < sizes[i]; type++) incrementBatchEventRuleCounter(type); applyBatchEventRules());
+}
+SCUTEST(bench_apply_skipped_event_rules) {
+    xcb_map_notify_event_t event = {.response_type = XCB_MAP_NOTIFY, .window = 1};
+    int sizes[] = {1, 10, 50};
+    int n = 0;
+    for(int i = 0; i < LEN(sizes); i++) {
+        for(; n < sizes[i]; n++)
+            addEvent(XCB_MAP_NOTIFY, DEFAULT_EVENT(noop, n % 3 - 1, .precondition = {.flags = MANAGED_WINDOWS_ONLY}));
+        BENCHMARK("applyEventRules/skipped", sizes[i], 1000000, applyEventRules(XCB_MAP_NOTIFY, &event));
+    }
+}
+SCUTEST(bench_add_remove_rule) {
+    for(int n = 0; n < 50; n++)
+        addEvent(0, DEFAULT_EVENT(noop, n % 3 - 1));
+    BENCHMARK("addEvent/removeRule", 50, 1000000, removeRule(addEvent(0, DEFAULT_EVENT(noop))));
+}
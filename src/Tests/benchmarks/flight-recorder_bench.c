@@ -0,0 +1,21 @@
+#include "../../util/flight-recorder.h"
+#include "../../util/logger.h"
+
+#include "bench.h"
+
+SCUTEST(bench_log_message) {
+    setLogLevel(LOG_LEVEL_NONE);
+    setFlightRecorderLevel(LOG_LEVEL_INFO);
+    pushContext("BENCH");
+    BENCHMARK("DEBUG/dropped", 1, 10000000, DEBUG("Running func: %s %p", "name", NULL));
+    BENCHMARK("INFO/recorded", 1, 10000000, INFO("Running func: %s %p", "name", NULL));
+    BENCHMARK("INFO/recorded/4-ints", 4, 10000000, INFO("%d %d %ld %d", 1, 2, 3L, 4));
+    popContext();
+}
+SCUTEST(bench_flush_flight_recorder) {
+    setLogLevel(LOG_LEVEL_NONE);
+    setFlightRecorderLevel(LOG_LEVEL_INFO);
+    assert(startFlushingFlightRecorder("/dev/null"));
+    BENCHMARK("INFO/recorded+flushed", 1, 1000000, INFO("Running func: %s %p", "name", NULL));
+    stopFlushingFlightRecorder();
+}
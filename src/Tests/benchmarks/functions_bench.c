@@ -0,0 +1,26 @@
+#include "../../functions.h"
+#include "../../util/string-table.h"
+#include "../../windows.h"
+
+#include "../test-mpx-helper.h"
+#include "bench.h"
+
+SCUTEST_SET_ENV(createSimpleEnv, simpleCleanup);
+SCUTEST(bench_matches_class) {
+    int sizes[] = {100, 1000, 10000};
+    char buffer[32];
+    int n = 0;
+    volatile int result = 0;
+    for(int i = 0; i < LEN(sizes); i++) {
+        for(; n < sizes[i]; n++) {
+            WindowProperties* properties = getWindowProperties(addFakeWindowInfo(n + 1));
+            sprintf(buffer, "application-class-%d", n % 16);
+            replaceInternedString(&properties->className, buffer);
+            replaceInternedString(&properties->instanceName, buffer + strlen("application-"));
+        }
+        const char* str = internString("application-class-15");
+        BENCHMARK("matchesClass scan", sizes[i], 1000000 / sizes[i],
+            FOR_EACH(WindowInfo*, winInfo, getAllWindows()) {result += matchesClass(winInfo, str);});
+        releaseString(str);
+    }
+}
@@ -0,0 +1,30 @@
+#include "../../masters.h"
+#include "../../windows.h"
+
+#include "../test-mpx-helper.h"
+#include "bench.h"
+
+SCUTEST_SET_ENV(createSimpleEnv, simpleCleanup);
+SCUTEST(bench_focus_stack) {
+    int numMasters = 16;
+    int sizes[] = {100, 1000};
+    for(int i = 1; i < numMasters; i++)
+        addFakeMaster(i * 100, i * 100 + 1);
+    WindowID next = 1;
+    for(int i = 0; i < LEN(sizes); i++) {
+        while(getAllWindows()->size < sizes[i]) {
+            addFakeWindowInfo(next);
+            FOR_EACH(Master*, master, getAllMasters()) {
+                onWindowFocusForMaster(next, master);
+            }
+            next++;
+        }
+        BENCHMARK("onWindowFocus", sizes[i], 100000, onWindowFocus(next - 1 - __n * 7 % sizes[i]));
+        BENCHMARK("create/focus/destroy window", sizes[i], 10000,
+            WindowInfo* winInfo = addFakeWindowInfo(next);
+            FOR_EACH(Master*, master, getAllMasters()) {
+                onWindowFocusForMaster(next, master);
+            }
+            freeWindowInfo(winInfo));
+    }
+}
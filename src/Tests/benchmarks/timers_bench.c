@@ -0,0 +1,25 @@
+#include "../../timers.h"
+#include "../../util/time.h"
+
+#include "bench.h"
+
+static void noop() {}
+
+SCUTEST(bench_timer_add_cancel) {
+    int sizes[] = {0, 1000, 100000};
+    int n = 0;
+    for(int i = 0; i < LEN(sizes); i++) {
+        for(; n < sizes[i]; n++)
+            addTimer(n % 1000000, noop, NULL);
+        BENCHMARK("addTimer/cancelTimer", sizes[i], 1000000, cancelTimer(addTimer(__n % 100000, noop, NULL)));
+    }
+}
+SCUTEST(bench_timer_expire) {
+    int sizes[] = {1000, 100000};
+    for(int i = 0; i < LEN(sizes); i++) {
+        TimeStamp now = getTime();
+        for(int n = 0; n < sizes[i]; n++)
+            addTimer(n % 10000, noop, NULL);
+        BENCHMARK("runExpiredTimers", sizes[i], 1, runExpiredTimers(now + 10000));
+    }
+}
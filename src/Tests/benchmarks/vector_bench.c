@@ -0,0 +1,36 @@
+#include "../../util/arraylist.h"
+#include "../../util/vector.h"
+#include "../../windows.h"
+
+#include "../test-mpx-helper.h"
+#include "bench.h"
+
+DECLARE_SCALAR_VECTOR(WindowID, WindowIDVector)
+
+SCUTEST_SET_ENV(createSimpleEnv, simpleCleanup);
+SCUTEST(bench_vector_vs_arraylist) {
+    int sizes[] = {10, 100, 1000};
+    int n = 0;
+    ArrayList list = {0};
+    WindowIDVector vec = {0};
+    volatile long result = 0;
+    for(int i = 0; i < LEN(sizes); i++) {
+        for(; n < sizes[i]; n++) {
+            addElement(&list, addFakeWindowInfo(n + 1));
+            WindowIDVectorAdd(&vec, n + 1);
+        }
+        WindowID target = sizes[i];
+        WindowInfo* targetInfo = getWindowInfo(target);
+        BENCHMARK("ArrayList getIndex", sizes[i], 100000, result += getIndex(&list, &target, sizeof(WindowID)));
+        BENCHMARK("ArrayList getIndexOfPtr", sizes[i], 100000, result += getIndexOfPtr(&list, targetInfo));
+        BENCHMARK("Vector IndexOf", sizes[i], 100000, result += WindowIDVectorIndexOf(&vec, target));
+        BENCHMARK("Vector BinarySearch", sizes[i], 100000, result += WindowIDVectorBinarySearch(&vec, target));
+        BENCHMARK("ArrayList iterate", sizes[i], 100000, FOR_EACH(WindowInfo*, winInfo, &list) {result += winInfo->id;});
+        BENCHMARK("Vector iterate", sizes[i], 100000, FOR_EACH_VECTOR(WindowID, win, &vec) {result += *win;});
+        BENCHMARK("ArrayList remove/add head", sizes[i], 100000, addElementAt(&list, removeIndex(&list, 0), 0));
+        BENCHMARK("Vector remove/insert head", sizes[i], 100000,
+            WindowIDVectorInsert(&vec, 0, WindowIDVectorRemoveIndex(&vec, 0)));
+    }
+    clearArray(&list);
+    WindowIDVectorClear(&vec);
+}
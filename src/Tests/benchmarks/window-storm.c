@@ -0,0 +1,324 @@
+/**
+ * @file window-storm.c
+ * @brief End to end benchmark that drives a running mpxmanager with a synthetic client
+ *
+ * Usage: window-storm [-o FILE] [N...]
+ *
+ * For each N a fresh mpxmanager ($MPXMANAGER or ./mpxmanager) is started and the client creates, maps, configures
+ * and destroys N windows, switches workspaces and cycles layouts through EWMH requests and key bindings sent with
+ * xtest. The results are written as JSON to FILE (default stdout) so runs of different versions can be diffed.
+ *
+ * The WM publishes its idle count, the number of events it processed, the number of requests it sent (as far as
+ * trackRequest knows) and the number of round trips it made in MPX_IDLE_PROPERTY every time it goes idle. Each step waits for that property to change
+ * and only measures up to the last event the client received because of the step, so the idle timeout itself is not
+ * counted.
+ */
+#include <poll.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../../util/histogram.h"
+#include "../../util/time.h"
+#include "../../xutil/test-functions.h"
+#include "../test-wm-helper.h"
+
+/// how long to wait for the WM to respond to a step before giving up
+#define STEP_TIMEOUT_MS 60000
+/// number of times each workspace/binding/layout step is repeated
+#define STEP_REPEATS 20
+
+/// the values the WM publishes in MPX_IDLE_PROPERTY
+typedef struct {
+    uint32_t idle;
+    uint32_t events;
+    uint32_t requests;
+    uint32_t roundTrips;
+} WMCounters;
+
+static FILE* output;
+static int wmPid;
+static WindowID wmWindow;
+
+/// the client windows; xcb hands out ids in increasing order so they can be binary searched
+static WindowID* windows;
+static uint32_t numberOfWindows;
+/// when each window was mapped and when it was last mapped/configured by the WM
+static TimeStamp* mapTime;
+static TimeStamp* tiledTime;
+static uint32_t numberOfMappedWindows;
+
+/// the time the last event caused by the current step was received
+static TimeStamp lastEventTime;
+/// the time _NET_CURRENT_DESKTOP last changed
+static TimeStamp desktopChangeTime;
+
+static int compareWindows(const void* a, const void* b) {
+    WindowID winA = *(const WindowID*)a, winB = *(const WindowID*)b;
+    return winA < winB ? -1 : winA > winB;
+}
+static int getWindowIndex(WindowID win) {
+    WindowID* match = bsearch(&win, windows, numberOfWindows, sizeof(WindowID), compareWindows);
+    return match ? match - windows : -1;
+}
+
+static WMCounters getWMCounters(void) {
+    WMCounters counters = {0};
+    xcb_get_property_reply_t* reply = xcb_get_property_reply(dis, xcb_get_property(dis, 0, wmWindow,
+                MPX_IDLE_PROPERTY, XCB_ATOM_CARDINAL, 0, sizeof(counters) / 4), NULL);
+    if(reply) {
+        memcpy(&counters, xcb_get_property_value(reply), MIN(sizeof(counters), xcb_get_property_value_length(reply)));
+        free(reply);
+    }
+    return counters;
+}
+
+/**
+ * Records the effect of event
+ * @return true if event signals the WM went idle
+ */
+static bool handleEvent(xcb_generic_event_t* event, TimeStamp now) {
+    int index;
+    switch(event->response_type & 127) {
+        case XCB_PROPERTY_NOTIFY: {
+            xcb_property_notify_event_t* propertyEvent = (xcb_property_notify_event_t*)event;
+            if(propertyEvent->window == wmWindow && propertyEvent->atom == MPX_IDLE_PROPERTY)
+                return 1;
+            if(propertyEvent->window == root && propertyEvent->atom == ewmh->_NET_CURRENT_DESKTOP)
+                desktopChangeTime = lastEventTime = now;
+            return 0;
+        }
+        case XCB_MAP_NOTIFY:
+            index = getWindowIndex(((xcb_map_notify_event_t*)event)->window);
+            if(index != -1) {
+                numberOfMappedWindows++;
+                tiledTime[index] = lastEventTime = now;
+            }
+            return 0;
+        case XCB_UNMAP_NOTIFY:
+            if(getWindowIndex(((xcb_unmap_notify_event_t*)event)->window) != -1) {
+                numberOfMappedWindows--;
+                lastEventTime = now;
+            }
+            return 0;
+        case XCB_CONFIGURE_NOTIFY:
+            index = getWindowIndex(((xcb_configure_notify_event_t*)event)->window);
+            if(index != -1)
+                tiledTime[index] = lastEventTime = now;
+            return 0;
+        case XCB_DESTROY_NOTIFY:
+            if(getWindowIndex(((xcb_destroy_notify_event_t*)event)->window) != -1)
+                lastEventTime = now;
+            return 0;
+        case 0:
+            WARN("Unexpected X error %d", ((xcb_generic_error_t*)event)->error_code);
+            return 0;
+    }
+    return 0;
+}
+/**
+ * Processes events until the WM goes idle
+ */
+static void waitForWMIdle(void) {
+    xcb_flush(dis);
+    while(1) {
+        xcb_generic_event_t* event;
+        while((event = xcb_poll_for_event(dis))) {
+            bool idle = handleEvent(event, getTimeNs());
+            free(event);
+            if(idle)
+                return;
+        }
+        struct pollfd pfd = {xcb_get_file_descriptor(dis), POLLIN};
+        if(xcb_connection_has_error(dis) || poll(&pfd, 1, STEP_TIMEOUT_MS) == 0) {
+            ERROR("WM did not go idle");
+            kill(wmPid, SIGKILL);
+            exit(WM_NOT_RESPONDING);
+        }
+    }
+}
+/**
+ * Calls waitForWMIdle until done returns true
+ */
+static void waitForWMIdleUntil(bool(*done)(void)) {
+    do
+        waitForWMIdle();
+    while(!done());
+}
+
+static void startWM(void) {
+    const char* path = getenv("MPXMANAGER");
+    char command[256];
+    snprintf(command, sizeof(command), "exec %s", path ? path : "./mpxmanager");
+    wmPid = spawnChild(command);
+    WAIT_UNTIL_TRUE(wmWindow = isMPXManagerRunning());
+    registerForWindowEvents(wmWindow, XCB_EVENT_MASK_PROPERTY_CHANGE);
+    WAIT_UNTIL_TRUE(getWMCounters().idle);
+}
+static void stopWM(void) {
+    kill(wmPid, SIGTERM);
+    waitForChild(wmPid);
+    wmWindow = 0;
+}
+/// @return the value (kB) of field in /proc/<wmPid>/status
+static long getWMMemory(const char* field) {
+    char path[64];
+    char line[256];
+    long value = 0;
+    snprintf(path, sizeof(path), "/proc/%d/status", wmPid);
+    FILE* fp = fopen(path, "r");
+    if(!fp)
+        return 0;
+    while(fgets(line, sizeof(line), fp))
+        if(strncmp(line, field, strlen(field)) == 0 && line[strlen(field)] == ':')
+            value = atol(line + strlen(field) + 1);
+    fclose(fp);
+    return value;
+}
+
+static void printHistogram(const char* name, const Histogram* histogram) {
+    fprintf(output, "      \"%s\": {\"count\": %lu, \"mean\": %.1f, \"p50\": %.1f, \"p90\": %.1f, \"p99\": %.1f, "
+        "\"max\": %.1f},\n", name, histogram->count, getHistogramMean(histogram) / 1e3,
+        getHistogramPercentile(histogram, 50) / 1e3, getHistogramPercentile(histogram, 90) / 1e3,
+        getHistogramPercentile(histogram, 99) / 1e3, histogram->max / 1e3);
+}
+
+static bool allWindowsMapped(void) {
+    return numberOfMappedWindows == numberOfWindows;
+}
+static bool desktopChanged(void) {
+    return desktopChangeTime;
+}
+static void pressBinding(int mod, int keysym) {
+    sendKeyPress(getKeyCode(mod), DEFAULT_KEYBOARD);
+    typeKey(getKeyCode(keysym), DEFAULT_KEYBOARD);
+    sendKeyRelease(getKeyCode(mod), DEFAULT_KEYBOARD);
+}
+/**
+ * Switches to workspace with either an EWMH request or a key binding
+ * @return the time (ns) until _NET_CURRENT_DESKTOP was updated
+ */
+static TimeStamp switchWorkspace(int workspace, bool useBinding) {
+    desktopChangeTime = 0;
+    TimeStamp start = getTimeNs();
+    if(useBinding)
+        pressBinding(XK_Super_L, XK_1 + workspace);
+    else
+        xcb_ewmh_request_change_current_desktop(ewmh, defaultScreenNumber, workspace, XCB_CURRENT_TIME);
+    waitForWMIdleUntil(desktopChanged);
+    return desktopChangeTime - start;
+}
+
+/// accumulates the time spent in the timed phases of a run
+static TimeStamp busyTime;
+/**
+ * Waits for the WM to finish a phase started at start
+ * @return the time (ns) until the last event caused by the phase
+ */
+static TimeStamp finishPhase(TimeStamp start, bool(*done)(void)) {
+    lastEventTime = start;
+    waitForWMIdleUntil(done);
+    busyTime += lastEventTime - start;
+    return lastEventTime - start;
+}
+static void runStorm(uint32_t n, bool last) {
+    numberOfWindows = n;
+    numberOfMappedWindows = 0;
+    busyTime = 0;
+    windows = malloc(sizeof(WindowID) * n);
+    mapTime = calloc(n, sizeof(TimeStamp));
+    tiledTime = calloc(n, sizeof(TimeStamp));
+    startWM();
+    uint32_t mask = XCB_EVENT_MASK_STRUCTURE_NOTIFY;
+    for(int i = 0; i < n; i++)
+        windows[i] = createWindow(root, XCB_WINDOW_CLASS_INPUT_OUTPUT, XCB_CW_EVENT_MASK, &mask, (Rect) {7, 7, 3, 3});
+    qsort(windows, n, sizeof(WindowID), compareWindows);
+    waitForWMIdle();
+    WMCounters before = getWMCounters();
+    long baseRSS = getWMMemory("VmRSS");
+
+    TimeStamp start = getTimeNs();
+    for(int i = 0; i < n; i++) {
+        mapTime[i] = getTimeNs();
+        mapWindow(windows[i]);
+    }
+    TimeStamp mapPhase = finishPhase(start, allWindowsMapped);
+    WMCounters mapped = getWMCounters();
+    Histogram mapLatency = {0};
+    for(int i = 0; i < n; i++)
+        addHistogramValue(&mapLatency, tiledTime[i] - mapTime[i]);
+
+    Histogram workspaceLatency = {0}, bindingLatency = {0}, layoutLatency = {0};
+    for(int i = 0; i < STEP_REPEATS; i++) {
+        addHistogramValue(&workspaceLatency, switchWorkspace(1, 0));
+        addHistogramValue(&bindingLatency, switchWorkspace(0, 1));
+    }
+    for(int i = 0; i < STEP_REPEATS; i++) {
+        start = getTimeNs();
+        pressBinding(XK_Super_L, XK_space);
+        addHistogramValue(&layoutLatency, finishPhase(start, returnTrue));
+    }
+
+    start = getTimeNs();
+    for(int i = 0; i < n; i++)
+        xcb_configure_window(dis, windows[i], XCB_CONFIG_WINDOW_X | XCB_CONFIG_WINDOW_WIDTH,
+            (uint32_t[]) {i % 100, 10 + i % 100});
+    TimeStamp configurePhase = finishPhase(start, returnTrue);
+    long rss = getWMMemory("VmRSS");
+
+    start = getTimeNs();
+    for(int i = 0; i < n; i++)
+        xcb_destroy_window(dis, windows[i]);
+    TimeStamp destroyPhase = finishPhase(start, returnTrue);
+    WMCounters after = getWMCounters();
+    long peakRSS = getWMMemory("VmHWM");
+    stopWM();
+
+    uint32_t events = after.events - before.events;
+    fprintf(output, "    {\n      \"windows\": %u,\n", n);
+    fprintf(output, "      \"map_phase_ms\": %.3f,\n", mapPhase / 1e6);
+    fprintf(output, "      \"configure_phase_ms\": %.3f,\n", configurePhase / 1e6);
+    fprintf(output, "      \"destroy_phase_ms\": %.3f,\n", destroyPhase / 1e6);
+    printHistogram("map_to_tiled_us", &mapLatency);
+    printHistogram("workspace_switch_us", &workspaceLatency);
+    printHistogram("binding_us", &bindingLatency);
+    printHistogram("layout_cycle_us", &layoutLatency);
+    fprintf(output, "      \"events\": %u,\n", events);
+    fprintf(output, "      \"events_per_sec\": %.0f,\n", busyTime ? events / (busyTime / 1e9) : 0);
+    fprintf(output, "      \"x_requests\": %u,\n", after.requests - before.requests);
+    fprintf(output, "      \"x_round_trips\": %u,\n", after.roundTrips - before.roundTrips);
+    fprintf(output, "      \"round_trips_per_map\": %.2f,\n", (mapped.roundTrips - before.roundTrips) / (double)n);
+    fprintf(output, "      \"rss_kb\": {\"base\": %ld, \"loaded\": %ld, \"peak\": %ld}\n", baseRSS, rss, peakRSS);
+    fprintf(output, "    }%s\n", last ? "" : ",");
+    fflush(output);
+    free(windows);
+    free(mapTime);
+    free(tiledTime);
+}
+
+int main(int argc, char* const argv[]) {
+    char* logLevelStr = getenv("LOG_LEVEL");
+    setLogLevel(logLevelStr ? atoi(logLevelStr) : LOG_LEVEL_WARN);
+    output = stdout;
+    int opt;
+    while((opt = getopt(argc, argv, "o:")) != -1) {
+        if(opt == 'o' && !(output = fopen(optarg, "w")))
+            err(SYS_CALL_FAILED, "could not open %s", optarg);
+        else if(opt != 'o')
+            errx(INVALID_OPTION, "Usage: %s [-o FILE] [N...]", argv[0]);
+    }
+    uint32_t defaultSizes[] = {10, 100, 1000, 5000};
+    int numberOfSizes = optind < argc ? argc - optind : LEN(defaultSizes);
+    // EWMH support is needed for the workspace requests and _NET_CURRENT_DESKTOP
+    setenv("ALLOW_MPX_EXT", "1", 1);
+    signal(SIGPIPE, SIG_IGN);
+    openXDisplay();
+    registerForWindowEvents(root, XCB_EVENT_MASK_PROPERTY_CHANGE);
+    fprintf(output, "{\n  \"benchmark\": \"window-storm\",\n  \"repeats\": %d,\n  \"runs\": [\n", STEP_REPEATS);
+    for(int i = 0; i < numberOfSizes; i++)
+        runStorm(optind < argc ? atoi(argv[optind + i]) : defaultSizes[i], i == numberOfSizes - 1);
+    fprintf(output, "  ]\n}\n");
+    fclose(output);
+    return 0;
+}
@@ -0,0 +1,71 @@
+#include <sys/resource.h>
+
+#include "../../util/debug.h"
+#include "../../windows.h"
+#include "../../workspaces.h"
+
+#include "../test-mpx-helper.h"
+#include "bench.h"
+
+SCUTEST_SET_ENV(createSimpleEnv, simpleCleanup);
+SCUTEST(bench_get_window_info) {
+    int sizes[] = {10, 100, 1000, 10000};
+    WindowID base = 0x1200000;
+    int n = 0;
+    for(int i = 0; i < LEN(sizes); i++) {
+        for(; n < sizes[i]; n++)
+            addFakeWindowInfo(base + n);
+        volatile WindowInfo* winInfo;
+        BENCHMARK("getWindowInfo", sizes[i], 1000000, winInfo = getWindowInfo(base + __n % sizes[i]));
+        BENCHMARK("getWindowInfo (missing)", sizes[i], 1000000, winInfo = getWindowInfo(base + sizes[i] + __n));
+        (void)winInfo;
+    }
+}
+SCUTEST(bench_window_mask_scan) {
+    printf("sizeof(WindowInfo) %ld\n", sizeof(WindowInfo));
+    int sizes[] = {100, 1000, 10000};
+    int n = 0;
+    volatile int result = 0;
+    for(int i = 0; i < LEN(sizes); i++) {
+        for(; n < sizes[i]; n++)
+            addMask(addFakeWindowInfo(n + 1), n % 7 ? MAPPABLE_MASK : MAPPABLE_MASK | URGENT_MASK);
+        BENCHMARK("mask scan", sizes[i], 1000000 / sizes[i],
+            FOR_EACH(WindowInfo*, winInfo, getAllWindows()) {result += hasMask(winInfo, URGENT_MASK);});
+        BENCHMARK("geometry scan", sizes[i], 1000000 / sizes[i],
+            FOR_EACH(WindowInfo*, winInfo, getAllWindows()) {result += winInfo->geometry.width;});
+    }
+}
+SCUTEST(bench_window_mask_index) {
+    int sizes[] = {100, 1000, 10000};
+    int n = 0;
+    volatile int result = 0;
+    addWorkspaces(1);
+    for(int i = 0; i < LEN(sizes); i++) {
+        for(; n < sizes[i]; n++) {
+            WindowInfo* winInfo = addFakeWindowInfo(n + 1);
+            moveToWorkspace(winInfo, 0);
+            addMask(winInfo, n % 100 ? MAPPABLE_MASK : MAPPABLE_MASK | URGENT_MASK);
+        }
+        BENCHMARK("indexed mask lookup", sizes[i], 1000000 / sizes[i],
+            FOR_EACH_WINDOW_WITH_MASK(winInfo, URGENT_MASK) {result += winInfo->id;});
+        BENCHMARK("hasWindowWithMask", sizes[i], 1000000, result += hasWindowWithMask(getWorkspace(0), URGENT_MASK));
+    }
+}
+static long getMaxRSS(void) {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+SCUTEST(bench_window_churn) {
+    int live = 100;
+    int N = 100000;
+    for(int i = 0; i < live; i++)
+        addFakeWindowInfo(i + 1);
+    long rss = getMaxRSS();
+    BENCHMARK("create/destroy window", live, N,
+        freeWindowInfo(getWindowInfo(__n + 1)); addFakeWindowInfo(__n + live + 1));
+    printf("max RSS %ldKB -> %ldKB\n", rss, getMaxRSS());
+    FOR_EACH(Slab*, slab, getAllSlabs()) {
+        dumpSlab(slab);
+    }
+}
@@ -0,0 +1,47 @@
+#include "../../layouts.h"
+#include "../../monitors.h"
+#include "../../windows.h"
+#include "../../workspaces.h"
+
+#include "../test-mpx-helper.h"
+#include "../test-x-helper.h"
+#include "bench.h"
+
+static int NUM_WINDOWS = 500;
+static int NUM_WORKSPACES = 10;
+
+static void populateWorkspaces() {
+    addWorkspaces(NUM_WORKSPACES - getNumberOfWorkspaces());
+    for(int i = 0; i < NUM_WINDOWS; i++) {
+        WindowInfo* winInfo = addFakeWindowInfo(i + 1);
+        addMask(winInfo, MAPPABLE_MASK);
+        moveToWorkspace(winInfo, i % NUM_WORKSPACES);
+    }
+}
+SCUTEST_SET_ENV(createSimpleEnv, simpleCleanup);
+SCUTEST(bench_effective_mask) {
+    populateWorkspaces();
+    volatile int result = 0;
+    BENCHMARK("isTileable (all windows)", NUM_WINDOWS, 1000,
+        FOR_EACH(WindowInfo*, winInfo, getAllWindows()) {result += isTileable(winInfo);});
+    BENCHMARK("getWorkspaceIndexOfWindow", NUM_WINDOWS, 1000000,
+        result += getWorkspaceIndexOfWindow(getWindowInfo(__n % NUM_WINDOWS + 1)));
+}
+
+SCUTEST_SET_ENV(createXSimpleEnv, cleanupXServer);
+SCUTEST(bench_tile_workspace) {
+    addWorkspaces(NUM_WORKSPACES - getNumberOfWorkspaces());
+    for(int i = 1; i < NUM_WORKSPACES; i++)
+        addFakeMonitor((Rect) {0, 0, 100, 100});
+    assignUnusedMonitorsToWorkspaces();
+    for(int i = 0; i < NUM_WINDOWS; i++) {
+        WindowInfo* winInfo = addWindow(createNormalWindow());
+        addMask(winInfo, MAPPABLE_MASK);
+        moveToWorkspace(winInfo, i % NUM_WORKSPACES);
+    }
+    FOR_EACH(Workspace*, workspace, getAllWorkspaces()) {
+        setLayout(workspace, &GRID);
+    }
+    BENCHMARK("tileWorkspace (all workspaces)", NUM_WINDOWS, 100,
+        FOR_EACH(Workspace*, workspace, getAllWorkspaces()) {tileWorkspace(workspace);} flush());
+}
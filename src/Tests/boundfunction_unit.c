@@ -1,11 +1,14 @@
 #include "../boundfunction.h"
+#include "../globals.h"
 #include "../masters.h"
 #include "../monitors.h"
 #include "../mywm-structs.h"
 #include "../windows.h"
 #include "test-mpx-helper.h"
 #include "tester.h"
+#include <signal.h>
 #include <string.h>
+#include <unistd.h>
 
 //static BoundFunction func[] = { };
 SCUTEST_SET_ENV(NULL, clearAllRules);
@@ -30,6 +33,168 @@ SCUTEST(test_add_apply_rules) {
     assertEquals(getCount(), 2 * NUMBER_OF_MPX_EVENTS);
 }
 
+SCUTEST(test_rules_sorted_by_priority) {
+    FunctionPriority priorities[] = {NORMAL_PRIORITY, LOWEST_PRIORITY, HIGHEST_PRIORITY, NORMAL_PRIORITY, LOW_PRIORITY,
+        HIGH_PRIORITY, NORMAL_PRIORITY};
+    uint32_t ids[LEN(priorities)];
+    for(int i = 0; i < LEN(priorities); i++)
+        ids[i] = addEvent(0, DEFAULT_EVENT(incrementCount, priorities[i])).id;
+    RuleList* rules = getEventList(0, 0);
+    assertEquals(rules->size, LEN(priorities));
+    for(int i = 1; i < rules->size; i++)
+        assert(RuleListGet(rules, i - 1)->priority <= RuleListGet(rules, i)->priority);
+    // rules with the same priority keep the order they were added in
+    assertEquals(RuleListGet(rules, 2)->id, ids[0]);
+    assertEquals(RuleListGet(rules, 3)->id, ids[3]);
+    assertEquals(RuleListGet(rules, 4)->id, ids[6]);
+}
+
+SCUTEST(test_remove_rule) {
+    RuleHandle handle = addEvent(0, DEFAULT_EVENT(incrementCount));
+    RuleHandle batchHandle = addBatchEvent(0, DEFAULT_EVENT(incrementCount));
+    addEvent(0, DEFAULT_EVENT(incrementCount));
+    assert(removeRule(handle));
+    assert(!removeRule(handle));
+    assert(removeRule(batchHandle));
+    applyEventRules(0, NULL);
+    applyBatchEventRules();
+    assertEquals(getCount(), 1);
+    assertEquals(getEventList(0, 0)->size, 1);
+    assertEquals(getEventList(0, 1)->size, 0);
+}
+
+static RuleHandle handles[3];
+static void removeSelf() {
+    incrementCount();
+    assert(removeRule(handles[0]));
+}
+static void removeNext() {
+    incrementCount();
+    removeRule(handles[2]);
+}
+SCUTEST(test_remove_rule_while_applying, .iter = 2) {
+    if(_i) {
+        handles[0] = addEvent(0, DEFAULT_EVENT(removeSelf));
+        handles[1] = addEvent(0, DEFAULT_EVENT(incrementCount));
+        applyEventRules(0, NULL);
+        assertEquals(getCount(), 2);
+    }
+    else {
+        handles[0] = addEvent(0, DEFAULT_EVENT(removeNext));
+        handles[2] = addEvent(0, DEFAULT_EVENT(incrementCount));
+        applyEventRules(0, NULL);
+        assertEquals(getCount(), 1);
+    }
+    assertEquals(getEventList(0, 0)->size, 1);
+    applyEventRules(0, NULL);
+    assertEquals(getCount(), _i ? 3 : 2);
+}
+
+static void addHigherPriorityRule() {
+    incrementCount();
+    if(getCount() == 1)
+        addEvent(0, DEFAULT_EVENT(incrementCount, HIGHEST_PRIORITY));
+}
+SCUTEST(test_add_rule_while_applying) {
+    addEvent(0, DEFAULT_EVENT(addHigherPriorityRule));
+    addEvent(0, DEFAULT_EVENT(incrementCount));
+    applyEventRules(0, NULL);
+    // the current rule isn't run again and the later one isn't skipped
+    assertEquals(getCount(), 2);
+    applyEventRules(0, NULL);
+    assertEquals(getCount(), 5);
+}
+
+static void failIfCalled() {assert(0 && "rule should not run");}
+static void triggerLaterEvent() {
+    incrementCount();
+    applyEventRules(NUMBER_OF_MPX_EVENTS - 1, NULL);
+}
+SCUTEST(test_batch_rules_only_triggered) {
+    addBatchEvent(1, DEFAULT_EVENT(triggerLaterEvent));
+    addBatchEvent(NUMBER_OF_MPX_EVENTS - 1, DEFAULT_EVENT(incrementCount));
+    addBatchEvent(2, DEFAULT_EVENT(failIfCalled));
+    applyBatchEventRules();
+    assertEquals(getCount(), 0);
+    applyEventRules(1, NULL);
+    applyEventRules(1, NULL);
+    assertEquals(getNumberOfEventsTriggerSinceLastIdle(1), 2);
+    applyBatchEventRules();
+    // events triggered by batch rules for later types are handled in the same pass
+    assertEquals(getCount(), 2);
+    assertEquals(getNumberOfEventsTriggerSinceLastIdle(1), 0);
+    assertEquals(getNumberOfEventsTriggerSinceLastIdle(NUMBER_OF_MPX_EVENTS - 1), 0);
+    applyBatchEventRules();
+    assertEquals(getCount(), 2);
+}
+
+static void sleep1ms() {usleep(1000);}
+SCUTEST(test_event_latency) {
+    addEvent(0, DEFAULT_EVENT(sleep1ms));
+    applyEventRules(0, NULL);
+    applyEventRules(1, NULL);
+    assertEquals(getEventLatency(0)->count, 1);
+    assert(getEventLatency(0)->max >= 1000000);
+    // events without rules aren't timed
+    assertEquals(getEventLatency(1)->count, 0);
+    clearEventLatency();
+    assertEquals(getEventLatency(0)->count, 0);
+}
+
+static void clearAllRulesAndAddOne() {
+    clearAllRules();
+    addEvent(1, DEFAULT_EVENT(incrementCount));
+}
+SCUTEST(test_clear_all_rules_while_applying) {
+    PROFILE_RULES = 1;
+    addEvent(0, DEFAULT_EVENT(clearAllRulesAndAddOne));
+    addEvent(0, DEFAULT_EVENT(incrementCount));
+    applyEventRules(0, NULL);
+    // the cleared rules are skipped and only deleted once their list is done being applied
+    assertEquals(getCount(), 0);
+    assertEquals(getEventList(0, 0)->size, 0);
+    // the stats of the rule that was running weren't freed and reused by the new rule
+    assertEquals(RuleListGet(getEventList(1, 0), 0)->stats->invocations, 0);
+    applyEventRules(1, NULL);
+    assertEquals(getCount(), 1);
+    PROFILE_RULES = 0;
+}
+
+static void sleep1msAndApplyRules() {
+    usleep(1000);
+    applyEventRules(1, NULL);
+}
+static void sleep20ms() {usleep(20000);}
+SCUTEST(test_rule_profile) {
+    PROFILE_RULES = 1;
+    addEvent(0, DEFAULT_EVENT(sleep1msAndApplyRules));
+    addEvent(1, DEFAULT_EVENT(sleep20ms));
+    addEvent(1, FILTER_EVENT(returnFalse, .abort = 1));
+    addEvent(1, DEFAULT_EVENT(incrementCount));
+    applyEventRules(0, NULL);
+    RuleStats* outer = RuleListGet(getEventList(0, 0), 0)->stats;
+    RuleStats* inner = RuleListGet(getEventList(1, 0), 0)->stats;
+    RuleStats* filter = RuleListGet(getEventList(1, 0), 1)->stats;
+    assertEquals(outer->invocations, 1);
+    assertEquals(inner->invocations, 1);
+    assertEquals(filter->invocations, 1);
+    assertEquals(filter->aborts, 1);
+    assertEquals(RuleListGet(getEventList(1, 0), 2)->stats->invocations, 0);
+    assert(inner->selfTime >= 20000000);
+    // time spent in the nested rules is not counted towards the outer one; the nested sleep is long enough that
+    // oversleeping can't account for the difference
+    assert(outer->selfTime >= 1000000);
+    assert(outer->selfTime < inner->selfTime);
+    assertEquals(outer->maxTime, outer->selfTime);
+
+    PROFILE_RULES = 0;
+    applyEventRules(0, NULL);
+    assertEquals(outer->invocations, 1);
+    clearRuleStats();
+    assertEquals(outer->selfTime, 0);
+    assertEquals(filter->aborts, 0);
+}
+
 static void assertCount0() {assert(getCount() == 0);}
 static void assertCount1() {assert(getCount() == 1);}
 static void assertCount2() {assert(getCount() == 2);}
@@ -64,3 +229,59 @@ SCUTEST(test_apply_rule_abort) {
     applyEventRules(0, NULL);
     assertEquals(1, getCount());
 }
+
+SCUTEST_SET_ENV(createSimpleEnv, simpleCleanup);
+static void countWindow(WindowInfo* winInfo) {
+    assert(winInfo);
+    incrementCount();
+}
+SCUTEST(test_rule_precondition_user_event) {
+    WindowInfo* winInfo = addFakeWindowInfo(1);
+    addEvent(WINDOW_MOVE, DEFAULT_EVENT(countWindow, .precondition = {.flags = MANAGED_WINDOWS_ONLY}));
+    addEvent(WINDOW_MOVE, DEFAULT_EVENT(countWindow, .precondition = {.flags = DOCKS_ONLY}));
+    addEvent(WINDOW_MOVE, DEFAULT_EVENT(countWindow, .precondition = {MAPPED_MASK}));
+    addEvent(WINDOW_MOVE, DEFAULT_EVENT(countWindow, .precondition = {.forbiddenMask = MAPPED_MASK}));
+    addEvent(WINDOW_MOVE, DEFAULT_EVENT(countWindow, .precondition = {.type = 1}));
+    applyEventRules(WINDOW_MOVE, NULL);
+    assertEquals(getCount(), 0);
+    applyEventRules(WINDOW_MOVE, winInfo);
+    assertEquals(getCount(), 2);
+    winInfo->dock = 1;
+    winInfo->type = 1;
+    addMask(winInfo, MAPPED_MASK);
+    applyEventRules(WINDOW_MOVE, winInfo);
+    assertEquals(getCount(), 2 + 4);
+}
+
+static void freeEventWindow(xcb_map_notify_event_t* event) {
+    WindowInfo* winInfo = getWindowInfo(event->window);
+    if(winInfo)
+        freeWindowInfo(winInfo);
+}
+SCUTEST(test_rule_precondition_x_event) {
+    addFakeWindowInfo(1);
+    addEvent(XCB_MAP_NOTIFY, DEFAULT_EVENT(incrementCount, .precondition = {.flags = MANAGED_WINDOWS_ONLY}));
+    addEvent(XCB_MAP_NOTIFY, DEFAULT_EVENT(freeEventWindow, LOW_PRIORITY));
+    // the window is looked up again after a rule has run
+    addEvent(XCB_MAP_NOTIFY, DEFAULT_EVENT(incrementCount, LOWER_PRIORITY,
+            .precondition = {.flags = MANAGED_WINDOWS_ONLY}));
+    xcb_map_notify_event_t event = {.response_type = XCB_MAP_NOTIFY, .window = 2};
+    applyEventRules(XCB_MAP_NOTIFY, &event);
+    assertEquals(getCount(), 0);
+    event.window = 1;
+    applyEventRules(XCB_MAP_NOTIFY, &event);
+    assertEquals(getCount(), 1);
+}
+
+SCUTEST(test_rule_precondition_skips_filter) {
+    addEvent(XCB_PROPERTY_NOTIFY, FILTER_EVENT(returnFalse, .abort = 1,
+            .precondition = {.flags = MANAGED_WINDOWS_ONLY}));
+    addEvent(XCB_PROPERTY_NOTIFY, DEFAULT_EVENT(incrementCount, LOW_PRIORITY));
+    xcb_property_notify_event_t event = {.response_type = XCB_PROPERTY_NOTIFY, .window = 1};
+    assert(applyEventRules(XCB_PROPERTY_NOTIFY, &event));
+    assertEquals(getCount(), 1);
+}
+
+SCUTEST_ERR(test_rule_precondition_invalid_event, SIGABRT) {
+    addEvent(SCREEN_CHANGE, DEFAULT_EVENT(incrementCount, .precondition = {.flags = MANAGED_WINDOWS_ONLY}));
+}
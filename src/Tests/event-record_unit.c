@@ -0,0 +1,147 @@
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../event-record.h"
+#include "../globals.h"
+#include "../xevent.h"
+#include "test-event-helper.h"
+#include "test-x-helper.h"
+#include "tester.h"
+
+#define TRACE_PATH "/tmp/mpx-test.trace"
+
+static void removeTrace() {
+    unlink(TRACE_PATH);
+}
+
+SCUTEST_SET_ENV(NULL, removeTrace);
+SCUTEST(test_record_and_read) {
+    xcb_generic_event_t events[] = {{.response_type = XCB_MAP_NOTIFY, .sequence = 1},
+        {.response_type = XCB_UNMAP_NOTIFY | 128, .sequence = 2, .full_sequence = 3}};
+    struct {
+        xcb_ge_generic_event_t event;
+        uint32_t data[2];
+    } genericEvent = {.event = {.response_type = XCB_GE_GENERIC, .extension = 1, .length = 2}, .data = {4, 5}};
+    assert(!isRecordingEvents());
+    assert(startRecordingEvents(TRACE_PATH));
+    assert(isRecordingEvents());
+    recordXEvent(&events[0]);
+    recordIdle();
+    recordXEvent(&events[1]);
+    recordXEvent((xcb_generic_event_t*)&genericEvent);
+    stopRecordingEvents();
+    assert(!isRecordingEvents());
+
+    EventTraceHeader header;
+    FILE* fp = openEventTrace(TRACE_PATH, &header);
+    assert(fp);
+    assertEquals(header.version, EVENT_TRACE_VERSION);
+    TraceRecord record;
+    TimeStamp lastTime = 0;
+    for(int i = 0; i < 4; i++) {
+        assert(readTraceRecord(fp, &record));
+        assert(record.time >= lastTime);
+        lastTime = record.time;
+        if(i == 1)
+            assert(!record.event);
+        else if(i == 3)
+            assert(memcmp(record.event, &genericEvent, sizeof(genericEvent)) == 0);
+        else
+            assert(memcmp(record.event, &events[i / 2], sizeof(xcb_generic_event_t)) == 0);
+        free(record.event);
+    }
+    assert(!readTraceRecord(fp, &record));
+    fclose(fp);
+}
+
+SCUTEST(test_record_restart) {
+    xcb_generic_event_t event = {.response_type = XCB_MAP_NOTIFY};
+    assert(startRecordingEvents(TRACE_PATH));
+    recordXEvent(&event);
+    // the previous trace is closed and replaced
+    assert(startRecordingEvents(TRACE_PATH));
+    stopRecordingEvents();
+    EventTraceHeader header;
+    FILE* fp = openEventTrace(TRACE_PATH, &header);
+    TraceRecord record;
+    assert(!readTraceRecord(fp, &record));
+    fclose(fp);
+}
+
+SCUTEST(test_record_bad_path) {
+    assert(!startRecordingEvents("/dev/null/trace"));
+    assert(!isRecordingEvents());
+}
+
+SCUTEST(test_read_invalid_trace) {
+    EventTraceHeader header;
+    FILE* fp = fopen(TRACE_PATH, "w");
+    fprintf(fp, "not a trace");
+    fclose(fp);
+    assert(!openEventTrace(TRACE_PATH, &header));
+    assert(!openEventTrace("/dev/null/trace", &header));
+}
+
+SCUTEST(test_read_truncated_trace) {
+    xcb_generic_event_t event = {.response_type = XCB_MAP_NOTIFY};
+    assert(startRecordingEvents(TRACE_PATH));
+    recordXEvent(&event);
+    recordXEvent(&event);
+    stopRecordingEvents();
+    assert(truncate(TRACE_PATH, sizeof(EventTraceHeader) + 12 + sizeof(event) + 12 + 1) == 0);
+    EventTraceHeader header;
+    FILE* fp = openEventTrace(TRACE_PATH, &header);
+    TraceRecord record;
+    assert(readTraceRecord(fp, &record));
+    free(record.event);
+    assert(!readTraceRecord(fp, &record));
+    fclose(fp);
+}
+
+static void setup() {
+    openXDisplay();
+    addShutdownOnIdleRule();
+    registerForWindowEvents(root, ROOT_EVENT_MASKS);
+}
+static void cleanup() {
+    removeTrace();
+    simpleCleanup();
+}
+SCUTEST_SET_ENV(setup, cleanup);
+SCUTEST(test_record_event_loop) {
+    assert(startRecordingEvents(TRACE_PATH));
+    xcb_generic_event_t event = {.response_type = XCB_UNMAP_NOTIFY};
+    for(int i = 0; i < 10; i++)
+        xcb_send_event(dis, 0, root, ROOT_EVENT_MASKS, (char*) &event);
+    addEvent(XCB_UNMAP_NOTIFY, DEFAULT_EVENT(incrementCount));
+    runEventLoop();
+    stopRecordingEvents();
+    assertEquals(getCount(), 10);
+
+    EventTraceHeader header;
+    FILE* fp = openEventTrace(TRACE_PATH, &header);
+    assertEquals(header.xiOpcode, xcb_get_extension_data(dis, &xcb_input_id)->major_opcode);
+    TraceRecord record;
+    int events = 0, idles = 0;
+    while(readTraceRecord(fp, &record)) {
+        if(record.event) {
+            assertEquals(record.event->response_type & 127, XCB_UNMAP_NOTIFY);
+            events++;
+            free(record.event);
+        }
+        else
+            idles++;
+    }
+    fclose(fp);
+    assertEquals(events, 10);
+    assert(idles);
+
+    // replaying the trace triggers the same rules
+    fp = openEventTrace(TRACE_PATH, &header);
+    while(readTraceRecord(fp, &record))
+        if(record.event)
+            processXEvent(record.event);
+    fclose(fp);
+    assertEquals(getCount(), 20);
+}
@@ -23,9 +23,9 @@ static void functionSetup() {
         moveToWorkspace(winInfo, 0);
         focusWindowInfo(winInfo);
     }
-    top = getElement(getActiveWindowStack(), 0);
-    middle = getElement(getActiveWindowStack(), 1);
-    bottom = getElement(getActiveWindowStack(), 2);
+    top = getActiveWindowStack()->data[0];
+    middle = getActiveWindowStack()->data[1];
+    bottom = getActiveWindowStack()->data[2];
     runEventLoop();
 }
 
@@ -145,12 +145,12 @@ SCUTEST(test_raiseOrRun_diff) {
 SCUTEST(test_shift_top_and_focus) {
     onWindowFocus(bottom->id);
     shiftTopAndFocus();
-    assertEquals(getElement(getActiveWindowStack(), 0), bottom);
-    assertEquals(getElement(getActiveWindowStack(), 1), top);
+    assertEquals(getActiveWindowStack()->data[0], bottom);
+    assertEquals(getActiveWindowStack()->data[1], top);
     assertEquals(bottom->id, getActiveFocus());
     shiftTopAndFocus();
-    assertEquals(getElement(getActiveWindowStack(), 0), top);
-    assertEquals(getElement(getActiveWindowStack(), 1), bottom);
+    assertEquals(getActiveWindowStack()->data[0], top);
+    assertEquals(getActiveWindowStack()->data[1], bottom);
     assertEquals(top->id, getActiveFocus());
 }
 SCUTEST_ITER(test_shift_focus_null, 3) {
@@ -181,8 +181,8 @@ SCUTEST(test_skip_non_focusable) {
 SCUTEST(test_swap_position) {
     onWindowFocus(bottom->id);
     swapPosition(1);
-    assert(getElement(getActiveWindowStack(), 0) == bottom);
-    assert(pop(getActiveWindowStack()) == top);
+    assert(getActiveWindowStack()->data[0] == bottom);
+    assert(getActiveWindowStack()->data[getActiveWindowStack()->size - 1] == top);
 }
 
 SCUTEST(test_swap_position_unfocused) {
@@ -206,7 +206,7 @@ SCUTEST(test_center_mouse) {
     short pos[2];
     movePointer(0, 0);
     Master* master = getActiveMaster();
-    FOR_EACH(WindowInfo*, winInfo, getActiveWindowStack()) {
+    FOR_EACH_VALUE(WindowInfo*, winInfo, getActiveWindowStack()) {
         centerMouseInWindow(winInfo);
         assert(getMousePosition(getPointerID(master), root, pos));
         winInfo->geometry = (getRealGeometry(winInfo->id));
@@ -46,7 +46,7 @@ SCUTEST_ITER(test_layouts, NUMBER_OF_LAYOUT_FAMILIES) {
         int area = 0;
         Rect rects[getActiveWindowStack()->size];
         int numUniqueRects = 0;
-        FOR_EACH(WindowInfo*, winInfo, getActiveWindowStack()) {
+        FOR_EACH_VALUE(WindowInfo*, winInfo, getActiveWindowStack()) {
             Rect r = getRealGeometry(winInfo->id);
             dumpRect(r);
             bool noIntersections = 1;
@@ -216,10 +216,48 @@ SCUTEST(test_tile_windows) {
     assert(checkStackingOrder(stackingOrder, LEN(stackingOrder)));
 }
 
+SCUTEST_ITER(test_retile_unchanged_workspace, NUMBER_OF_LAYOUT_FAMILIES) {
+    toggleActiveLayout(&LAYOUT_FAMILIES[_i]);
+    int size = 4;
+    for(int i = 0; i < size; i++) {
+        WindowInfo* winInfo = addWindow(mapArbitraryWindow());
+        moveToWorkspace(winInfo, getActiveWorkspaceIndex());
+        addMask(winInfo, MAPPABLE_MASK | MAPPED_MASK);
+        if(i == 0)
+            floatWindow(winInfo);
+    }
+    uint32_t configures = getNumberOfConfigureRequests();
+    retile();
+    uint32_t configuredWindows = getNumberOfConfigureRequests() - configures;
+    assert(configuredWindows);
+    configures = getNumberOfConfigureRequests();
+    uint32_t suppressed = getNumberOfSuppressedConfigureRequests();
+    retile();
+    assertEquals(getNumberOfConfigureRequests(), configures);
+    assertEquals(getNumberOfSuppressedConfigureRequests() - suppressed, configuredWindows);
+
+    // a ConfigureNotify that disagrees with what was sent causes just that value to be sent again
+    WindowInfo* winInfo = getActiveWindowStack()->data[0];
+    FOR_EACH_VALUE(WindowInfo*, tileableWindow, getActiveWindowStack()) {
+        if(isTileable(tileableWindow))
+            winInfo = tileableWindow;
+    }
+    short geometry[LEN(winInfo->sentConfig)];
+    memcpy(geometry, winInfo->sentConfig, sizeof(geometry));
+    geometry[CONFIG_INDEX_X]++;
+    clearStaleSentConfig(winInfo, geometry);
+    uint32_t suppressedValues = getNumberOfSuppressedConfigureValues();
+    retile();
+    assertEquals(getNumberOfConfigureRequests() - configures, 1);
+    assert(getNumberOfSuppressedConfigureValues() - suppressedValues > 0);
+    flush();
+    Rect rect = getRealGeometry(winInfo->id);
+    assertEquals(rect.x, winInfo->sentConfig[CONFIG_INDEX_X]);
+}
 
 static Rect baseConfig;
 static void dummyLayout(LayoutState* state) {
-    tileWindow(state, getHead(state->stack), (short*)&baseConfig);
+    tileWindow(state, state->stack->data[0], (short*)&baseConfig);
 };
 SCUTEST_ITER(test_privileged_windows_size, 9 * 2) {
     WindowMask extra = _i % 2 ? NO_MASK : NO_TILE_MASK;
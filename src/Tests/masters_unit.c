@@ -129,3 +129,43 @@ SCUTEST(test_slaves) {
     Slave* s = newSlave(10, getActiveMasterKeyboardID(), 1, "name", 4);
     assertEquals(s, getElement(getSlaves(getActiveMaster()), 0));
 }
+SCUTEST(test_focus_delete_multiple_masters) {
+    int N = 5;
+    for(int i = 1; i <= N; i++)
+        addFakeMaster(i * 10, i * 10 + 1);
+    for(int i = 1; i <= N; i++)
+        addFakeWindowInfo(i);
+    FOR_EACH(Master*, m, getAllMasters()) {
+        for(int i = 1; i <= N; i++)
+            onWindowFocusForMaster(i, m);
+    }
+    freeWindowInfo(getWindowInfo(N));
+    freeWindowInfo(getWindowInfo(1));
+    FOR_EACH(Master*, m, getAllMasters()) {
+        assertEquals(getFocusedWindowOfMaster(m), getWindowInfo(N - 1));
+        assertEquals(getMasterWindowStack(m)->size, N - 2);
+        for(int i = 0; i < N - 2; i++)
+            assertEquals(((WindowInfo*)getElement(getMasterWindowStack(m), i))->id, N - 1 - i);
+    }
+    freeMaster(getMasterByID(10));
+    assert(!removeWindowFromFocusStack(getActiveMaster(), N));
+    assert(removeWindowFromFocusStack(getActiveMaster(), 2) == getWindowInfo(2));
+    assertEquals(getActiveMasterWindowStack()->size, N - 3);
+}
+SCUTEST(test_focus_stack_refocus) {
+    for(int i = 1; i <= 3; i++) {
+        addFakeWindowInfo(i);
+        onWindowFocus(i);
+    }
+    onWindowFocus(2);
+    onWindowFocus(2);
+    assertEquals(getActiveMasterWindowStack()->size, 3);
+    assertEquals(getElement(getActiveMasterWindowStack(), 0), getWindowInfo(2));
+    assertEquals(getElement(getActiveMasterWindowStack(), 1), getWindowInfo(3));
+    assertEquals(getElement(getActiveMasterWindowStack(), 2), getWindowInfo(1));
+    clearFocusStack(getActiveMaster());
+    assert(!getFocusedWindow());
+    assertEquals(getActiveMasterWindowStack()->size, 0);
+    onWindowFocus(1);
+    assertEquals(getFocusedWindow(), getWindowInfo(1));
+}
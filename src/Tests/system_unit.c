@@ -8,6 +8,7 @@
 #include "../masters.h"
 #include "../system.h"
 #include "../util/arraylist.h"
+#include "../util/flight-recorder.h"
 #include "../util/logger.h"
 #include "../util/time.h"
 #include "test-mpx-helper.h"
@@ -161,3 +162,22 @@ SCUTEST_ERR(assert_fail, SIGABRT) {
     setLogLevel(LOG_LEVEL_NONE);
     assert(0);
 }
+SCUTEST(test_crash_dumps_flight_recorder) {
+    const char* path = "/tmp/mpx-test.flight";
+    int pid = fork();
+    if(!pid) {
+        setLogLevel(LOG_LEVEL_NONE);
+        assert(startFlushingFlightRecorder(path));
+        WARN("about to crash");
+        raise(SIGSEGV);
+    }
+    assertEquals(waitForChild(pid), SIGSEGV);
+    char buffer[4096] = {0};
+    FILE* file = fopen(path, "r");
+    assert(file);
+    fread(buffer, 1, sizeof(buffer) - 1, file);
+    fclose(file);
+    unlink(path);
+    assert(strstr(buffer, "about to crash"));
+    assert(strstr(buffer, "Error: signal 11:"));
+}
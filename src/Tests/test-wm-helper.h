@@ -65,9 +65,15 @@ static inline void wakeupWM() {
     flush();
 }
 
-static inline void verifyWindowStack(const ArrayList* stack, const WindowID win[3]) {
+static inline void verifyWindowStack(const WindowStack* stack, const WindowID win[3]) {
     int i = 0;
-    FOR_EACH(WindowInfo*, winInfo, stack) {
+    FOR_EACH_VALUE(WindowInfo*, winInfo, stack) {
+        assertEquals(winInfo->id, win[i++]);
+    }
+}
+static inline void verifyWindowList(const ArrayList* list, const WindowID win[3]) {
+    int i = 0;
+    FOR_EACH(WindowInfo*, winInfo, list) {
         assertEquals(winInfo->id, win[i++]);
     }
 }
@@ -0,0 +1,169 @@
+#include <stdlib.h>
+
+#include "../timers.h"
+#include "../util/time.h"
+#include "../globals.h"
+#include "../wmfunctions.h"
+#include "../xevent.h"
+#include "../xutil/window-properties.h"
+#include "test-mpx-helper.h"
+#include "test-x-helper.h"
+#include "tester.h"
+
+/// the time a timer is expected to expire; recorded before the timer was added so it can only be earlier than the real value
+typedef struct {
+    TimeStamp expires;
+    bool ran;
+} ExpectedTimer;
+static TimeStamp lastNow;
+static TimeStamp now;
+static void checkExpiration(ExpectedTimer* expected) {
+    assert(!expected->ran);
+    assert(expected->expires <= now);
+    // the real expiration can be slightly later than the recorded one
+    assert(lastNow < expected->expires + 2);
+    expected->ran = 1;
+}
+static Timer* addExpectedTimer(ExpectedTimer* expected, uint32_t delay) {
+    *expected = (ExpectedTimer) {getTime() + delay};
+    return addTimer(delay, checkExpiration, expected);
+}
+static void advance(TimeStamp time) {
+    lastNow = now;
+    now = time;
+    runExpiredTimers(now);
+}
+
+SCUTEST(test_timer_expiration) {
+    uint32_t delays[] = {0, 1, 50, 63, 64, 65, 100, 4095, 4096, 5000, 300000, 1 << 24, 1 << 25};
+    ExpectedTimer expected[LEN(delays)];
+    now = getTime();
+    for(int i = 0; i < LEN(delays); i++)
+        addExpectedTimer(&expected[i], delays[i]);
+    assertEquals(getNumberOfTimers(), LEN(delays));
+    for(int i = 0; i < LEN(delays); i++) {
+        advance(expected[i].expires + 1);
+        assert(expected[i].ran);
+        if(i + 1 < LEN(delays) && delays[i] + 2 < delays[i + 1])
+            assert(!expected[i + 1].ran);
+    }
+    assertEquals(getNumberOfTimers(), 0);
+}
+
+SCUTEST(test_timer_many, .timeout = 10) {
+    int N = 10000;
+    ExpectedTimer* expected = malloc(sizeof(ExpectedTimer) * N);
+    Timer** timers = malloc(sizeof(Timer*) * N);
+    now = getTime();
+    TimeStamp start = now;
+    srand(0);
+    for(int i = 0; i < N; i++)
+        timers[i] = addExpectedTimer(&expected[i], rand() % 1000000);
+    for(int i = 0; i < N; i += 3)
+        cancelTimer(timers[i]);
+    assertEquals(getNumberOfTimers(), N - (N + 2) / 3);
+    while(getNumberOfTimers())
+        advance(now + 997);
+    for(int i = 0; i < N; i++)
+        assertEquals(expected[i].ran, i % 3 != 0);
+    assert(now < start + 1000000 + 997 * 2);
+    free(expected);
+    free(timers);
+}
+
+static void cancelSelf(Timer** timer) {
+    incrementCount();
+    if(getCount() == 3)
+        cancelTimer(*timer);
+}
+SCUTEST(test_timer_periodic) {
+    static Timer* timer;
+    now = getTime();
+    timer = addPeriodicTimer(10, 10, cancelSelf, &timer);
+    for(int i = 0; i < 15; i++)
+        advance(now + 1);
+    assertEquals(getCount(), 1);
+    // missed periods are skipped
+    advance(now + 1000);
+    assertEquals(getCount(), 2);
+    advance(now + 10);
+    assertEquals(getCount(), 3);
+    assertEquals(getNumberOfTimers(), 0);
+    advance(now + 1000);
+    assertEquals(getCount(), 3);
+}
+
+static Timer* otherTimer;
+static void cancelOther() {
+    cancelTimer(otherTimer);
+    incrementCount();
+}
+SCUTEST(test_timer_cancel_from_callback) {
+    now = getTime();
+    addTimer(5, cancelOther, NULL);
+    otherTimer = addTimer(5, incrementCount, NULL);
+    addTimer(0, incrementCount, NULL);
+    advance(now + 100);
+    assertEquals(getCount(), 2);
+    assertEquals(getNumberOfTimers(), 0);
+}
+
+static void addNestedTimer() {
+    incrementCount();
+    if(getCount() < 10)
+        addTimer(0, addNestedTimer, NULL);
+}
+SCUTEST(test_timer_added_from_callback) {
+    now = getTime();
+    addTimer(1, addNestedTimer, NULL);
+    advance(now + 100);
+    assertEquals(getCount(), 10);
+    assertEquals(getNumberOfTimers(), 0);
+}
+
+SCUTEST(test_timer_fd_only_polled_while_timers_exist) {
+    now = getTime();
+    Timer* timer = addTimer(5, incrementCount, NULL);
+    addTimer(1, incrementCount, NULL);
+    assertEquals(getNumberOfExtraEvents(), 1);
+    advance(now + 2);
+    assertEquals(getNumberOfExtraEvents(), 1);
+    cancelTimer(timer);
+    // a leftover handler would keep the event loop from shutting down once the X connection is lost
+    assertEquals(getNumberOfExtraEvents(), 0);
+    addTimer(1, incrementCount, NULL);
+    assertEquals(getNumberOfExtraEvents(), 1);
+}
+
+SCUTEST_SET_ENV(createXSimpleEnv, cleanupXServer);
+SCUTEST(test_timer_event_loop, .timeout = 2) {
+    addTimer(1, incrementCount, NULL);
+    addTimer(50, requestShutdown, NULL);
+    TimeStamp start = getTime();
+    runEventLoop();
+    assert(getTime() - start >= 50);
+    assertEquals(getCount(), 1);
+}
+
+static void closeOnDelete(xcb_client_message_event_t* event) {
+    if(event->type == ewmh->WM_PROTOCOLS && event->data.data32[0] == WM_DELETE_WINDOW) {
+        incrementCount();
+        freeWindowInfo(getWindowInfo(event->window));
+    }
+}
+SCUTEST(test_kill_client_after_delete_window, .timeout = 2) {
+    WindowID win = createNormalWindow();
+    xcb_atom_t atoms[] = {WM_DELETE_WINDOW};
+    xcb_icccm_set_wm_protocols(dis, win, ewmh->WM_PROTOCOLS, LEN(atoms), atoms);
+    WindowInfo* winInfo = addWindow(win);
+    loadWindowProtocols(winInfo);
+    assert(winInfo->supportsDeleteWindow);
+    killClientOfWindowInfo(winInfo);
+    assertEquals(getNumberOfTimers(), 1);
+    addEvent(XCB_CLIENT_MESSAGE, DEFAULT_EVENT(closeOnDelete));
+    addTimer(KILL_TIMEOUT * 2, requestShutdown, NULL);
+    runEventLoop();
+    assertEquals(getCount(), 1);
+    // the window was closed so its client should not have been killed
+    assert(!xcb_connection_has_error(dis));
+}
@@ -1,4 +1,5 @@
 #include "../../util/arraylist.h"
+#include "../../util/vector.h"
 #include "../tester.h"
 #include <assert.h>
 #include <stdlib.h>
@@ -102,3 +103,89 @@ SCUTEST(test_clear) {
     clearArray(&list);
     assert(list.size == 0);
 }
+SCUTEST(test_index_of_ptr) {
+    int same = 0;
+    for(int i = 0; i < N; i++)
+        addElement(&list, newInt(0));
+    for(int i = 0; i < N; i++)
+        assertEquals(getIndexOfPtr(&list, getElement(&list, i)), i);
+    assertEquals(getIndexOfPtr(&list, &same), -1);
+}
+SCUTEST(test_remove_middle_preserves_order) {
+    for(int i = 0; i < N; i++)
+        addElement(&list, newInt(i));
+    free(removeIndex(&list, N / 2));
+    shiftToPos(&list, N - 2, 1);
+    assertEquals(*(int*)getElement(&list, 0), 0);
+    assertEquals(*(int*)getElement(&list, 1), N - 1);
+    for(int i = 2; i < N - 1; i++)
+        assertEquals(*(int*)getElement(&list, i), i - 1 + (i - 1 >= N / 2));
+}
+
+DECLARE_SCALAR_VECTOR(int, IntVector)
+typedef struct {
+    int key;
+    int value;
+} Pair;
+DECLARE_VECTOR(Pair, PairVector)
+SCUTEST(test_vector_add_remove) {
+    IntVector vec = {0};
+    for(int i = 0; i < N; i++)
+        assertEquals(*IntVectorAdd(&vec, i), i);
+    assertEquals(vec.size, N);
+    assertEquals(IntVectorRemoveIndex(&vec, 0), 0);
+    assertEquals(IntVectorSwapRemove(&vec, 0), 1);
+    assertEquals(*IntVectorGet(&vec, 0), N - 1);
+    assertEquals(vec.size, N - 2);
+    IntVectorInsert(&vec, 1, -1);
+    assertEquals(*IntVectorGet(&vec, 1), -1);
+    assertEquals(*IntVectorGet(&vec, 2), 2);
+    assertEquals(IntVectorIndexOf(&vec, -1), 1);
+    assertEquals(IntVectorIndexOf(&vec, N), -1);
+    IntVectorClear(&vec);
+    assertEquals(vec.size, 0);
+}
+SCUTEST(test_vector_sorted) {
+    IntVector vec = {0};
+    for(int i = 0; i < N; i++)
+        IntVectorInsertSorted(&vec, (i * 7) % N);
+    for(int i = 0; i < N; i++) {
+        assertEquals(*IntVectorGet(&vec, i), i);
+        assertEquals(IntVectorBinarySearch(&vec, i), i);
+    }
+    assertEquals(IntVectorBinarySearch(&vec, N), -1);
+    assertEquals(IntVectorBinarySearch(&vec, -1), -1);
+    IntVectorClear(&vec);
+}
+SCUTEST(test_vector_move) {
+    IntVector vec = {0};
+    for(int i = 0; i < 4; i++)
+        IntVectorAdd(&vec, i);
+    IntVectorMove(&vec, 3, 0);
+    IntVectorMove(&vec, 1, 2);
+    int expected[] = {3, 1, 0, 2};
+    int i = 0;
+    FOR_EACH_VALUE(int, value, &vec) {
+        assertEquals(value, expected[i++]);
+    }
+    FOR_EACH_VALUE_R(int, value, &vec) {
+        assertEquals(value, expected[--i]);
+    }
+    assertEquals(i, 0);
+    IntVectorClear(&vec);
+}
+SCUTEST(test_vector_inline_elements) {
+    PairVector vec = {0};
+    PairVectorReserve(&vec, N);
+    assertEquals(vec.capacity, N);
+    for(int i = 0; i < N; i++)
+        PairVectorAdd(&vec, (Pair) {i, -i});
+    int i = 0;
+    FOR_EACH_VECTOR(Pair, pair, &vec) {
+        assertEquals(PairVectorIndexOfPtr(&vec, pair), i);
+        assertEquals(pair->value, -i++);
+    }
+    Pair other;
+    assertEquals(PairVectorIndexOfPtr(&vec, &other), -1);
+    PairVectorClear(&vec);
+}
@@ -0,0 +1,170 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../../util/flight-recorder.h"
+#include "../../util/logger.h"
+#include "../tester.h"
+
+#define FLIGHT_RECORDER_PATH "/tmp/mpx-test.flight"
+
+static char contents[1 << 20];
+/// stops the recorder and loads what was flushed into contents
+static char* readFlushedRecords() {
+    stopFlushingFlightRecorder();
+    FILE* file = fopen(FLIGHT_RECORDER_PATH, "r");
+    assert(file);
+    contents[fread(contents, 1, sizeof(contents) - 1, file)] = 0;
+    fclose(file);
+    return contents;
+}
+static int countLines(const char* str) {
+    int lines = 0;
+    for(; *str; str++)
+        lines += *str == '\n';
+    return lines;
+}
+
+static void setup() {
+    setLogLevel(LOG_LEVEL_NONE);
+    setFlightRecorderLevel(LOG_LEVEL_VERBOSE);
+    assert(startFlushingFlightRecorder(FLIGHT_RECORDER_PATH));
+}
+static void cleanup() {
+    stopFlushingFlightRecorder();
+    unlink(FLIGHT_RECORDER_PATH);
+}
+SCUTEST_SET_ENV(setup, cleanup);
+
+SCUTEST(test_flight_recorder_format) {
+    pushContext("A");
+    pushContext("B");
+    WARN("int %d str %s hex %x long %ld double %.2f char %c %% %5s|%-*d|", -3, "abc", 255, 1L << 40, 1.5, 'c', "x", 4,
+        7);
+    popContext();
+    popContext();
+    char* line = readFlushedRecords();
+    assertEquals(countLines(line), 1);
+    assert(strstr(line, "|WARN|"));
+    assert(strstr(line,
+            "[A][B]int -3 str abc hex ff long 1099511627776 double 1.50 char c %     x|7   |\n"));
+}
+
+SCUTEST(test_flight_recorder_innermost_contexts) {
+    const char* contexts[] = {"1", "2", "3", "4", "5"};
+    for(int i = 0; i < LEN(contexts); i++)
+        pushContext(contexts[i]);
+    INFO("message");
+    for(int i = 0; i < LEN(contexts); i++)
+        popContext();
+    assert(strstr(readFlushedRecords(), "|[...][3][4][5]message\n"));
+}
+
+SCUTEST(test_flight_recorder_truncated_args) {
+    char str[LOG_RECORD_ARGS_SIZE * 2];
+    memset(str, 'a', sizeof(str) - 1);
+    str[sizeof(str) - 1] = 0;
+    INFO("%d %s %d", 1, str, 2);
+    char* line = readFlushedRecords();
+    char* message = strstr(line, "|1 a");
+    assert(message);
+    // the string is cut short and the args after it are lost
+    assert(strlen(message) < LOG_RECORD_ARGS_SIZE + 10);
+    assert(strstr(message, "a ...\n"));
+}
+
+SCUTEST(test_flight_recorder_string_is_copied) {
+    char str[] = "before";
+    INFO("%s", str);
+    strcpy(str, "after");
+    assert(strstr(readFlushedRecords(), "before"));
+}
+
+SCUTEST(test_flight_recorder_level) {
+    setFlightRecorderLevel(LOG_LEVEL_WARN);
+    uint64_t records = getNumberOfLogRecords();
+    INFO("info");
+    assertEquals(getNumberOfLogRecords(), records);
+    WARN("warn");
+    assertEquals(getNumberOfLogRecords(), records + 1);
+    setFlightRecorderLevel(LOG_LEVEL_NONE);
+    ERROR("error");
+    assertEquals(getNumberOfLogRecords(), records + 1);
+    char* lines = readFlushedRecords();
+    assertEquals(countLines(lines), 1);
+    assert(strstr(lines, "warn"));
+}
+
+SCUTEST(test_flight_recorder_lost_records) {
+    int extra = 10;
+    for(int i = 0; i < FLIGHT_RECORDER_SIZE + extra; i++)
+        INFO("%d", i);
+    flushFlightRecorder();
+    assertEquals(getNumberOfLostLogRecords(), extra);
+    assertEquals(countLines(readFlushedRecords()), FLIGHT_RECORDER_SIZE);
+}
+
+SCUTEST(test_flight_recorder_dump) {
+    INFO("message");
+    flushFlightRecorder();
+    int fds[2];
+    assert(!pipe(fds));
+    dumpFlightRecorder(fds[1]);
+    close(fds[1]);
+    char buffer[512] = {0};
+    read(fds[0], buffer, sizeof(buffer) - 1);
+    close(fds[0]);
+    // flushed records are still dumped
+    assert(strstr(buffer, "message"));
+}
+
+#define NUM_MESSAGES 10000
+/// keeps a thread from exiting (and giving up its ring) before the others have a ring of their own
+static pthread_barrier_t barrier;
+static void* logMessages(void* arg) {
+    for(int i = 0; i < NUM_MESSAGES; i++) {
+        INFO("%d", i);
+        if(!i)
+            pthread_barrier_wait(&barrier);
+    }
+    return NULL;
+}
+SCUTEST(test_flight_recorder_threads, .timeout = 10) {
+    pthread_t threads[2];
+    pthread_barrier_init(&barrier, NULL, LEN(threads));
+    for(int i = 0; i < LEN(threads); i++)
+        pthread_create(&threads[i], NULL, logMessages, NULL);
+    for(int i = 0; i < LEN(threads); i++)
+        pthread_join(threads[i], NULL);
+    FILE* dump = tmpfile();
+    dumpFlightRecorder(fileno(dump));
+    char* lines = readFlushedRecords();
+    assertEquals(countLines(lines) + getNumberOfLostLogRecords(), LEN(threads) * NUM_MESSAGES);
+    // each dump is in time order
+    rewind(dump);
+    uint64_t last = 0, sec, nsec;
+    int numRecords = 0;
+    while(fscanf(dump, "%lu.%lu%*[^\n]\n", &sec, &nsec) == 2) {
+        uint64_t time = sec * 1000000000UL + nsec;
+        assert(time >= last);
+        last = time;
+        numRecords++;
+    }
+    assertEquals(numRecords, LEN(threads) * FLIGHT_RECORDER_SIZE);
+    fclose(dump);
+}
+
+static void* logMessage(void* arg) {
+    INFO("thread message");
+    return NULL;
+}
+SCUTEST(test_flight_recorder_rings_are_reused) {
+    for(int i = 0; i < MAX_FLIGHT_RECORDER_THREADS * 2; i++) {
+        pthread_t thread;
+        pthread_create(&thread, NULL, logMessage, NULL);
+        pthread_join(thread, NULL);
+    }
+    assertEquals(countLines(readFlushedRecords()), MAX_FLIGHT_RECORDER_THREADS * 2);
+}
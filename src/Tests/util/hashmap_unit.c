@@ -0,0 +1,69 @@
+#include "../../util/hashmap.h"
+#include "../tester.h"
+#include <assert.h>
+#include <stdlib.h>
+
+static int N = 1000;
+static HashMap map;
+static int values[1000];
+static void tearDown() {
+    clearMap(&map);
+}
+SCUTEST_SET_ENV(NULL, tearDown);
+SCUTEST(test_empty_map) {
+    assert(!getValue(&map, 0));
+    assert(!getValue(&map, 1));
+    assert(!removeKey(&map, 1));
+    assert(map.size == 0);
+}
+SCUTEST(test_put_get) {
+    for(int i = 0; i < N; i++) {
+        assertEquals(map.size, i);
+        putValue(&map, i, &values[i]);
+        assert(getValue(&map, i) == &values[i]);
+    }
+    for(int i = 0; i < N; i++)
+        assert(getValue(&map, i) == &values[i]);
+    assert(!getValue(&map, N));
+}
+SCUTEST(test_put_replace) {
+    putValue(&map, 1, &values[0]);
+    putValue(&map, 1, &values[1]);
+    assertEquals(map.size, 1);
+    assert(getValue(&map, 1) == &values[1]);
+}
+SCUTEST_ITER(test_remove, 2) {
+    // ids of real windows share high bits and differ in the low ones
+    uint32_t base = _i ? 0x1200000 : 0;
+    for(int i = 0; i < N; i++)
+        putValue(&map, base + i, &values[i]);
+    for(int i = 0; i < N; i += 2)
+        assert(removeKey(&map, base + i) == &values[i]);
+    assertEquals(map.size, N / 2);
+    for(int i = 0; i < N; i++)
+        assert(getValue(&map, base + i) == (i % 2 ? &values[i] : NULL));
+    for(int i = 1; i < N; i += 2)
+        assert(removeKey(&map, base + i) == &values[i]);
+    assertEquals(map.size, 0);
+    for(int i = 0; i < N; i++)
+        assert(!getValue(&map, base + i));
+}
+SCUTEST(test_remove_collisions) {
+    // keys that are multiples of the capacity all probe from nearby slots
+    for(int i = 0; i < 8; i++)
+        putValue(&map, i << 16, &values[i]);
+    for(int i = 0; i < 8; i++) {
+        assert(removeKey(&map, i << 16) == &values[i]);
+        for(int n = i + 1; n < 8; n++)
+            assert(getValue(&map, n << 16) == &values[n]);
+    }
+}
+SCUTEST(test_clear_map) {
+    for(int i = 0; i < N; i++)
+        putValue(&map, i, &values[i]);
+    clearMap(&map);
+    assertEquals(map.size, 0);
+    assert(!getValue(&map, 1));
+    putValue(&map, 1, &values[1]);
+    assert(getValue(&map, 1) == &values[1]);
+}
@@ -0,0 +1,45 @@
+#include "../../util/histogram.h"
+#include "../tester.h"
+
+static Histogram histogram;
+
+SCUTEST(test_histogram_empty) {
+    assertEquals(getHistogramPercentile(&histogram, 50), 0);
+    assertEquals(getHistogramMean(&histogram), 0);
+}
+SCUTEST(test_histogram_small_values_are_exact) {
+    for(int i = 0; i < HISTOGRAM_SUB_BUCKETS; i++)
+        addHistogramValue(&histogram, i);
+    for(int i = 0; i < HISTOGRAM_SUB_BUCKETS; i++)
+        assertEquals(getHistogramPercentile(&histogram, 100.0 * i / (HISTOGRAM_SUB_BUCKETS - 1)), i);
+}
+SCUTEST(test_histogram_percentile_error, .iter = 3) {
+    uint64_t scale = _i == 0 ? 1 : _i == 1 ? 1000 : 1000000;
+    for(uint64_t i = 1; i <= 1000; i++)
+        addHistogramValue(&histogram, i * scale);
+    assertEquals(histogram.count, 1000);
+    assertEquals(histogram.max, 1000 * scale);
+    assertEquals(getHistogramMean(&histogram), 1001 * scale / 2);
+    assertEquals(getHistogramPercentile(&histogram, 100), 1000 * scale);
+    double percentiles[] = {1, 10, 50, 90, 99};
+    for(int i = 0; i < LEN(percentiles); i++) {
+        uint64_t expected = percentiles[i] * 10 * scale;
+        uint64_t value = getHistogramPercentile(&histogram, percentiles[i]);
+        assert(value >= expected);
+        assert(value - expected <= expected / HISTOGRAM_SUB_BUCKETS);
+    }
+}
+SCUTEST(test_histogram_overflow) {
+    addHistogramValue(&histogram, 1);
+    addHistogramValue(&histogram, -1UL);
+    assertEquals(getHistogramBucket(-1UL), HISTOGRAM_BUCKETS - 1);
+    assertEquals(getHistogramPercentile(&histogram, 100), -1UL);
+    assertEquals(getHistogramPercentile(&histogram, 0), 1);
+}
+SCUTEST(test_histogram_clear) {
+    addHistogramValue(&histogram, 100);
+    clearHistogram(&histogram);
+    assertEquals(histogram.count, 0);
+    assertEquals(histogram.max, 0);
+    assertEquals(getHistogramPercentile(&histogram, 99), 0);
+}
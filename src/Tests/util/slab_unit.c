@@ -0,0 +1,77 @@
+#include "../../util/slab.h"
+#include "../tester.h"
+#include <assert.h>
+#include <signal.h>
+#include <string.h>
+
+typedef struct {
+    int id;
+    char data[60];
+} Object;
+static Slab slab = SLAB(Object);
+
+SCUTEST(test_slab_alloc_zeroed) {
+    Object* obj = slabAlloc(&slab);
+    assert(obj);
+    for(int i = 0; i < sizeof(Object); i++)
+        assert(((char*)obj)[i] == 0);
+    assertEquals(slab.used, 1);
+    assert(getAllSlabs()->size);
+    assert(findElement(getAllSlabs(), &slab.name, sizeof(char*)));
+    slabFree(&slab, obj);
+    assertEquals(slab.used, 0);
+}
+SCUTEST(test_slab_reuse) {
+    Object* keep = slabAlloc(&slab);
+    Object* obj = slabAlloc(&slab);
+    uint32_t index = getSlabIndex(&slab, obj);
+    memset(obj, 1, sizeof(Object));
+    slabFree(&slab, obj);
+    Object* obj2 = slabAlloc(&slab);
+    assert(obj == obj2);
+    assertEquals(getSlabIndex(&slab, obj2), index);
+    assertEquals(obj2->id, 0);
+    slabFree(&slab, obj2);
+    slabFree(&slab, keep);
+}
+SCUTEST(test_slab_many) {
+    int N = SLAB_BLOCK_SIZE * 10 + 1;
+    Object* objects[SLAB_BLOCK_SIZE * 10 + 1];
+    for(int i = 0; i < N; i++) {
+        objects[i] = slabAlloc(&slab);
+        objects[i]->id = i;
+        assertEquals(getSlabIndex(&slab, objects[i]), i);
+    }
+    assertEquals(slab.used, N);
+    assertEquals(slab.peak, N);
+    assertEquals(getSlabCapacity(&slab), SLAB_BLOCK_SIZE * 11);
+    for(int i = 0; i < N; i++)
+        assertEquals(objects[i]->id, i);
+    for(int i = 0; i < N; i += 2)
+        slabFree(&slab, objects[i]);
+    // freed slots are reused before growing
+    for(int i = 0; i < N; i += 2)
+        objects[i] = slabAlloc(&slab);
+    assertEquals(getSlabCapacity(&slab), SLAB_BLOCK_SIZE * 11);
+    assertEquals(slab.allocations, N + N / 2 + 1);
+    for(int i = 0; i < N; i++)
+        slabFree(&slab, objects[i]);
+    assertEquals(slab.used, 0);
+    // the first block is kept
+    assertEquals(getSlabCapacity(&slab), SLAB_BLOCK_SIZE);
+    Object* obj = slabAlloc(&slab);
+    assertEquals(getSlabIndex(&slab, obj), 0);
+    assertEquals(getSlabCapacity(&slab), SLAB_BLOCK_SIZE);
+    slabFree(&slab, obj);
+}
+#ifndef NDEBUG
+SCUTEST_ERR(test_slab_detect_write_after_free, SIGABRT) {
+    Object* keep = slabAlloc(&slab);
+    Object* obj = slabAlloc(&slab);
+    slabFree(&slab, obj);
+    // the start of a freed object holds the free list
+    obj->data[sizeof(obj->data) - 1] = 1;
+    slabAlloc(&slab);
+    slabFree(&slab, keep);
+}
+#endif
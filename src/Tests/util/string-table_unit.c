@@ -0,0 +1,66 @@
+#include "../../util/string-table.h"
+#include "../tester.h"
+#include <assert.h>
+#include <string.h>
+
+SCUTEST(test_intern_same_pointer) {
+    char buffer[] = "str";
+    const char* str = internString("str");
+    assert(str == internString(buffer));
+    assertEqualsStr(str, "str");
+    assert(str != buffer);
+    assertEquals(getNumberOfInternedStrings(), 1);
+    releaseString(str);
+    assert(findInternedString("str") == str);
+    releaseString(str);
+    assert(!findInternedString("str"));
+    assertEquals(getNumberOfInternedStrings(), 0);
+}
+SCUTEST(test_intern_empty_string) {
+    const char* str = internString("");
+    assert(str == findInternedString(""));
+    assertEqualsStr(str, "");
+    assertEquals(getNumberOfInternedStrings(), 0);
+    releaseString(str);
+    releaseString(NULL);
+    assert(str == internString(""));
+}
+SCUTEST(test_find_does_not_intern) {
+    assert(!findInternedString("str"));
+    assertEquals(getNumberOfInternedStrings(), 0);
+}
+SCUTEST(test_intern_many) {
+    int N = 1000;
+    const char* strings[1000];
+    char buffer[16];
+    for(int i = 0; i < N; i++) {
+        sprintf(buffer, "%d", i);
+        strings[i] = internString(buffer);
+    }
+    assertEquals(getNumberOfInternedStrings(), N);
+    for(int i = 0; i < N; i++) {
+        sprintf(buffer, "%d", i);
+        assert(findInternedString(buffer) == strings[i]);
+    }
+    for(int i = 0; i < N; i++)
+        releaseString(strings[i]);
+    assertEquals(getNumberOfInternedStrings(), 0);
+}
+SCUTEST_ITER(test_intern_hash_collisions, 2) {
+    // pairs of strings with the same hash
+    const char* words[] = {"costarring", "liquid", "declinate", "macallums"};
+    const char* strings[4];
+    for(int i = 0; i < 4; i++)
+        strings[i] = internString(words[i]);
+    for(int i = 0; i < 4; i++)
+        assert(findInternedString(words[i]) == strings[i]);
+    // release either the head or the tail of each chain first
+    for(int i = 0; i < 4; i += 2) {
+        releaseString(strings[i + _i]);
+        assert(!findInternedString(words[i + _i]));
+        assert(findInternedString(words[i + !_i]) == strings[i + !_i]);
+    }
+    for(int i = 0; i < 4; i += 2)
+        releaseString(strings[i + !_i]);
+    assertEquals(getNumberOfInternedStrings(), 0);
+}
@@ -0,0 +1,77 @@
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../../boundfunction.h"
+#include "../../util/timeline.h"
+#include "../tester.h"
+
+#define TIMELINE_PATH "/tmp/mpx-test-timeline.json"
+
+static char contents[1 << 16];
+/// stops the timeline and loads it into contents
+static char* readTimeline() {
+    stopTimeline();
+    FILE* file = fopen(TIMELINE_PATH, "r");
+    assert(file);
+    contents[fread(contents, 1, sizeof(contents) - 1, file)] = 0;
+    fclose(file);
+    return contents;
+}
+static int countOccurrences(const char* str, const char* pattern) {
+    int count = 0;
+    for(; (str = strstr(str, pattern)); str++)
+        count++;
+    return count;
+}
+
+static void setup() {
+    assert(startTimeline(TIMELINE_PATH));
+}
+static void cleanup() {
+    stopTimeline();
+    clearAllRules();
+    unlink(TIMELINE_PATH);
+}
+SCUTEST_SET_ENV(setup, cleanup);
+
+SCUTEST(test_timeline_disabled) {
+    stopTimeline();
+    assert(!isTimelineEnabled());
+    assertEquals(TIMELINE_SPAN_START(), 0);
+    // spans that outlive the timeline are dropped
+    addTimelineSpan("span", "test", 1, 2);
+    addTimelineCounter("counter", 1);
+    assert(!strstr(readTimeline(), "span"));
+}
+
+SCUTEST(test_timeline_span) {
+    assert(isTimelineEnabled());
+    TimeStamp start = TIMELINE_SPAN_START();
+    assert(start);
+    TIMELINE_SPAN_END(start, "span", "test");
+    addTimelineSpan("\"quoted\\\"", "test", 1000, 3500);
+    addTimelineCounter("counter", -5);
+    char* json = readTimeline();
+    assertEquals(json[0], '[');
+    assertEquals(json[strlen(json) - 2], ']');
+    assert(strstr(json, "{\"name\":\"span\",\"ph\":\"X\","));
+    assert(strstr(json, "{\"name\":\"\\\"quoted\\\\\\\"\",\"ph\":\"X\",\"ts\":1.000,"));
+    assert(strstr(json, "\"dur\":2.500,\"cat\":\"test\"}"));
+    assert(strstr(json, "{\"name\":\"counter\",\"ph\":\"C\","));
+    assert(strstr(json, "\"args\":{\"value\":-5}}"));
+}
+
+SCUTEST(test_timeline_rule_spans) {
+    addEvent(0, USER_EVENT(incrementCount));
+    addEvent(0, USER_EVENT(incrementCount));
+    addEvent(TRUE_IDLE, USER_EVENT(incrementCount));
+    applyEventRules(0, NULL);
+    applyEventRules(TRUE_IDLE, NULL);
+    char* json = readTimeline();
+    assertEquals(countOccurrences(json, "\"incrementCount\""), 3);
+    assertEquals(countOccurrences(json, "\"cat\":\"rule\""), 3);
+    // X events get their span from processXEvent
+    assertEquals(countOccurrences(json, "\"cat\":\"event\""), 1);
+    assert(strstr(json, "{\"name\":\"TRUE_IDLE\""));
+}
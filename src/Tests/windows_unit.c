@@ -1,3 +1,4 @@
+#include "../util/string-table.h"
 #include "../windows.h"
 
 #include "test-mpx-helper.h"
@@ -83,7 +84,7 @@ SCUTEST(moveWorkspaces) {
         moveToWorkspace(winInfo, 0);
     }
     int i = 1;
-    FOR_EACH(WindowInfo*, winInfo, getWorkspaceWindowStack(getWorkspace(0))) {
+    FOR_EACH_VALUE(WindowInfo*, winInfo, getWorkspaceWindowStack(getWorkspace(0))) {
         assertEquals(winInfo->id, i++);
     }
     FOR_EACH(WindowInfo*, winInfo, getAllWindows()) {
@@ -112,3 +113,82 @@ SCUTEST_ITER(test_sticky_window_add, 2) {
     assert(hasMask(winInfo, STICKY_MASK));
     assertEquals(!getWorkspaceOfWindow(winInfo), notInAnyWorkpace);
 }
+SCUTEST(test_get_window_info) {
+    int N = 100;
+    for(int i = 1; i <= N; i++)
+        addFakeWindowInfo(i);
+    for(int i = 1; i <= N; i++)
+        assertEquals(getWindowInfo(i)->id, i);
+    assert(!getWindowInfo(N + 1));
+    for(int i = 1; i <= N; i += 2)
+        freeWindowInfo(getWindowInfo(i));
+    for(int i = 1; i <= N; i++)
+        assertEquals(!getWindowInfo(i), i % 2);
+}
+SCUTEST(test_window_slot_reuse) {
+    int N = 1000;
+    for(int i = 1; i <= N; i++)
+        strcpy(getWindowProperties(addFakeWindowInfo(i))->title, "title");
+    for(int i = 1; i <= N; i++)
+        assertEquals(getWindowInfo(i)->slot, i - 1);
+    WindowInfo* winInfo = getWindowInfo(N / 2);
+    uint32_t slot = winInfo->slot;
+    freeWindowInfo(winInfo);
+    WindowInfo* newWinInfo = addFakeWindowInfo(N + 1);
+    assert(winInfo == newWinInfo);
+    assertEquals(newWinInfo->slot, slot);
+    assert(!newWinInfo->mask);
+    assertEqualsStr(getWindowProperties(newWinInfo)->title, "");
+    for(int i = 1; i <= N + 1; i++)
+        if(i != N / 2)
+            assertEqualsStr(getWindowProperties(getWindowInfo(i))->title, i <= N ? "title" : "");
+}
+SCUTEST(test_window_properties_released) {
+    for(int i = 1; i <= 10; i++) {
+        WindowProperties* properties = getWindowProperties(addFakeWindowInfo(i));
+        assertEqualsStr(properties->className, "");
+        replaceInternedString(&properties->className, i % 2 ? "odd" : "even");
+        replaceInternedString(&properties->role, "role");
+    }
+    assertEquals(getNumberOfInternedStrings(), 3);
+    assert(getWindowProperties(getWindowInfo(1))->className == getWindowProperties(getWindowInfo(3))->className);
+    FOR_EACH_R(WindowInfo*, winInfo, getAllWindows()) {
+        freeWindowInfo(winInfo);
+    }
+    assertEquals(getNumberOfInternedStrings(), 0);
+}
+SCUTEST(test_window_mask_index) {
+    int N = 200;
+    for(int i = 1; i <= N; i++)
+        addFakeWindowInfo(i);
+    for(int i = 1; i <= N; i += 3)
+        addMask(getWindowInfo(i), URGENT_MASK | HIDDEN_MASK);
+    toggleMask(getWindowInfo(2), URGENT_MASK);
+    removeMask(getWindowInfo(4), HIDDEN_MASK);
+    assertEquals(getNumberOfWindowsWithMask(URGENT_MASK), (N + 2) / 3 + 1);
+    assertEquals(getNumberOfWindowsWithMask(HIDDEN_MASK), (N + 2) / 3 - 1);
+    assertEquals(getNumberOfWindowsWithMask(STICKY_MASK), 0);
+    int count = 0;
+    FOR_EACH_WINDOW_WITH_MASK(winInfo, URGENT_MASK) {
+        assert(winInfo->mask & URGENT_MASK);
+        count++;
+    }
+    assertEquals(count, getNumberOfWindowsWithMask(URGENT_MASK));
+    FOR_EACH_WINDOW_WITH_MASK(winInfo, URGENT_MASK) {
+        removeMask(winInfo, URGENT_MASK);
+    }
+    assertEquals(getNumberOfWindowsWithMask(URGENT_MASK), 0);
+    uint32_t slot = 0;
+    assert(!getNextWindowWithMask(URGENT_MASK, &slot));
+}
+SCUTEST(test_window_mask_index_cleared_on_free) {
+    WindowInfo* winInfo = addFakeWindowInfo(1);
+    addMask(winInfo, URGENT_MASK);
+    freeWindowInfo(winInfo);
+    assertEquals(getNumberOfWindowsWithMask(URGENT_MASK), 0);
+    winInfo = addFakeWindowInfo(2);
+    uint32_t slot = 0;
+    assert(!getNextWindowWithMask(URGENT_MASK, &slot));
+    addMask(winInfo, URGENT_MASK);
+    assertEquals(getNextWindowWithMask(URGENT_MASK, &slot), winInfo);
+}
@@ -5,6 +5,7 @@
 #include "../layouts.h"
 #include "../wm-rules.h"
 #include "../wmfunctions.h"
+#include "../xutil/window-properties.h"
 #include "test-event-helper.h"
 #include "test-wm-helper.h"
 #include "tester.h"
@@ -148,6 +149,61 @@ SCUTEST(test_switching_workspaces) {
     assert(isWindowMapped(win));
     assert(!isWindowMapped(win2));
 }
+SCUTEST(test_load_window_properties_of_windows) {
+    WindowInfo* windows[10];
+    for(int i = 0; i < LEN(windows); i++) {
+        WindowID win = i % 2 ? createNormalWindow() : createWindowWithType(ewmh->_NET_WM_WINDOW_TYPE_DOCK);
+        setWindowClass(win, "class", "instance");
+        setWindowRole(win, "role");
+        if(i % 2)
+            xcb_icccm_set_wm_name(dis, win, XCB_ATOM_STRING, 8, strlen("legacy"), "legacy");
+        else
+            setWindowTitle(win, "title");
+        windows[i] = addFakeWindowInfo(win);
+    }
+    clearAtomCache();
+    uint32_t roundTrips = numberOfXRoundTrips;
+    loadWindowPropertiesOfWindows(windows, LEN(windows));
+    assertEquals(numberOfXRoundTrips - roundTrips, 2);
+    // the type names are now cached
+    roundTrips = numberOfXRoundTrips;
+    loadWindowPropertiesOfWindows(windows, LEN(windows));
+    assertEquals(numberOfXRoundTrips - roundTrips, 1);
+    for(int i = 0; i < LEN(windows); i++) {
+        WindowProperties* properties = getWindowProperties(windows[i]);
+        assertEqualsStr(properties->className, "class");
+        assertEqualsStr(properties->instanceName, "instance");
+        assertEqualsStr(properties->role, "role");
+        assertEqualsStr(properties->title, i % 2 ? "legacy" : "title");
+        assertEqualsStr(properties->typeName, i % 2 ? "_NET_WM_WINDOW_TYPE_NORMAL" : "_NET_WM_WINDOW_TYPE_DOCK");
+        assertEquals(windows[i]->dock, !(i % 2));
+        assertEquals(windows[i]->geometry.width, 1);
+    }
+}
+SCUTEST(test_prefetch_window_properties) {
+    WindowID win = createNormalWindow();
+    runEventLoop();
+    WindowInfo* winInfo = getWindowInfo(win);
+    assert(winInfo->pendingProperties);
+    setWindowTitle(win, "title");
+    setWindowClass(win, "class", "instance");
+    getAtomName(ewmh->_NET_WM_WINDOW_TYPE_NORMAL, NULL);
+    runEventLoop();
+    uint32_t roundTrips = numberOfXRoundTrips;
+    loadWindowProperties(winInfo);
+    assert(!winInfo->pendingProperties);
+    assertEquals(numberOfXRoundTrips - roundTrips, 0);
+    assertEqualsStr(getWindowProperties(winInfo)->title, "title");
+    assertEqualsStr(getWindowProperties(winInfo)->className, "class");
+}
+SCUTEST(test_prefetch_window_properties_destroy) {
+    WindowID win = createNormalWindow();
+    runEventLoop();
+    assert(getWindowInfo(win)->pendingProperties);
+    destroyWindow(win);
+    runEventLoop();
+    assert(!getWindowInfo(win));
+}
 static void setupEnvWithAutoTileRules() {
     addAutoTileRules();
     setupEnvWithBasicRules();
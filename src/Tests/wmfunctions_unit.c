@@ -261,4 +261,24 @@ SCUTEST(test_updateFocusForAllMasters) {
     updateFocusForAllMasters(getWindowInfo(win2));
     assertEquals(getActiveFocus(), win);
 }
+SCUTEST(test_failed_focus_tries_next_window) {
+    CRASH_ON_ERRORS = 0;
+    suppressOutput();
+    addEvent(0, DEFAULT_EVENT(logError));
+    onFocusFailure = updateFocusAfterFailure;
+    WindowID win = mapArbitraryWindow();
+    WindowID win2 = mapArbitraryWindow();
+    scan(root);
+    assert(focusWindow(win));
+    onWindowFocus(win);
+    // win2 is still recorded as mapped so the failure is only detected when the error is processed
+    xcb_unmap_window(dis, win2);
+    assert(focusWindowInfo(getWindowInfo(win2)));
+    assertEquals(getFocusedWindow(), getWindowInfo(win2));
+    flush();
+    while(getFocusedWindow() == getWindowInfo(win2))
+        processXEvent(xcb_wait_for_event(dis));
+    assertEquals(getFocusedWindow(), getWindowInfo(win));
+    assertEquals(getActiveFocus(), win);
+}
 
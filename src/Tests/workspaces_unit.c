@@ -59,6 +59,32 @@ SCUTEST(test_workspace_window_add) {
     assertEquals(getWorkspace(0), getWorkspaceOfWindow(getWindowInfo(1)));
     assertEquals(getWorkspace(0), getWorkspaceOfWindow(getWindowInfo(2)));
 }
+SCUTEST(test_workspace_of_window) {
+    addWorkspaces(3);
+    WindowInfo* winInfo = addFakeWindowInfo(1);
+    assert(!getWorkspaceOfWindow(winInfo));
+    assertEquals(getWorkspaceIndexOfWindow(winInfo), NO_WORKSPACE);
+    for(int i = 0; i < getNumberOfWorkspaces(); i++) {
+        moveToWorkspace(winInfo, i);
+        assertEquals(getWorkspaceOfWindow(winInfo), getWorkspace(i));
+        assertEquals(getWorkspaceIndexOfWindow(winInfo), i);
+    }
+    removeFromWorkspace(winInfo);
+    assert(!getWorkspaceOfWindow(winInfo));
+    for(int i = 0; i < getNumberOfWorkspaces(); i++)
+        assert(!getWorkspaceWindowStack(getWorkspace(i))->size);
+}
+SCUTEST(test_workspace_of_window_remove_all_workspaces) {
+    addWorkspaces(1);
+    WindowInfo* winInfo = addFakeWindowInfo(1);
+    moveToWorkspace(winInfo, 0);
+    extern ArrayList workspaces;
+    void freeWorkspace(Workspace * workspace);
+    freeWorkspace(pop(&workspaces));
+    assertEquals(getWorkspaceIndexOfWindow(winInfo), NO_WORKSPACE);
+    addWorkspaces(1);
+    assert(!getWorkspaceOfWindow(winInfo));
+}
 
 SCUTEST(test_has_window_with_workspace) {
     addWorkspaces(1);
@@ -69,6 +95,27 @@ SCUTEST(test_has_window_with_workspace) {
     assert(hasMask(getWindowInfo(1), URGENT_MASK));
     assert(hasWindowWithMask(getWorkspace(0), URGENT_MASK));
 }
+SCUTEST(test_has_window_with_mask_counts) {
+    addWorkspaces(2);
+    WindowInfo* winInfo = addFakeWindowInfo(1);
+    addMask(winInfo, URGENT_MASK | HIDDEN_MASK);
+    assert(!hasWindowWithMask(getWorkspace(0), URGENT_MASK));
+    moveToWorkspace(winInfo, 0);
+    assert(hasWindowWithMask(getWorkspace(0), URGENT_MASK));
+    assert(hasWindowWithMask(getWorkspace(0), URGENT_MASK | HIDDEN_MASK));
+    assert(!hasWindowWithMask(getWorkspace(0), URGENT_MASK | STICKY_MASK));
+    moveToWorkspace(winInfo, 1);
+    assert(!hasWindowWithMask(getWorkspace(0), URGENT_MASK));
+    assert(hasWindowWithMask(getWorkspace(1), URGENT_MASK));
+    removeMask(winInfo, URGENT_MASK);
+    assert(!hasWindowWithMask(getWorkspace(1), URGENT_MASK));
+    assertEquals(getWorkspace(1)->windowMaskCounts[__builtin_ctz(HIDDEN_MASK)], 1);
+    getWorkspace(1)->mask = STICKY_MASK;
+    assert(hasWindowWithMask(getWorkspace(1), STICKY_MASK | HIDDEN_MASK));
+    removeFromWorkspace(winInfo);
+    assertEquals(getWorkspace(1)->windowMaskCounts[__builtin_ctz(HIDDEN_MASK)], 0);
+    assert(!hasWindowWithMask(getWorkspace(1), STICKY_MASK));
+}
 SCUTEST(test_monitor_add) {
     addWorkspaces(1);
     Monitor* m = addDummyMonitor();
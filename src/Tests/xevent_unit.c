@@ -1,7 +1,9 @@
 #include <poll.h>
 #include <sys/eventfd.h>
+#include <sys/resource.h>
 #include <unistd.h>
 
+#include "../util/timeline.h"
 #include "test-event-helper.h"
 #include "test-x-helper.h"
 #include "tester.h"
@@ -37,6 +39,48 @@ SCUTEST(test_idle, .iter = 2, .timeout = 1) {
     runEventLoop();
 }
 
+SCUTEST(test_idle_property_counters) {
+    xcb_generic_event_t event = {.response_type = XCB_UNMAP_NOTIFY};
+    for(int i = 0; i < 3; i++)
+        xcb_send_event(dis, 0, root, ROOT_EVENT_MASKS, (char*) &event);
+    // the property write is a tracked request so the idle one reports at least it
+    setIdleProperty();
+    addEvent(TRUE_IDLE, DEFAULT_EVENT(setIdleProperty));
+    runEventLoop();
+    xcb_get_property_reply_t* reply = xcb_get_property_reply(dis, xcb_get_property(dis, 0, getPrivateWindow(),
+                MPX_IDLE_PROPERTY, XCB_ATOM_CARDINAL, 0, 4), NULL);
+    assert(reply);
+    assertEquals(xcb_get_property_value_length(reply), 4 * sizeof(uint32_t));
+    uint32_t* values = xcb_get_property_value(reply);
+    assertEquals(values[0], getIdleCount());
+    assertEquals(values[1], getNumberOfProcessedEvents());
+    assert(values[1] >= 3);
+    assert(values[2]);
+    // the last write is tracked after its values were computed
+    assert(values[2] < lastTrackedRequestSequence);
+    assertEquals(values[3], numberOfXRoundTrips);
+    free(reply);
+}
+
+SCUTEST(test_timeline_x_event_spans) {
+    const char* path = "/tmp/mpx-test-timeline.json";
+    assert(startTimeline(path));
+    xcb_generic_event_t event = {.response_type = XCB_UNMAP_NOTIFY};
+    xcb_send_event(dis, 0, root, ROOT_EVENT_MASKS, (char*) &event);
+    addEvent(XCB_UNMAP_NOTIFY, DEFAULT_EVENT(incrementCount));
+    runEventLoop();
+    stopTimeline();
+    char buffer[4096] = {0};
+    FILE* file = fopen(path, "r");
+    fread(buffer, 1, sizeof(buffer) - 1, file);
+    fclose(file);
+    unlink(path);
+    assert(strstr(buffer, "{\"name\":\"XCB_UNMAP_NOTIFY\",\"ph\":\"X\""));
+    assert(strstr(buffer, "\"cat\":\"x-event\""));
+    assert(strstr(buffer, "{\"name\":\"_incrementCount\",\"ph\":\"X\""));
+    assert(strstr(buffer, "{\"name\":\"event queue\",\"ph\":\"C\""));
+}
+
 static void test_xi_event_helper(xcb_input_hierarchy_event_t* event) {
     assert(event);
     incrementCount();
@@ -59,6 +103,17 @@ SCUTEST(test_backlog_of_events, .iter = 3, .timeout = 5) {
     runEventLoop();
     assertEquals(totalEvents, getCount());
 }
+SCUTEST(test_backlog_of_events_stress, .iter = 2, .timeout = 30) {
+    X_READER_THREAD = _i;
+    int totalEvents = 100000;
+    addEvent(XCB_UNMAP_NOTIFY, DEFAULT_EVENT(incrementCount));
+    xcb_generic_event_t event = {.response_type = XCB_UNMAP_NOTIFY};
+    for(int i = 0; i < totalEvents ; i++)
+        xcb_send_event(dis, 0, root, ROOT_EVENT_MASKS, (char*) &event);
+    runEventLoop();
+    assertEquals(totalEvents, getCount());
+    assert(isEventQueueEmpty());
+}
 
 SCUTEST_SET_ENV(NULL, simpleCleanup, .timeout = 1);
 static int fds[4];
@@ -127,3 +182,95 @@ SCUTEST(test_extra_events_close) {
     write(fds[3], &fds, sizeof(int));
     exit(0);
 }
+
+static xcb_generic_event_t* createFakeEvent(int type, WindowID win, xcb_atom_t atom) {
+    xcb_generic_event_t* event = calloc(1, sizeof(xcb_generic_event_t));
+    event->response_type = type;
+    if((type & 127) == XCB_PROPERTY_NOTIFY)
+        *(xcb_property_notify_event_t*)event = (xcb_property_notify_event_t) {.response_type = type, .window = win, .atom = atom};
+    else
+        *(xcb_configure_notify_event_t*)event = (xcb_configure_notify_event_t) {.response_type = type, .window = win};
+    return event;
+}
+static void freeFakeEvents(xcb_generic_event_t** events, int num) {
+    for(int i = 0; i < num; i++)
+        free(events[i]);
+}
+SCUTEST(test_coalesce_events) {
+    COALESCE_EVENT_TYPES = 1ULL << XCB_CONFIGURE_NOTIFY | 1ULL << XCB_PROPERTY_NOTIFY;
+    xcb_generic_event_t* events[] = {
+        createFakeEvent(XCB_CONFIGURE_NOTIFY, 1, 0),
+        createFakeEvent(XCB_CONFIGURE_NOTIFY, 2, 0),
+        createFakeEvent(XCB_PROPERTY_NOTIFY, 1, 10),
+        createFakeEvent(XCB_CONFIGURE_NOTIFY, 1, 0),
+        createFakeEvent(XCB_PROPERTY_NOTIFY, 1, 11),
+        createFakeEvent(XCB_PROPERTY_NOTIFY, 1, 10),
+        createFakeEvent(XCB_UNMAP_NOTIFY, 1, 0),
+        createFakeEvent(XCB_CONFIGURE_NOTIFY, 1, 0),
+        createFakeEvent(XCB_CONFIGURE_NOTIFY | 128, 1, 0),
+    };
+    xcb_generic_event_t* expected[] = {events[1], events[3], events[4], events[5], events[6], events[7], events[8]};
+    int num = coalesceEvents(events, LEN(events));
+    assertEquals(num, LEN(expected));
+    for(int i = 0; i < num; i++)
+        assertEquals(events[i], expected[i]);
+    assertEquals(getNumberOfCoalescedEvents(XCB_CONFIGURE_NOTIFY), 1);
+    assertEquals(getNumberOfCoalescedEvents(XCB_PROPERTY_NOTIFY), 1);
+    freeFakeEvents(events, num);
+}
+SCUTEST(test_coalesce_events_disabled) {
+    COALESCE_EVENT_TYPES = 1ULL << XCB_PROPERTY_NOTIFY;
+    xcb_generic_event_t* events[MPX_EVENT_QUEUE_SIZE];
+    for(int i = 0; i < LEN(events); i++)
+        events[i] = createFakeEvent(i % 2 ? XCB_CONFIGURE_NOTIFY : XCB_PROPERTY_NOTIFY, 1, 1);
+    int num = coalesceEvents(events, LEN(events));
+    assertEquals(num, LEN(events) / 2 + 1);
+    assertEquals(getNumberOfCoalescedEvents(XCB_CONFIGURE_NOTIFY), 0);
+    assertEquals(getNumberOfCoalescedEvents(XCB_PROPERTY_NOTIFY), LEN(events) / 2 - 1);
+    freeFakeEvents(events, num);
+}
+SCUTEST(test_coalesce_events_off_by_default) {
+    xcb_generic_event_t* events[] = {
+        createFakeEvent(XCB_CONFIGURE_NOTIFY, 1, 0),
+        createFakeEvent(XCB_CONFIGURE_NOTIFY, 1, 0),
+    };
+    assertEquals(coalesceEvents(events, LEN(events)), LEN(events));
+    assertEquals(getNumberOfCoalescedEvents(XCB_CONFIGURE_NOTIFY), 0);
+    freeFakeEvents(events, LEN(events));
+}
+
+#define NUM_PIPES 1000
+static FDHandler* pipeHandlers[NUM_PIPES];
+static int pipeReadFDs[NUM_PIPES];
+static void readAndRemove(int fd, int revents, FDHandler** handler) {
+    char c;
+    assertEquals(read(fd, &c, 1), 1);
+    assertEquals(fd, pipeReadFDs[handler - pipeHandlers]);
+    removeExtraEvent(*handler);
+    incrementCount();
+    if(getCount() == NUM_PIPES)
+        requestShutdown();
+}
+SCUTEST(test_extra_events_many_fds, .timeout = 5) {
+    struct rlimit limit;
+    getrlimit(RLIMIT_NOFILE, &limit);
+    limit.rlim_cur = limit.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &limit);
+    openXDisplay();
+    for(int i = 0; i < NUM_PIPES; i++) {
+        int pipeFDs[2];
+        assert(pipe(pipeFDs) == 0);
+        pipeReadFDs[i] = pipeFDs[0];
+        pipeHandlers[i] = addExtraEventWithData(pipeFDs[0], POLLIN, i % 2, readAndRemove, &pipeHandlers[i]);
+        assert(pipeHandlers[i]);
+        write(pipeFDs[1], "", 1);
+        close(pipeFDs[1]);
+    }
+    assertEquals(getNumberOfExtraEvents(), NUM_PIPES);
+    runEventLoop();
+    assertEquals(getCount(), NUM_PIPES);
+    // only the X connection is left
+    assertEquals(getNumberOfExtraEvents(), 1);
+    for(int i = 0; i < NUM_PIPES; i++)
+        close(pipeReadFDs[i]);
+}
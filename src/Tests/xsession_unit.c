@@ -42,6 +42,41 @@ SCUTEST_ITER(get_set_atom, 2) {
     assertEqualsStr(buffer, getAtomName(test, buffer2));
 }
 
+SCUTEST(test_atom_cache) {
+    uint32_t roundTrips = numberOfXRoundTrips;
+    xcb_atom_t atom = getAtom("MPX_TEST_ATOM");
+    assertEquals(getAtom("MPX_TEST_ATOM"), atom);
+    assertEqualsStr(getAtomName(atom, NULL), "MPX_TEST_ATOM");
+    assertEquals(numberOfXRoundTrips - roundTrips, 1);
+    assertEqualsStr(getAtomName(ewmh->_NET_WM_NAME, NULL), "_NET_WM_NAME");
+    assertEqualsStr(getCachedAtomName(ewmh->_NET_WM_NAME), "_NET_WM_NAME");
+    clearAtomCache();
+    assert(!getCachedAtomName(atom));
+    assertEquals(getAtom("MPX_TEST_ATOM"), atom);
+}
+SCUTEST(test_create_atoms) {
+    xcb_atom_t atoms[3];
+    AtomBinding bindings[] = {{"MPX_TEST_ATOM", &atoms[0]}, {"MPX_TEST_ATOM2", &atoms[1]}, {"WM_STATE", &atoms[2]}};
+    for(int i = 0; i < 2; i++) {
+        uint32_t roundTrips = numberOfXRoundTrips;
+        createAtoms(bindings, LEN(bindings));
+        // only the first call needs a round trip
+        assertEquals(numberOfXRoundTrips - roundTrips, !i);
+        assert(atoms[0] && atoms[1] && atoms[0] != atoms[1]);
+        assertEquals(atoms[2], WM_STATE);
+    }
+}
+SCUTEST(test_add_atoms_to_create) {
+    static xcb_atom_t atom;
+    static AtomBinding bindings[] = {{"MPX_TEST_ATOM", &atom}};
+    addAtomsToCreate(bindings, LEN(bindings));
+    assertEquals(atom, getAtom("MPX_TEST_ATOM"));
+    closeConnection();
+    atom = 0;
+    openXDisplay();
+    assertEquals(atom, getAtom("MPX_TEST_ATOM"));
+}
+
 SCUTEST(get_set_atom_bad) {
     assert(getAtom(NULL) == XCB_ATOM_NONE);
     assert(!getAtomName(-1, NULL));
@@ -76,7 +111,7 @@ SCUTEST(reopen_display) {
 }
 
 SCUTEST(create_destroy_window) {
-    assert(!destroyWindow(createNormalWindow()));
+    destroyWindow(createNormalWindow());
 }
 
 SCUTEST(attemptToMapWindow) {
@@ -129,6 +164,54 @@ SCUTEST_ITER_ERR(crash_on_error, 2, 1) {
     else
         assert(catchError(xcb_map_window_checked(dis, 0)) == BadWindow);
 }
+static void countErrors(xcb_generic_error_t* e, void* arg) {
+    assertEquals(e->error_code, BadWindow);
+    (*(int*)arg)++;
+}
+SCUTEST(test_on_x_error) {
+    CRASH_ON_ERRORS = 0;
+    suppressOutput();
+    addEvent(0, DEFAULT_EVENT(logError));
+    int errors = 0;
+    WindowID win = createNormalWindow();
+    uint32_t roundTrips = numberOfXRoundTrips;
+    onXError(xcb_map_window(dis, 0), countErrors, &errors);
+    onXError(xcb_map_window(dis, win), countErrors, &errors);
+    xcb_map_window(dis, 0);
+    assertEquals(getNumberOfPendingErrorHandlers(), 2);
+    for(int i = 0; i < 2; i++) {
+        xcb_generic_event_t* event = xcb_wait_for_event(dis);
+        assert(event);
+        assertEquals(event->response_type, 0);
+        processXEvent(event);
+        // the first error runs its handler and the second shows that the successful request can no longer fail
+        assertEquals(errors, 1);
+        assertEquals(getNumberOfPendingErrorHandlers(), 1 - i);
+    }
+    assertEquals(numberOfXRoundTrips, roundTrips);
+}
+static void processFakeError(uint32_t fullSequence) {
+    xcb_generic_error_t* e = calloc(1, sizeof(xcb_generic_error_t));
+    e->error_code = BadWindow;
+    e->sequence = fullSequence;
+    e->full_sequence = fullSequence;
+    processXEvent((xcb_generic_event_t*)e);
+}
+SCUTEST(test_on_x_error_full_sequence) {
+    CRASH_ON_ERRORS = 0;
+    suppressOutput();
+    addEvent(0, DEFAULT_EVENT(logError));
+    int errors = 0;
+    uint32_t sequence = lastTrackedRequestSequence + (1 << 16);
+    onXError((xcb_void_cookie_t) {sequence}, countErrors, &errors);
+    // the 16-bit sequence of this older error is 1 more than the handler's
+    processFakeError(sequence - (1 << 16) + 1);
+    assertEquals(errors, 0);
+    assertEquals(getNumberOfPendingErrorHandlers(), 1);
+    processFakeError(sequence);
+    assertEquals(errors, 1);
+    assertEquals(getNumberOfPendingErrorHandlers(), 0);
+}
 SCUTEST(load_unknown_generic_events) {
     xcb_ge_generic_event_t event = {0};
     assert(loadGenericEvent(&event) == 0);
@@ -175,7 +258,7 @@ SCUTEST(test_event_spam) {
     startWM();
     while(!isShuttingDown()) {
         lock();
-        assert(!destroyWindow(createNormalWindow()));
+        destroyWindow(createNormalWindow());
         flush();
         unlock();
     }
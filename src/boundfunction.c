@@ -1,99 +1,344 @@
 #include "boundfunction.h"
+#include "globals.h"
 #include "mywm-structs.h"
 #include "user-events.h"
 #include "util/arraylist.h"
 #include "util/debug.h"
+#include "util/histogram.h"
 #include "util/logger.h"
+#include "util/slab.h"
+#include "util/time.h"
+#include "util/timeline.h"
+#include "windows.h"
+#include "xutil/xsession.h"
+#include <stddef.h>
 #include <stdlib.h>
+#include <string.h>
 
 /// Holds batch events
 typedef struct {
     /// how many times the event has been trigged
     int counter;
     /// the list of events to trigger when counter is non zero
-    ArrayList list;
+    RuleList list;
 } BatchEventList ;
 
 /// Holds an Arraylist of rules that will be applied in response to various conditions
-ArrayList eventRules[NUMBER_OF_MPX_EVENTS];
+RuleList eventRules[NUMBER_OF_MPX_EVENTS];
 BatchEventList batchEventRules[NUMBER_OF_MPX_EVENTS];
+/// bit i is set iff batchEventRules[i].counter is non zero
+static uint64_t triggeredEvents[(NUMBER_OF_MPX_EVENTS + 63) / 64];
 
-ArrayList* getEventList(int type, bool batch) {
+/// State of a rule list that is being applied
+typedef struct {
+    /// number of nested applyRules calls iterating the list
+    uint8_t depth;
+    /// set when a rule was removed while the list was being applied
+    bool hasRemovedRules;
+} DispatchState;
+static DispatchState dispatchState[NUMBER_OF_MPX_EVENTS][2];
+static uint32_t lastRuleID;
+/// time (ns) taken by applyEventRules for each event type
+static Histogram eventLatency[NUMBER_OF_MPX_EVENTS];
+
+const Histogram* getEventLatency(UserEvent type) {
+    return &eventLatency[type];
+}
+void clearEventLatency(void) {
+    for(int i = 0; i < NUMBER_OF_MPX_EVENTS; i++)
+        clearHistogram(&eventLatency[i]);
+}
+
+RuleList* getEventList(int type, bool batch) {
     return batch ? &batchEventRules[type].list : &eventRules[type];
 }
 
-void _addEvent(ArrayList* arr, const BoundFunction func) {
-    BoundFunction* p = malloc(sizeof(BoundFunction));
-    *p = func;
-    addElement(arr, p);
-    for(int i = arr->size - 2; i >= 0; i--) {
-        if(func.priority < ((BoundFunction*)getElement(arr, i))->priority) {
-            swapElements(arr, i, arr, i + 1);
-        }
+static Slab ruleStatsSlab = SLAB(RuleStats);
+
+/// offset of the window field of X events that are about a single window or 0
+static const uint8_t windowOffset[LASTEvent] = {
+    [XCB_VISIBILITY_NOTIFY] = offsetof(xcb_visibility_notify_event_t, window),
+    [XCB_CREATE_NOTIFY] = offsetof(xcb_create_notify_event_t, window),
+    [XCB_DESTROY_NOTIFY] = offsetof(xcb_destroy_notify_event_t, window),
+    [XCB_UNMAP_NOTIFY] = offsetof(xcb_unmap_notify_event_t, window),
+    [XCB_MAP_NOTIFY] = offsetof(xcb_map_notify_event_t, window),
+    [XCB_MAP_REQUEST] = offsetof(xcb_map_request_event_t, window),
+    [XCB_REPARENT_NOTIFY] = offsetof(xcb_reparent_notify_event_t, window),
+    [XCB_CONFIGURE_NOTIFY] = offsetof(xcb_configure_notify_event_t, window),
+    [XCB_CONFIGURE_REQUEST] = offsetof(xcb_configure_request_event_t, window),
+    [XCB_PROPERTY_NOTIFY] = offsetof(xcb_property_notify_event_t, window),
+    [XCB_CLIENT_MESSAGE] = offsetof(xcb_client_message_event_t, window),
+};
+/// @return true if rules for type are passed a WindowInfo
+static inline bool isWindowUserEvent(UserEvent type) {
+    switch(type) {
+        case POST_REGISTER_WINDOW:
+        case UNREGISTER_WINDOW:
+        case CLIENT_MAP_ALLOW:
+        case CLIENT_MAP_DISALLOW:
+        case WORKSPACE_WINDOW_REMOVE:
+        case WORKSPACE_WINDOW_ADD:
+        case WINDOW_MOVE:
+        case WINDOW_FOCUS:
+            return 1;
+        default:
+            return 0;
     }
 }
-void addEvent(UserEvent type, const BoundFunction func) {
-    _addEvent(getEventList(type, 0), func);
+static inline bool canResolveRuleWindow(UserEvent type) {
+    return type < LASTEvent ? windowOffset[type] : isWindowUserEvent(type);
+}
+/// @return the window the event p of type is about or NULL
+static WindowInfo* resolveRuleWindow(UserEvent type, void* p) {
+    if(!p)
+        return NULL;
+    if(type < LASTEvent)
+        return getWindowInfo(*(WindowID*)((char*)p + windowOffset[type]));
+    return p;
+}
+static inline bool matchesPrecondition(const RulePrecondition* precondition, const WindowInfo* winInfo) {
+    if(!winInfo)
+        return 0;
+    if((precondition->flags & DOCKS_ONLY) == DOCKS_ONLY && !winInfo->dock)
+        return 0;
+    if(precondition->type && winInfo->type != precondition->type)
+        return 0;
+    return !(precondition->requiredMask | precondition->forbiddenMask) ||
+        hasAndHasNotMasks(winInfo, precondition->requiredMask, precondition->forbiddenMask);
+}
+
+static RuleHandle _addEvent(UserEvent type, bool batch, BoundFunction func) {
+    RuleList* rules = getEventList(type, batch);
+    RulePrecondition* precondition = &func.precondition;
+    if(precondition->requiredMask || precondition->forbiddenMask || precondition->type)
+        precondition->flags |= MANAGED_WINDOWS_ONLY;
+    assert(!precondition->flags || !batch && canResolveRuleWindow(type));
+    func.stats = slabAlloc(&ruleStatsSlab);
+    func.id = ++lastRuleID;
+    // insert after all rules with the same or higher priority
+    int low = 0, high = rules->size;
+    while(low < high) {
+        int mid = (low + high) / 2;
+        if(rules->data[mid].priority <= func.priority)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    RuleListInsert(rules, low, func);
+    return (RuleHandle) {type, batch, func.id};
+}
+RuleHandle addEvent(UserEvent type, const BoundFunction func) {
+    return _addEvent(type, 0, func);
+}
+RuleHandle addBatchEvent(UserEvent type, const BoundFunction func) {
+    return _addEvent(type, 1, func);
+}
+
+/// @return the index of the rule with id or -1
+static int indexOfRule(const RuleList* rules, uint32_t id) {
+    for(int i = 0; i < rules->size; i++)
+        if(rules->data[i].id == id)
+            return i;
+    return -1;
+}
+/// Marks a rule that has been removed but not deleted yet
+static inline bool isRemovedRule(const BoundFunction* func) {
+    return !func->func.func;
+}
+bool removeRule(RuleHandle handle) {
+    RuleList* rules = getEventList(handle.type, handle.batch);
+    int index = handle.id ? indexOfRule(rules, handle.id) : -1;
+    if(index == -1 || isRemovedRule(&rules->data[index]))
+        return 0;
+    DispatchState* state = &dispatchState[handle.type][handle.batch];
+    if(state->depth) {
+        // removing the rule would shift the rules that are being iterated; it is deleted once the list is done
+        rules->data[index].func.func = NULL;
+        state->hasRemovedRules = 1;
+    }
+    else
+        slabFree(&ruleStatsSlab, RuleListRemoveIndex(rules, index).stats);
+    return 1;
 }
-void addBatchEvent(UserEvent type, const BoundFunction func) {
-    _addEvent(getEventList(type, 1), func);
+/// Deletes the rules removed while the list was being applied
+static void deleteRemovedRules(RuleList* rules) {
+    int size = 0;
+    FOR_EACH_VECTOR(BoundFunction, func, rules) {
+        if(!isRemovedRule(func))
+            rules->data[size++] = *func;
+        else
+            slabFree(&ruleStatsSlab, func->stats);
+    }
+    rules->size = size;
 }
 
 void clearAllRules() {
     for(int i = 0; i < NUMBER_OF_MPX_EVENTS; i++) {
-        FOR_EACH(BoundFunction*, f, &eventRules[i]) {
-            free(f);
+        for(int batch = 0; batch < 2; batch++) {
+            RuleList* rules = getEventList(i, batch);
+            DispatchState* state = &dispatchState[i][batch];
+            if(state->depth) {
+                // like removeRule, the rules (and their stats) are only deleted once the list is no longer applied
+                FOR_EACH_VECTOR(BoundFunction, func, rules) {
+                    func->func.func = NULL;
+                }
+                state->hasRemovedRules |= rules->size != 0;
+                continue;
+            }
+            FOR_EACH_VECTOR(BoundFunction, func, rules) {
+                slabFree(&ruleStatsSlab, func->stats);
+            }
+            RuleListClear(rules);
         }
-        FOR_EACH(BoundFunction*, f, &batchEventRules[i].list) {
-            free(f);
-        }
-        clearArray(&eventRules[i]);
-        clearArray(&batchEventRules[i].list);
+        batchEventRules[i].counter = 0;
     }
+    memset(triggeredEvents, 0, sizeof(triggeredEvents));
+}
+
+void clearRuleStats(void) {
+    for(int i = 0; i < NUMBER_OF_MPX_EVENTS; i++)
+        for(int batch = 0; batch < 2; batch++) {
+            FOR_EACH_VECTOR(BoundFunction, func, getEventList(i, batch)) {
+                *func->stats = (RuleStats) {0};
+            }
+        }
+}
+
+#ifndef NO_RULE_PROFILER
+/// time (ns) and X time spent in rules that finished while the current rule was running
+static TimeStamp nestedRuleTime, nestedXTime;
+/// The state of the clocks when a rule started
+typedef struct {
+    TimeStamp start;
+    TimeStamp xStart;
+    /// the values of nestedRuleTime and nestedXTime for the enclosing rule
+    TimeStamp outerNestedTime;
+    TimeStamp outerNestedXTime;
+} RuleTimer;
+static inline void startRuleTimer(RuleTimer* timer) {
+    *timer = (RuleTimer) {getTimeNs(), getXRoundTripTime(), nestedRuleTime, nestedXTime};
+    nestedRuleTime = nestedXTime = 0;
+}
+static inline void stopRuleTimer(RuleTimer* timer, RuleStats* stats, bool abort) {
+    TimeStamp time = getTimeNs() - timer->start;
+    TimeStamp xTime = getXRoundTripTime() - timer->xStart;
+    TimeStamp selfTime = time - nestedRuleTime;
+    stats->invocations++;
+    stats->aborts += abort;
+    stats->selfTime += selfTime;
+    stats->xTime += xTime - nestedXTime;
+    if(selfTime > stats->maxTime)
+        stats->maxTime = selfTime;
+    nestedRuleTime = timer->outerNestedTime + time;
+    nestedXTime = timer->outerNestedXTime + xTime;
 }
+#endif
 
-static bool applyRules(ArrayList* rules, void* p) {
-    INFO("Attempting to apply %d rules", rules->size);
-    FOR_EACH(BoundFunction*, func, rules) {
-        DEBUG("Running func: %s %p", func->name, p);
-        pushContext(func->name);
+static bool applyRules(UserEvent type, bool batch, void* p) {
+    RuleList* rules = getEventList(type, batch);
+    DispatchState* state = &dispatchState[type][batch];
+    bool result = 1;
+    // the window preconditions are checked against; looked up at most once between rules that run
+    WindowInfo* winInfo = NULL;
+    bool resolvedWindow = 0;
+    TRACE("Attempting to apply %d rules", rules->size);
+    state->depth++;
+    for(int i = 0; i < rules->size; i++) {
+        // copied because rules may be added while func is running
+        const BoundFunction func = *RuleListGet(rules, i);
+        if(isRemovedRule(&func))
+            continue;
+        if(func.precondition.flags) {
+            if(!resolvedWindow) {
+                winInfo = resolveRuleWindow(type, p);
+                resolvedWindow = 1;
+            }
+            if(!matchesPrecondition(&func.precondition, winInfo))
+                continue;
+        }
+        DEBUG("Running func: %s %p", func.name, p);
+        pushContext(func.name);
+#ifndef NO_RULE_PROFILER
+        RuleTimer timer;
+        // checked once so a rule that toggles profiling doesn't see a half set timer
+        bool profile = PROFILE_RULES && func.stats;
+        if(profile)
+            startRuleTimer(&timer);
+#endif
+        TimeStamp spanStart = TIMELINE_SPAN_START();
         int abort = 0;
-        if(func->intFunc)
-            abort = !func->func.intFunc(p, func->arg) && func->abort;
+        if(func.intFunc)
+            abort = !func.func.intFunc(p, func.arg) && func.abort;
         else
-            func->func.func(p, func->arg);
+            func.func.func(p, func.arg);
+#ifndef NO_RULE_PROFILER
+        if(profile)
+            stopRuleTimer(&timer, func.stats, abort);
+#endif
+        TIMELINE_SPAN_END(spanStart, func.name, "rule");
         popContext();
+        // the rule may have changed or freed the window
+        resolvedWindow = 0;
         if(abort) {
-            INFO("Rules aborted early due to: %s", func->name);
-            return 0;
+            INFO("Rules aborted early due to: %s", func.name);
+            result = 0;
+            break;
         }
+        // rules added before func shift it back; continue after it so no rule is skipped or run twice
+        if(i >= rules->size || rules->data[i].id != func.id)
+            i = indexOfRule(rules, func.id);
     }
-    return 1;
+    if(!--state->depth && state->hasRemovedRules) {
+        state->hasRemovedRules = 0;
+        deleteRemovedRules(rules);
+    }
+    return result;
 }
 void incrementBatchEventRuleCounter(UserEvent i) {
     assert(i < LEN(batchEventRules));
     batchEventRules[i].counter++;
+    triggeredEvents[i / 64] |= 1ULL << i % 64;
 }
 int getNumberOfEventsTriggerSinceLastIdle(UserEvent type) {
     return batchEventRules[type].counter;
 }
+/// @return the first event type >= start that has been triggered since the last batch or -1
+static int getNextTriggeredEvent(int start) {
+    for(int word = start / 64; word < LEN(triggeredEvents); word++) {
+        uint64_t bits = triggeredEvents[word];
+        if(word == start / 64)
+            bits &= ~0ULL << start % 64;
+        if(bits)
+            return word * 64 + __builtin_ctzll(bits);
+    }
+    return -1;
+}
 void applyBatchEventRules(void) {
     pushContext("BATCH");
-    for(UserEvent i = 0; i < NUMBER_OF_MPX_EVENTS; i++)
-        if(getNumberOfEventsTriggerSinceLastIdle(i)) {
-            pushContext(eventTypeToString(i));
-            INFO("Event occurred: %d", getNumberOfEventsTriggerSinceLastIdle(i));
-            if(batchEventRules[i].list.size)
-                applyRules(&batchEventRules[i].list, NULL);
-            popContext();
-            batchEventRules[i].counter = 0;
-        }
+    // types triggered by the batch rules are picked up in this pass if they come after the type being processed
+    for(int i = getNextTriggeredEvent(0); i != -1; i = getNextTriggeredEvent(i + 1)) {
+        pushContext(eventTypeToString(i));
+        DEBUG("Event occurred: %d", getNumberOfEventsTriggerSinceLastIdle(i));
+        if(batchEventRules[i].list.size)
+            applyRules(i, 1, NULL);
+        popContext();
+        batchEventRules[i].counter = 0;
+        triggeredEvents[i / 64] &= ~(1ULL << i % 64);
+    }
     popContext();
 }
 bool applyEventRules(UserEvent type, void* p) {
+    // the clock is only read when there is something to time
+    TimeStamp start = eventRules[type].size ? getTimeNs() : 0;
     incrementBatchEventRuleCounter(type);
+    // X events already have a span from processXEvent
+    TimeStamp spanStart = type > GENERIC_EVENT_OFFSET ? TIMELINE_SPAN_START() : 0;
     pushContext(eventTypeToString(type));
-    bool result = applyRules(&eventRules[type], p);
+    bool result = applyRules(type, 0, p);
     popContext();
+    TIMELINE_SPAN_END(spanStart, eventTypeToString(type), "event");
+    // events without rules aren't recorded so they don't show up as zero latency samples
+    if(start)
+        addHistogramValue(&eventLatency[type], getTimeNs() - start);
     return result;
 }
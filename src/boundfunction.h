@@ -10,6 +10,8 @@
 
 #include "mywm-structs.h"
 #include "user-events.h"
+#include "util/histogram.h"
+#include "util/vector.h"
 
 typedef int8_t FunctionPriority;
 /// @{
@@ -24,6 +26,43 @@ typedef int8_t FunctionPriority;
 #define LOWEST_PRIORITY  (127)
 /// @}
 
+/// Profiling counters of a single rule; only updated while PROFILE_RULES is set
+typedef struct RuleStats {
+    uint32_t invocations;
+    /// number of times the rule prevented later rules from running
+    uint32_t aborts;
+    /// time (ns) spent running the rule excluding any rules it triggered
+    TimeStamp selfTime;
+    /// the longest self time of a single call
+    TimeStamp maxTime;
+    /// time (ns) of selfTime spent waiting for X replies
+    TimeStamp xTime;
+} RuleStats;
+
+/// Flags of a RulePrecondition
+typedef enum {
+    /// only run the rule if the event is about a window we have a WindowInfo for
+    MANAGED_WINDOWS_ONLY = 1 << 0,
+    /// only run the rule if the window is a dock; implies MANAGED_WINDOWS_ONLY
+    DOCKS_ONLY = 1 << 1 | MANAGED_WINDOWS_ONLY,
+} RulePreconditionFlags;
+/**
+ * Describes a window the rule cares about so the rule can be skipped without being called.
+ * The window is the WindowInfo passed to window user events (ie WINDOW_MOVE) or the window field of X events like
+ * MapNotify and PropertyNotify.
+ * Setting any field implies MANAGED_WINDOWS_ONLY.
+ */
+typedef struct {
+    /// the window must have all of these masks
+    WindowMask requiredMask;
+    /// the window must not have any of these masks
+    WindowMask forbiddenMask;
+    /// if non zero, the window type must be this atom
+    uint32_t type;
+    /// bitwise or of RulePreconditionFlags
+    uint8_t flags;
+} RulePrecondition;
+
 typedef struct BoundFunction {
     union {
         void(*func)();
@@ -34,7 +73,21 @@ typedef struct BoundFunction {
     FunctionPriority priority;
     char abort;
     Arg arg;
+    /// the rule is only run if the event's window matches
+    RulePrecondition precondition;
+    /// set when the rule is added with addEvent or addBatchEvent
+    RuleStats* stats;
+    /// unique id set when the rule is added
+    uint32_t id;
 } BoundFunction;
+/// Identifies a rule added with addEvent or addBatchEvent
+typedef struct {
+    UserEvent type;
+    bool batch;
+    uint32_t id;
+} RuleHandle;
+/// List of BoundFunctions sorted by priority
+DECLARE_VECTOR(BoundFunction, RuleList)
 /// @{
 /// Creates a BoundFunction with a name based on F with a preset priority
 /// @param F the function to call
@@ -45,8 +98,36 @@ typedef struct BoundFunction {
 #define USER_EVENT(F, P...) __EVENT({.func = F}, #F, 0, P)
 #define USER_FILTER_EVENT(F, P...) __EVENT({.intFunc = F}, #F, 1, P)
 /// @}
-void addEvent(UserEvent type, const BoundFunction func);
-void addBatchEvent(UserEvent type, const BoundFunction func);
+/**
+ * @param type
+ * @param batch if true, return the batch rules for type
+ * @return the list of rules for type
+ */
+RuleList* getEventList(int type, bool batch);
+/**
+ * Adds func to the rules for type after any rules with the same or higher priority.
+ * func may only have a precondition if type is an X event with a window field or a user event whose argument is a
+ * WindowInfo
+ * @param type
+ * @param func
+ * @return a handle that can be passed to removeRule
+ */
+RuleHandle addEvent(UserEvent type, const BoundFunction func);
+/**
+ * Like addEvent but func is run at most once per IDLE if type was triggered.
+ * Batch rules have no window so func cannot have a precondition
+ * @see applyBatchEventRules
+ */
+RuleHandle addBatchEvent(UserEvent type, const BoundFunction func);
+/**
+ * Removes a rule added by addEvent or addBatchEvent.
+ * May be called from any rule including the one being removed; a rule removed while its list is being applied won't
+ * run again.
+ *
+ * @param handle
+ * @return true if the rule was found
+ */
+bool removeRule(RuleHandle handle);
 
 /**
  * Deletes all normal and batch event rules
@@ -86,4 +167,18 @@ void applyBatchEventRules(void);
  * @return the result
  */
 bool applyEventRules(UserEvent type, void* p);
+/**
+ * @param type
+ * @return the time (ns) each call to applyEventRules for type took; nested events are included in the time of the
+ * event that triggered them. Events that had no rules aren't recorded
+ */
+const Histogram* getEventLatency(UserEvent type);
+/**
+ * Clears the histograms returned by getEventLatency
+ */
+void clearEventLatency(void);
+/**
+ * Zeros the RuleStats of every rule
+ */
+void clearRuleStats(void);
 #endif
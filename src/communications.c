@@ -9,11 +9,13 @@
 #include "bindings.h"
 #include "communications.h"
 #include "devices.h"
+#include "event-record.h"
 #include "functions.h"
 #include "layouts.h"
 #include "system.h"
 #include "util/debug.h"
 #include "util/logger.h"
+#include "util/timeline.h"
 #include "windows.h"
 #include "wmfunctions.h"
 #include "xevent.h"
@@ -68,10 +70,12 @@ void callOption(const Option* o, const char* p, const char* p2) {
     }
 }
 
+static void setRuleProfiling(int enable) {PROFILE_RULES = enable;}
 static Option baseOptions[] = {
     {"destroy-win", {destroyWindowInfo}, .flags = USE_FOCUSED},
     {"dump", {dumpWindowByClass}, .flags = REDIRECT_OUTPUT | REQUEST_STR},
     {"dump", {dumpWindowFilter, .arg.i = MAPPABLE_MASK}, .flags = REDIRECT_OUTPUT},
+    {"dump-latency", {dumpLatency}, .flags = REDIRECT_OUTPUT},
     {"dump-master", {dumpMaster, .arg.i = 0}, .flags = REDIRECT_OUTPUT},
     {"dump-rules", {dumpRules},  .flags = REDIRECT_OUTPUT},
     {"dump-win", {dumpWindow},  .flags = REDIRECT_OUTPUT | REQUEST_INT},
@@ -87,23 +91,29 @@ static Option baseOptions[] = {
     {"prev-layout", {cycleLayouts}, DOWN},
     {"prev-win", {shiftFocus}, DOWN},
     {"prev-win-of-class", {shiftFocusToNextClass, .arg.i=DOWN}},
+    {"profile-rules", {setRuleProfiling}, .flags = REQUEST_INT},
     {"quit", {requestShutdown},  .flags = CONFIRM_EARLY | UNSAFE},
     {"raise", {raiseWindow}, .flags = REQUEST_INT},
     {"raise-or-run", {raiseOrRun2},  .flags = REQUEST_STR | REQUEST_MULTI | UNSAFE},
     {"raise-or-run", {raiseOrRun},  .flags = REQUEST_STR | UNSAFE},
     {"raise-or-run-role", {raiseOrRunRole},  .flags = REQUEST_STR | REQUEST_MULTI | UNSAFE},
     {"raise-or-run-title", {raiseOrRunTitle},  .flags = REQUEST_STR | REQUEST_MULTI | UNSAFE},
+    {"record-events", {(void(*)())startRecordingEvents}, .flags = REQUEST_STR},
+    {"reset-stats", {resetStats}},
     {"restart", {restart}, .flags = CONFIRM_EARLY},
     {"shift-focus-down", {shiftFocus, .arg.i=DOWN}},
     {"shift-focus-up", {shiftFocus, .arg.i=UP}},
     {"shift-workspace-down", {shiftWorkspace, .arg.i=DOWN}},
     {"shift-workspace-up", {shiftWorkspace, .arg.i=UP}},
     {"spawn", {spawn},  .flags = REQUEST_STR | UNSAFE},
+    {"stop-recording-events", {stopRecordingEvents}},
+    {"stop-trace", {stopTimeline}},
     {"sum", {printSummary}, .flags = REDIRECT_OUTPUT},
     {"swap-down", {swapPosition, .arg.i=DOWN}},
     {"swap-up", {swapPosition, .arg.i=UP}},
     {"swap-windows", {swapWindows}, .flags = REQUEST_INT|REQUEST_MULTI},
     {"switch-workspace", {switchToWorkspace}, .flags = REQUEST_INT},
+    {"trace", {(void(*)())startTimeline}, .flags = REQUEST_STR},
     {"unhide", {popHiddenWindow}, },
 };
 static ArrayList options;
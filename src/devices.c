@@ -115,7 +115,7 @@ void destroyAllNonEmptyMasters(void) {
 
 void initCurrentMasters() {
     xcb_input_xi_query_device_cookie_t cookie = xcb_input_xi_query_device(dis, XCB_INPUT_DEVICE_ALL);
-    xcb_input_xi_query_device_reply_t *reply = xcb_input_xi_query_device_reply(dis, cookie, NULL);
+    xcb_input_xi_query_device_reply_t *reply = X_ROUND_TRIP(xcb_input_xi_query_device_reply(dis, cookie, NULL));
     xcb_input_xi_device_info_iterator_t  iter = xcb_input_xi_query_device_infos_iterator(reply);
 
     while(iter.rem){
@@ -169,7 +169,7 @@ bool setActiveMasterByDeviceID(MasterID id) {
 
 bool getMousePosition(MasterID id, int relativeWindow, int16_t result[2]) {
     xcb_input_xi_query_pointer_reply_t* reply =
-        xcb_input_xi_query_pointer_reply(dis, xcb_input_xi_query_pointer(dis, relativeWindow, id), NULL);
+        X_ROUND_TRIP(xcb_input_xi_query_pointer_reply(dis, xcb_input_xi_query_pointer(dis, relativeWindow, id), NULL));
     assert(reply);
     if(reply) {
         result[0] = reply->win_x >> 16;
@@ -184,7 +184,7 @@ void setClientPointerForWindow(WindowID window, MasterID id) {
 }
 MasterID getClientPointerForWindow(WindowID win) {
     xcb_input_xi_get_client_pointer_reply_t* reply;
-    reply = xcb_input_xi_get_client_pointer_reply(dis, xcb_input_xi_get_client_pointer(dis, win), NULL);
+    reply = X_ROUND_TRIP(xcb_input_xi_get_client_pointer_reply(dis, xcb_input_xi_get_client_pointer(dis, win), NULL));
 
     MasterID masterPointer = reply ? reply->deviceid: DEFAULT_POINTER;
     free(reply);
@@ -196,7 +196,7 @@ Master* getClientMaster(WindowID win) {
 WindowID getActiveFocusOfMaster(MasterID id) {
     WindowID win = 0;
     xcb_input_xi_get_focus_reply_t* reply;
-    reply = xcb_input_xi_get_focus_reply(dis, xcb_input_xi_get_focus(dis, id), NULL);
+    reply = X_ROUND_TRIP(xcb_input_xi_get_focus_reply(dis, xcb_input_xi_get_focus(dis, id), NULL));
     if(reply) {
         win = reply->focus;
         free(reply);
@@ -209,7 +209,7 @@ void detectMonitors(void) {
 #else
     DEBUG("refreshing monitors");
     xcb_randr_get_monitors_cookie_t cookie = xcb_randr_get_monitors(dis, root, 1);
-    xcb_randr_get_monitors_reply_t* monitors = xcb_randr_get_monitors_reply(dis, cookie, NULL);
+    xcb_randr_get_monitors_reply_t* monitors = X_ROUND_TRIP(xcb_randr_get_monitors_reply(dis, cookie, NULL));
     assert(monitors);
     xcb_randr_monitor_info_iterator_t iter = xcb_randr_get_monitors_monitors_iterator(monitors);
     while(iter.rem) {
@@ -0,0 +1,98 @@
+#include <stdlib.h>
+#include <string.h>
+#include <xcb/xinput.h>
+
+#include "event-record.h"
+#include "util/logger.h"
+#include "util/time.h"
+#include "xutil/xsession.h"
+
+/// the trace being recorded
+static FILE* traceFile;
+/// when the trace being recorded was started
+static TimeStamp traceStartTime;
+
+/// @return the number of bytes xcb allocated for event
+static uint32_t getEventSize(const xcb_generic_event_t* event) {
+    uint32_t size = sizeof(xcb_generic_event_t);
+    if((event->response_type & 127) == XCB_GE_GENERIC)
+        size += ((const xcb_ge_generic_event_t*)event)->length * 4;
+    return size;
+}
+
+bool startRecordingEvents(const char* path) {
+    stopRecordingEvents();
+    traceFile = fopen(path, "w");
+    if(!traceFile) {
+        WARN("Could not open %s to record events", path);
+        return 0;
+    }
+    EventTraceHeader header = {EVENT_TRACE_MAGIC, EVENT_TRACE_VERSION};
+    if(dis && !xcb_connection_has_error(dis))
+        header.xiOpcode = xcb_get_extension_data(dis, &xcb_input_id)->major_opcode;
+    fwrite(&header, sizeof(header), 1, traceFile);
+    traceStartTime = getTimeNs();
+    INFO("Recording events to %s", path);
+    return 1;
+}
+void stopRecordingEvents(void) {
+    if(traceFile) {
+        fclose(traceFile);
+        traceFile = NULL;
+    }
+}
+bool isRecordingEvents(void) {
+    return traceFile;
+}
+
+static void writeRecord(const void* data, uint32_t size) {
+    uint64_t time = getTimeNs() - traceStartTime;
+    fwrite(&time, sizeof(time), 1, traceFile);
+    fwrite(&size, sizeof(size), 1, traceFile);
+    if(size)
+        fwrite(data, size, 1, traceFile);
+}
+void recordXEvent(const xcb_generic_event_t* event) {
+    writeRecord(event, getEventSize(event));
+}
+void recordIdle(void) {
+    writeRecord(NULL, 0);
+    fflush(traceFile);
+}
+
+FILE* openEventTrace(const char* path, EventTraceHeader* header) {
+    FILE* fp = fopen(path, "r");
+    if(!fp) {
+        WARN("Could not open %s", path);
+        return NULL;
+    }
+    if(fread(header, sizeof(EventTraceHeader), 1, fp) != 1 ||
+        memcmp(header->magic, EVENT_TRACE_MAGIC, sizeof(header->magic)) || header->version != EVENT_TRACE_VERSION) {
+        WARN("%s is not a version %d event trace", path, EVENT_TRACE_VERSION);
+        fclose(fp);
+        return NULL;
+    }
+    return fp;
+}
+bool readTraceRecord(FILE* fp, TraceRecord* record) {
+    uint64_t time;
+    uint32_t size;
+    if(fread(&time, sizeof(time), 1, fp) != 1 || fread(&size, sizeof(size), 1, fp) != 1)
+        return 0;
+    record->time = time;
+    record->event = NULL;
+    if(!size)
+        return 1;
+    if(size < sizeof(xcb_generic_event_t)) {
+        WARN("Event record is too small: %d", size);
+        return 0;
+    }
+    record->event = malloc(size);
+    if(fread(record->event, size, 1, fp) != 1 || getEventSize(record->event) != size) {
+        WARN("Event trace is truncated");
+        free(record->event);
+        record->event = NULL;
+        return 0;
+    }
+    return 1;
+}
@@ -0,0 +1,81 @@
+/**
+ * @file event-record.h
+ * @brief Record X events to a binary trace and read them back
+ *
+ * A trace starts with an EventTraceHeader followed by records. Each record is the time (ns) since recording started
+ * as a uint64_t, the size of the event as a uint32_t and then the event exactly as returned by xcb (including
+ * full_sequence and any generic event data). A record with size 0 marks a point where the event loop went idle.
+ * Everything is in host byte order.
+ */
+#ifndef MPX_EVENT_RECORD_H_
+#define MPX_EVENT_RECORD_H_
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <xcb/xcb.h>
+
+#include "mywm-structs.h"
+
+/// the first bytes of every trace
+#define EVENT_TRACE_MAGIC "MPXTRACE"
+#define EVENT_TRACE_VERSION 1
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    /// the major opcode of the XInput extension when the trace was recorded; needed to translate generic events
+    uint8_t xiOpcode;
+    uint8_t padding[3];
+} EventTraceHeader;
+
+/// A single entry of a trace
+typedef struct {
+    /// time (ns) since the trace was started
+    TimeStamp time;
+    /// the recorded event or NULL if this record marks the event loop going idle
+    xcb_generic_event_t* event;
+} TraceRecord;
+
+/**
+ * Starts appending every event passed to processXEvent to a new trace at path
+ * Any trace already being recorded is stopped first.
+ *
+ * @param path the file to write to; it is truncated if it exists
+ * @return true on success
+ */
+bool startRecordingEvents(const char* path);
+/**
+ * Flushes and closes the trace being recorded, if any
+ */
+void stopRecordingEvents(void);
+/**
+ * @return true if there is a trace being recorded
+ */
+bool isRecordingEvents(void);
+/**
+ * Appends event to the trace being recorded
+ * @param event
+ */
+void recordXEvent(const xcb_generic_event_t* event);
+/**
+ * Marks that the event loop went idle. The trace is flushed so it is complete up to this point
+ */
+void recordIdle(void);
+
+/**
+ * Opens a trace for reading
+ *
+ * @param path
+ * @param header set to the header of the trace
+ * @return the trace positioned at its first record or NULL if path is not a trace
+ */
+FILE* openEventTrace(const char* path, EventTraceHeader* header);
+/**
+ * Reads the next record of a trace
+ *
+ * @param fp a trace returned by openEventTrace
+ * @param record set to the next record; the caller is responsible for freeing record->event
+ * @return false at the end of the trace or if the trace is truncated
+ */
+bool readTraceRecord(FILE* fp, TraceRecord* record);
+#endif
@@ -9,6 +9,7 @@
 #include "monitors.h"
 #include "system.h"
 #include "util/logger.h"
+#include "util/string-table.h"
 #include "windows.h"
 #include "wmfunctions.h"
 #include "workspaces.h"
@@ -17,14 +18,27 @@
 #include "xutil/test-functions.h"
 #include "xutil/window-properties.h"
 
-static int getNextIndexInStack2(const ArrayList* stack, int delta, const WindowFunctionArg rule,
+static void swapStackEntries(WindowInfo** p1, WindowInfo** p2) {
+    WindowInfo* temp = *p1;
+    *p1 = *p2;
+    *p2 = temp;
+}
+/**
+ * @param windows an array of size elements
+ * @return the index of the first window matching rule that is delta away from the focused window, wrapping around,
+ * or -1
+ */
+static int getNextIndexInWindows(WindowInfo* const* windows, int size, int delta, const WindowFunctionArg rule,
     bool includeNonActivatable) {
-    int index = getFocusedWindow() ? getIndex(stack, getFocusedWindow(), sizeof(WindowID)) : -1;
+    int index = -1;
+    for(int i = 0; getFocusedWindow() && i < size && index == -1; i++)
+        if(windows[i] == getFocusedWindow())
+            index = i;
     if(index == -1)
         index = delta > 0 ? -1 : 0;
-    for(int i = 0; i < stack->size; i++) {
-        index = getNextIndex(stack, index, delta);
-        WindowInfo* winInfo = getElement(stack, index);
+    for(int i = 0; i < size; i++) {
+        index = (index + delta + size) % size;
+        WindowInfo* winInfo = windows[index];
         if((includeNonActivatable || isActivatable(winInfo)) && (!rule.func || rule.func(winInfo, rule.arg))) {
             return index;
         }
@@ -32,17 +46,17 @@ static int getNextIndexInStack2(const ArrayList* stack, int delta, const WindowF
     DEBUG("Could not find window");
     return -1;
 }
-static int getNextIndexInStack(const ArrayList* stack, int delta, bool(*filter)(WindowInfo*)) {
-    return getNextIndexInStack2(stack, delta, (WindowFunctionArg) {filter}, 0);
+static int getNextIndexInStack(const WindowStack* stack, int delta, bool(*filter)(WindowInfo*)) {
+    return getNextIndexInWindows(stack->data, stack->size, delta, (WindowFunctionArg) {filter}, 0);
 }
-static WindowInfo* getNextWindowInStack(const ArrayList* stack, int delta, const WindowFunctionArg rule,
+static WindowInfo* getNextWindowInList(const ArrayList* list, int delta, const WindowFunctionArg rule,
     bool includeNonActivatable) {
-    int index = getNextIndexInStack2(stack, delta, rule, includeNonActivatable);
-    return index != -1 ? getElement(stack, index) : NULL;
+    int index = getNextIndexInWindows((WindowInfo* const*)list->__arr, list->size, delta, rule, includeNonActivatable);
+    return index != -1 ? getElement(list, index) : NULL;
 }
 
 void cycleWindowsMatching(int delta, bool(*filter)(WindowInfo*)) {
-    WindowInfo* winInfo = getNextWindowInStack(getActiveMasterWindowStack(), delta, (WindowFunctionArg) {filter}, 0);
+    WindowInfo* winInfo = getNextWindowInList(getActiveMasterWindowStack(), delta, (WindowFunctionArg) {filter}, 0);
     if(winInfo)
         activateWindow(winInfo);
 }
@@ -72,9 +86,9 @@ static void applyAction(WindowInfo* winInfo, WindowAction action) {
 WindowInfo* findAndRaise(const WindowFunctionArg rule, WindowAction action, int dir, const FindAndRaiseArg arg) {
     WindowInfo* target = NULL;
     if(!arg.skipMasterStack)
-        target = getNextWindowInStack(getMasterWindowStack(getActiveMaster()), dir, rule, arg.includeNonActivatable);
+        target = getNextWindowInList(getMasterWindowStack(getActiveMaster()), dir, rule, arg.includeNonActivatable);
     if(!target) {
-        target = getNextWindowInStack(getAllWindows(), dir, rule, arg.includeNonActivatable);
+        target = getNextWindowInList(getAllWindows(), dir, rule, arg.includeNonActivatable);
         if(target)
             DEBUG("found window globally");
     }
@@ -88,13 +102,16 @@ WindowInfo* findAndRaise(const WindowFunctionArg rule, WindowAction action, int
     return target;
 }
 bool matchesClass(WindowInfo* winInfo, const char* str) {
-    return strcmp(winInfo->className, str) == 0 || strcmp(winInfo->instanceName, str) == 0;
+    // if str was never interned, no window can have it as a class
+    str = findInternedString(str);
+    return str && (getWindowProperties(winInfo)->className == str || getWindowProperties(winInfo)->instanceName == str);
 }
 bool matchesTitle(WindowInfo* winInfo, const char* str) {
-    return strcmp(winInfo->title, str) == 0;
+    return strcmp(getWindowProperties(winInfo)->title, str) == 0;
 }
 bool matchesRole(WindowInfo* winInfo, const char* str) {
-    return strcmp(winInfo->role, str) == 0;
+    str = findInternedString(str);
+    return str && getWindowProperties(winInfo)->role == str;
 }
 
 int raiseOrRunFunc(const char* s, const char* cmd, int dir, bool(*func)(WindowInfo*, const char*)) {
@@ -102,18 +119,38 @@ int raiseOrRunFunc(const char* s, const char* cmd, int dir, bool(*func)(WindowIn
         const char* c = getenv(s + 1);
         s = c ? c : "";
     }
-    WindowFunctionArg arg = {func, .arg.str = s};
-    if(!findAndRaise(arg, ACTION_ACTIVATE, dir, (FindAndRaiseArg) {0})) {
+    // intern once so matching each window is just a pointer comparison
+    WindowFunctionArg arg = {func, .arg.str = internString(s)};
+    WindowInfo* winInfo = findAndRaise(arg, ACTION_ACTIVATE, dir, (FindAndRaiseArg) {0});
+    releaseString(arg.arg.str);
+    if(!winInfo) {
         spawnSilent(cmd);
         return 1;
     }
     return 0;
 }
+/**
+ * @param mask a single mask bit
+ * @return false if no window can have mask; allows skipping a search of every window
+ */
+static bool mayHaveWindowWithMask(WindowMask mask) {
+    if(getNumberOfWindowsWithMask(mask))
+        return 1;
+    FOR_EACH(Workspace*, workspace, getAllWorkspaces()) {
+        if(workspace->mask & mask && getWorkspaceWindowStack(workspace)->size)
+            return 1;
+    }
+    return 0;
+}
 void activateNextUrgentWindow() {
+    if(!mayHaveWindowWithMask(URGENT_MASK))
+        return;
     WindowFunctionArg arg = {hasMask, {URGENT_MASK}};
     findAndRaise(arg, ACTION_ACTIVATE, DOWN, (FindAndRaiseArg) {0});
 }
 void popHiddenWindow() {
+    if(!mayHaveWindowWithMask(HIDDEN_MASK))
+        return;
     WindowFunctionArg arg = {hasMask, {HIDDEN_MASK}};
     WindowInfo* winInfo = findAndRaise(arg, ACTION_NONE, DOWN, (FindAndRaiseArg) {.includeNonActivatable = 1});
     if(winInfo) {
@@ -126,28 +163,31 @@ void popHiddenWindow() {
 }
 
 void shiftTopAndFocus() {
-    ArrayList* stack = getActiveWindowStack();
+    WindowStack* stack = getActiveWindowStack();
     if(stack->size) {
-        shiftToHead(stack, getNextIndexInStack(stack, getHead(stack) == getFocusedWindow(), NULL));
-        activateWindow(getHead(stack));
+        int index = getNextIndexInStack(stack, stack->data[0] == getFocusedWindow(), NULL);
+        if(index != -1)
+            WindowStackMove(stack, index, 0);
+        activateWindow(stack->data[0]);
         markActiveWorkspaceDirty();
     }
 }
 void swapPosition(int dir) {
-    ArrayList* stack = getActiveWindowStack();
+    WindowStack* stack = getActiveWindowStack();
     if(stack->size) {
         int index = getNextIndexInStack(stack, 0, NULL);
         if(index != -1) {
-            swapElements(stack, index, stack, getNextIndexInStack(stack, dir, NULL));
+            int otherIndex = getNextIndexInStack(stack, dir, NULL);
+            swapStackEntries(WindowStackGet(stack, index), WindowStackGet(stack, otherIndex));
             markActiveWorkspaceDirty();
         }
     }
 }
 void shiftFocus(int dir, bool(*filter)(WindowInfo*)) {
-    ArrayList* stack = getActiveWindowStack();
-    WindowInfo* winInfo = getNextWindowInStack(stack, dir, (WindowFunctionArg) {filter}, 0);
-    if(winInfo)
-        activateWindow(winInfo);
+    WindowStack* stack = getActiveWindowStack();
+    int index = getNextIndexInStack(stack, dir, filter);
+    if(index != -1)
+        activateWindow(stack->data[index]);
 }
 
 void sendWindowToWorkspaceByName(WindowInfo* winInfo, const char* name) {
@@ -271,12 +311,16 @@ void swapWindows(WindowID win, WindowID win2) {
         Workspace* w1 = getWorkspaceOfWindow(winInfo1);
         Workspace* w2 = getWorkspaceOfWindow(winInfo2);
         if(w1 && w2) {
-            swapElements(
-                getWorkspaceWindowStack(w1),
-                getIndex(getWorkspaceWindowStack(w1), winInfo1, sizeof(WindowID)),
-                getWorkspaceWindowStack(w2),
-                getIndex(getWorkspaceWindowStack(w2), winInfo2, sizeof(WindowID))
+            swapStackEntries(
+                WindowStackGet(getWorkspaceWindowStack(w1), WindowStackIndexOf(getWorkspaceWindowStack(w1), winInfo1)),
+                WindowStackGet(getWorkspaceWindowStack(w2), WindowStackIndexOf(getWorkspaceWindowStack(w2), winInfo2))
             );
+            winInfo1->workspaceIndex = w2->id;
+            winInfo2->workspaceIndex = w1->id;
+            updateWorkspaceMaskCounts(w1, winInfo1->mask, -1);
+            updateWorkspaceMaskCounts(w1, winInfo2->mask, 1);
+            updateWorkspaceMaskCounts(w2, winInfo2->mask, -1);
+            updateWorkspaceMaskCounts(w2, winInfo1->mask, 1);
         }
         Rect geo = getRealGeometry(winInfo2->id);
         setWindowPosition(winInfo2->id, getRealGeometry(winInfo1->id));
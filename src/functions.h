@@ -143,7 +143,7 @@ void sendWindowToWorkspaceByName(WindowInfo* winInfo, const char* name);
 void swapPosition(int dir);
 
 static inline bool matchesFocusedWindowClass(WindowInfo* winInfo) {
-    return matchesClass(winInfo, getFocusedWindow()->className);
+    return matchesClass(winInfo, getWindowProperties(getFocusedWindow())->className);
 }
 /**
  * Shifts the focus up or down the window& stack
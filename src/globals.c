@@ -1,14 +1,17 @@
 #include <xcb/xinput.h>
 
 #include "globals.h"
+#include "user-events.h"
 #include "window-masks.h"
 
 bool ALLOW_SETTING_UNSYNCED_MASKS = 0;
 bool ALLOW_UNSAFE_OPTIONS = 1;
 bool ASSUME_PRIMARY_MONITOR = 0;
 bool HIDE_WM_STATUS = 0;
+bool PROFILE_RULES = 0;
 bool RUN_AS_WM = 1;
 bool STEAL_WM_SELECTION = 0;
+bool X_READER_THREAD = 0;
 const char* MASTER_INFO_PATH = "$HOME/.config/mpxmanager/master-info.txt";
 const char* SHELL = "/bin/sh";
 int16_t DEFAULT_BORDER_WIDTH = 1;
@@ -23,6 +26,7 @@ uint32_t NON_ROOT_DEVICE_EVENT_MASKS = XCB_INPUT_XI_EVENT_MASK_FOCUS_OUT | XCB_I
 uint32_t NON_ROOT_EVENT_MASKS = XCB_EVENT_MASK_PROPERTY_CHANGE | XCB_EVENT_MASK_VISIBILITY_CHANGE;
 uint32_t IDLE_TIMEOUT = 20;
 uint32_t IDLE_TIMEOUT_CLI_SEC = 1;
+uint64_t COALESCE_EVENT_TYPES = 0;
 uint32_t ROOT_DEVICE_EVENT_MASKS = XCB_INPUT_XI_EVENT_MASK_HIERARCHY;
 uint32_t ROOT_EVENT_MASKS = XCB_EVENT_MASK_SUBSTRUCTURE_REDIRECT | XCB_EVENT_MASK_SUBSTRUCTURE_NOTIFY |
     XCB_EVENT_MASK_STRUCTURE_NOTIFY;
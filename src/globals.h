@@ -121,6 +121,23 @@ extern uint32_t NON_ROOT_EVENT_MASKS;
  */
 extern uint32_t IDLE_TIMEOUT;
 extern uint32_t IDLE_TIMEOUT_CLI_SEC;
+/**
+ * Bitmask of event types (1 << type) whose queued events may be dropped when superseded by a later event of the
+ * same type for the same window (and atom for PropertyNotify or device for XI events).
+ * Only ConfigureNotify, PropertyNotify and XI Motion support coalescing.
+ * Defaults to 0 since dropped events are never seen by event rules
+ */
+extern uint64_t COALESCE_EVENT_TYPES;
+/**
+ * If true, runEventLoop reads X events on a separate thread so the X connection is drained even while a slow rule
+ * is running. Rules are still only run on the main thread
+ */
+extern bool X_READER_THREAD;
+/**
+ * If true, the time spent running each rule and waiting on X replies is recorded and shown by dump-rules.
+ * Has no effect when built with NO_RULE_PROFILER
+ */
+extern bool PROFILE_RULES;
 /**Mask of all events we listen for on relating to Master devices
  * and the root window.
  */
@@ -10,6 +10,7 @@
 #include "monitors.h"
 #include "user-events.h"
 #include "util/logger.h"
+#include "util/timeline.h"
 #include "windows.h"
 #include "wmfunctions.h"
 #include "workspaces.h"
@@ -202,7 +203,7 @@ static void applyTilingOverrideToConfig(const WindowInfo* winInfo, const Monitor
         config[CONFIG_INDEX_BORDER] = getTilingOverrideBorder(winInfo);
 }
 
-void tileWindow(const LayoutState* state, const WindowInfo* winInfo, const short* values) {
+void tileWindow(const LayoutState* state, WindowInfo* winInfo, const short* values) {
     assert(winInfo);
     int mask = XCB_CONFIG_WINDOW_X | XCB_CONFIG_WINDOW_Y |
         XCB_CONFIG_WINDOW_WIDTH | XCB_CONFIG_WINDOW_HEIGHT |
@@ -224,10 +225,10 @@ void tileWindow(const LayoutState* state, const WindowInfo* winInfo, const short
     config[CONFIG_INDEX_WIDTH] = MAX(1, (short)config[CONFIG_INDEX_WIDTH]);
     config[CONFIG_INDEX_HEIGHT] = MAX(1, (short)config[CONFIG_INDEX_HEIGHT]);
     assert(winInfo->id);
-    configureWindow(winInfo->id, mask, config);
+    configureWindowInfo(winInfo, mask, config);
 }
 
-void arrangeNonTileableWindow(const WindowInfo* winInfo, const Monitor* monitor) {
+void arrangeNonTileableWindow(WindowInfo* winInfo, const Monitor* monitor) {
     uint32_t config[CONFIG_LEN] = {0};
     config[CONFIG_INDEX_BORDER] = DEFAULT_BORDER_WIDTH;
     if (winInfo->dock || !getWorkspaceOfWindow(winInfo))
@@ -245,14 +246,14 @@ void arrangeNonTileableWindow(const WindowInfo* winInfo, const Monitor* monitor)
             if (mask & (1 << i))
                 finalConfig[counter++] = config[i];
         }
-        configureWindow(winInfo->id, mask, finalConfig);
+        configureWindowInfo(winInfo, mask, finalConfig);
     }
 }
 
-static void applyAboveBelowMask(ArrayList* list) {
+static void applyAboveBelowMask(const WindowStack* stack) {
     WindowID currentAbove = 0;
     WindowID currentBelow = 0;
-    FOR_EACH(WindowInfo*, winInfo, list) {
+    FOR_EACH_VALUE(WindowInfo*, winInfo, stack) {
         if (hasMask(winInfo, BELOW_MASK)) {
             lowerWindow(winInfo->id, currentBelow);
             currentBelow = winInfo->id;
@@ -277,7 +278,7 @@ bool isWorkspaceDirty(Workspace* workspace) {
         return 1;
     if (isWorkspaceVisible(workspace) && memcmp(&getMonitor(workspace)->view, &workspace->lastBounds, sizeof(Rect)) != 0)
         return 1;
-    FOR_EACH(WindowInfo*, winInfo, getWorkspaceWindowStack(workspace)) {
+    FOR_EACH_VALUE(WindowInfo*, winInfo, getWorkspaceWindowStack(workspace)) {
         if ((winInfo->mask ^ winInfo->savedMask) & RETILE_MASKS)
             return 1;
     }
@@ -294,11 +295,12 @@ void retileAllDirtyWorkspaces() {
 void tileWorkspace(Workspace* workspace) {
     assert(workspace);
     DEBUG("Tiling workspace %d", workspace->id);
-    ArrayList* windowStack = getWorkspaceWindowStack(workspace);
+    WindowStack* windowStack = getWorkspaceWindowStack(workspace);
     if (!isWorkspaceVisible(workspace) || !windowStack->size) {
         TRACE("Cannot tile workspace; Visibile %d; Size %d", !isWorkspaceVisible(workspace), windowStack->size);
         return;
     }
+    TimeStamp spanStart = TIMELINE_SPAN_START();
     Monitor* m = getMonitor(workspace);
     Layout* layout = getLayout(workspace);
     workspace->dirty = 0;
@@ -306,7 +308,7 @@ void tileWorkspace(Workspace* workspace) {
     workspace->lastBounds = m->view;
     if (layout) {
         int maxWindowToTile = 0;
-        FOR_EACH(WindowInfo*, winInfo, windowStack) {
+        FOR_EACH_VALUE(WindowInfo*, winInfo, windowStack) {
             if (isTileable(winInfo))
                 maxWindowToTile++;
         }
@@ -326,12 +328,13 @@ void tileWorkspace(Workspace* workspace) {
     }
     else if (!layout)
         TRACE("workspace %d does not have a layout; skipping ", workspace->id);
-    FOR_EACH(WindowInfo*, winInfo, windowStack) {
+    FOR_EACH_VALUE(WindowInfo*, winInfo, windowStack) {
         if (!isTileable(winInfo))
             arrangeNonTileableWindow(winInfo, m);
     }
     applyAboveBelowMask(windowStack);
     applyEventRules(TILE_WORKSPACE, workspace);
+    TIMELINE_SPAN_END(spanStart, "tileWorkspace", "layout");
 }
 
 static uint32_t splitEven(LayoutState* state, int offset, short const* baseValues, int dim, int num, int last) {
@@ -344,7 +347,7 @@ static uint32_t splitEven(LayoutState* state, int offset, short const* baseValue
     uint32_t i = offset;
     int count = 0;
     while (i < state->stack->size) {
-        WindowInfo* winInfo = getElement(state->stack, i++);
+        WindowInfo* winInfo = state->stack->data[i++];
         if (!isTileable(winInfo))continue;
         count++;
         values[dim] = sizePerWindow + (rem-- > 0 ? 1 : 0);
@@ -355,7 +358,7 @@ static uint32_t splitEven(LayoutState* state, int offset, short const* baseValue
     if (last) {
         LayoutState copy = *state;
         for (; i < state->stack->size; i++) {
-            WindowInfo* winInfo = getElement(state->stack, i);
+            WindowInfo* winInfo = state->stack->data[i];
             if (isTileable(winInfo))
                 tileWindow(&copy, winInfo, values);
         }
@@ -367,7 +370,7 @@ void full(LayoutState* state) {
     short int values[CONFIG_LEN];
     memcpy(&values, &state->monitor->view.x, sizeof(short int) * 4);
     for (int i = state->stack->size - 1; i >= 0; i--) {
-        WindowInfo* winInfo = getElement(state->stack, i);
+        WindowInfo* winInfo = state->stack->data[i];
         if (isTileable(winInfo))
             tileWindow(state, winInfo, values);
     }
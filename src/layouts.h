@@ -85,7 +85,7 @@ typedef struct LayoutState {
     /// number of windows that should be tiled
     const int numWindows;
     /// the stack of windows
-    const ArrayList* stack;
+    const WindowStack* stack;
 } LayoutState ;
 
 ///holds meta data to to determine what tiling function to call and when/how to call it
@@ -190,7 +190,7 @@ void transformConfig(const LayoutArgs* args, const Monitor* m, uint32_t* config)
  * @param winInfo the window to tile
  * @param values where the layout wants to position the window
  */
-void tileWindow(const LayoutState* state, const WindowInfo* winInfo, const short* values);
+void tileWindow(const LayoutState* state, WindowInfo* winInfo, const short* values);
 
 /**
  * "Tiles" untileable windows
@@ -199,7 +199,7 @@ void tileWindow(const LayoutState* state, const WindowInfo* winInfo, const short
  * @param winInfo
  * @param monitor
  */
-void arrangeNonTileableWindow(const WindowInfo* winInfo, const Monitor* monitor) ;
+void arrangeNonTileableWindow(WindowInfo* winInfo, const Monitor* monitor) ;
 /**
  * Tiles the specified workspace.
  * First the windows in the tileable windows are tiled according to the active layout's layoutFunction
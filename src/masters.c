@@ -6,7 +6,9 @@
 #include "masters.h"
 #include "mywm-structs.h"
 #include "util/logger.h"
+#include "util/slab.h"
 #include "util/time.h"
+#include "windows.h"
 
 ///the active master
 static Master* master = NULL;
@@ -29,8 +31,10 @@ uint32_t __attribute__((weak)) generateMasterColor(MasterID pointerID) {
     return 0xF<<(pointerID/4);
 }
 
+/// allocator for Masters
+static Slab masterSlab = SLAB(Master);
 Master* newMaster(MasterID keyboardID, MasterID pointerID, const char* name, int nameLen) {
-    Master* master = (Master*)malloc(sizeof(Master));
+    Master* master = slabAlloc(&masterSlab);
     Master temp = {.id = keyboardID , .pointerID = pointerID, .focusColor =
         pointerID == DEFAULT_POINTER? DEFAULT_BORDER_COLOR: generateMasterColor(pointerID)};
     memmove(master, &temp, sizeof(Master));
@@ -47,7 +51,7 @@ void freeMaster(Master* master) {
     removeElement(&masterList, master, sizeof(MasterID));
     if(master->windowMoveResizer)
         free(master->windowMoveResizer);
-    free(master);
+    slabFree(&masterSlab, master);
 }
 
 void addDefaultMaster() {
@@ -56,24 +60,73 @@ void addDefaultMaster() {
     if(getActiveMaster() == NULL)
         setActiveMaster(m);
 }
+/// allocator for FocusNodes
+static Slab focusNodeSlab = SLAB(FocusNode);
+
+static FocusNode* getFocusNode(const Master* master, const WindowInfo* winInfo) {
+    for(FocusNode* node = winInfo->focusNodes; node; node = node->nextForWindow)
+        if(node->master == master)
+            return node;
+    return NULL;
+}
+/// removes node from the focus stack of its master without freeing it
+static void unlinkFocusNode(FocusNode* node) {
+    Master* master = node->master;
+    if(node->prev)
+        node->prev->next = node->next;
+    else
+        master->focusStackHead = node->next;
+    if(node->next)
+        node->next->prev = node->prev;
+    master->focusStackSize--;
+    master->windowStackDirty = 1;
+}
+/// inserts node into the focus stack of its master before next or at the head if next is NULL
+static void linkFocusNode(FocusNode* node, FocusNode* next) {
+    Master* master = node->master;
+    if(next) {
+        node->prev = next->prev;
+        next->prev = node;
+    }
+    else
+        node->prev = NULL;
+    node->next = next ? next : master->focusStackHead;
+    if(!next && master->focusStackHead)
+        master->focusStackHead->prev = node;
+    if(node->prev)
+        node->prev->next = node;
+    else
+        master->focusStackHead = node;
+    master->focusStackSize++;
+    master->windowStackDirty = 1;
+}
+static void freeFocusNode(FocusNode* node) {
+    FocusNode** p = &node->winInfo->focusNodes;
+    while(*p != node)
+        p = &(*p)->nextForWindow;
+    *p = node->nextForWindow;
+    unlinkFocusNode(node);
+    slabFree(&focusNodeSlab, node);
+}
+
 void onWindowFocusForMaster(WindowID win, Master* master) {
     WindowInfo* winInfo = getWindowInfo(win);
     if(!winInfo)
         return;
-    int pos = getIndex(&master->windowStack, &win, sizeof(WindowID));
-    DEBUG("updating focus for win %d at position %d", win, pos);
-    if(! isFocusStackFrozen()) {
-        if(pos == -1) {
-            pos = master->windowStack.size;
-            addElement(&master->windowStack, winInfo);
-        }
-        shiftToHead(&master->windowStack, pos);
+    FocusNode* node = getFocusNode(master, winInfo);
+    DEBUG("updating focus for win %d; in focus stack %d", win, node != NULL);
+    if(!node) {
+        node = slabAlloc(&focusNodeSlab);
+        *node = (FocusNode) {.winInfo = winInfo, .master = master, .nextForWindow = winInfo->focusNodes};
+        winInfo->focusNodes = node;
+        // when frozen, new windows are inserted at the position of the focused window
+        linkFocusNode(node, isFocusStackFrozen() ? master->focusedNode : NULL);
     }
-    else if(pos != -1)
-        master->focusedWindowIndex = pos;
-    else {
-        addElementAt(&master->windowStack, winInfo, master->focusedWindowIndex);
+    else if(!isFocusStackFrozen() && node->prev) {
+        unlinkFocusNode(node);
+        linkFocusNode(node, NULL);
     }
+    master->focusedNode = node;
     master->focusedTimeStamp = getTime();
 }
 void onWindowFocus(WindowID win) {
@@ -81,21 +134,40 @@ void onWindowFocus(WindowID win) {
     onWindowFocusForMaster(win, master);
 }
 void clearFocusStack(Master* master) {
+    while(master->focusStackHead)
+        freeFocusNode(master->focusStackHead);
+    master->focusedNode = NULL;
     clearArray(&master->windowStack);
 }
+static void removeFocusNode(FocusNode* node) {
+    Master* master = node->master;
+    if(master->focusedNode == node)
+        master->focusedNode = node->prev ? node->prev : node->next;
+    freeFocusNode(node);
+}
 WindowInfo* removeWindowFromFocusStack(Master* master, WindowID win) {
-    int index  = getIndex(&master->windowStack, &win, sizeof(WindowID));
-    if(index == -1)
+    WindowInfo* winInfo = getWindowInfo(win);
+    FocusNode* node = winInfo ? getFocusNode(master, winInfo) : NULL;
+    if(!node)
         return NULL;
-    if(master->focusedWindowIndex) {
-        master->focusedWindowIndex -= master->focusedWindowIndex >= index;
+    removeFocusNode(node);
+    return winInfo;
+}
+void removeWindowFromAllFocusStacks(WindowInfo* winInfo) {
+    while(winInfo->focusNodes)
+        removeFocusNode(winInfo->focusNodes);
+}
+const ArrayList* getMasterWindowStack(Master* master) {
+    if(master->windowStackDirty) {
+        master->windowStack.size = 0;
+        for(FocusNode* node = master->focusStackHead; node; node = node->next)
+            addElement(&master->windowStack, node->winInfo);
+        master->windowStackDirty = 0;
     }
-    return removeIndex(&master->windowStack, index);
+    return &master->windowStack;
 }
 WindowInfo* getFocusedWindowOfMaster(Master* master) {
-    if(master->windowStack.size == 0)
-        return NULL;
-    return getElement(&master->windowStack, master->focusedWindowIndex);
+    return master->focusedNode ? master->focusedNode->winInfo : NULL;
 }
 WindowInfo* getFocusedWindow() {
     return getFocusedWindowOfMaster(getActiveMaster());
@@ -105,9 +177,9 @@ void setFocusStackFrozen(int value) {
     Master* master =  getActiveMaster();
     if(master->freezeFocusStack != value) {
         master->freezeFocusStack = value;
-        if(master->focusedWindowIndex < master->windowStack.size) {
-            shiftToHead(&master->windowStack, master->focusedWindowIndex);
-            master->focusedWindowIndex = 0;
+        if(master->focusedNode && master->focusedNode->prev) {
+            unlinkFocusNode(master->focusedNode);
+            linkFocusNode(master->focusedNode, NULL);
         }
     }
 }
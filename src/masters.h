@@ -48,6 +48,21 @@ Master* getActiveMaster(void);
  */
 void setActiveMaster(Master* master);
 
+/**
+ * Entry in the focus stack of a Master.
+ * There is one node for every (Master, window) pair where the master has focused the window
+ */
+struct FocusNode {
+    WindowInfo* winInfo;
+    Master* master;
+    /// the node that was focused more recently by master
+    FocusNode* prev;
+    /// the node that was focused less recently by master
+    FocusNode* next;
+    /// the node of another master for the same window
+    FocusNode* nextForWindow;
+};
+
 struct Binding;
 /// holds data on a master device pair like the ids and focus history
 typedef struct Master {
@@ -62,14 +77,18 @@ typedef struct Master {
     /**Stack of windows in order of most recently focused*/
     ArrayList slaves;
 
-    /**Stack of windows in order of most recently focused*/
-    ArrayList windowStack;
+    /// most recently focused node of the focus stack
+    FocusNode* focusStackHead;
+    /// number of nodes in the focus stack
+    uint32_t focusStackSize;
     /**
      * Contains the window with current focus,
-     * will be same as top of window stack if freezeFocusStack==0
-     *
+     * will be same as head of the focus stack if freezeFocusStack==0
      */
-    uint32_t focusedWindowIndex;
+    FocusNode* focusedNode;
+    /// cached array of the focus stack; rebuilt by getMasterWindowStack when windowStackDirty is set
+    ArrayList windowStack;
+    bool windowStackDirty;
 
     /**Time the focused window changed*/
     TimeStamp focusedTimeStamp;
@@ -92,9 +111,11 @@ static inline const ArrayList* getSlaves(Master* master) {
     return &master->slaves;
 }
 
-static inline const ArrayList* getMasterWindowStack(Master* master) {
-    return &master->windowStack;
-}
+/**
+ * @param master
+ * @return the windows master has focused in order of most recently focused
+ */
+const ArrayList* getMasterWindowStack(Master* master);
 static inline const ArrayList* getActiveMasterWindowStack() { return getMasterWindowStack(getActiveMaster());}
 
 /**
@@ -188,6 +209,12 @@ void clearFocusStack(Master* master);
  * @return the window removed or NULL
  */
 WindowInfo* removeWindowFromFocusStack(Master* master, WindowID win);
+/**
+ * Removes winInfo from the focus stack of every master
+ *
+ * @param winInfo
+ */
+void removeWindowFromAllFocusStacks(WindowInfo* winInfo);
 
 /**
  * Get the WindowInfo representing the window the master is
@@ -5,6 +5,7 @@
 #include "globals.h"
 #include "monitors.h"
 #include "util/logger.h"
+#include "util/slab.h"
 #include "util/rect.h"
 #include "windows.h"
 #include "workspaces.h"
@@ -27,8 +28,10 @@ Monitor* getMonitorByID(MonitorID id) {
 uint32_t MONITOR_DUPLICATION_POLICY = SAME_DIMS | CONSIDER_ONLY_NONFAKES;
 uint32_t MONITOR_DUPLICATION_RESOLUTION = TAKE_PRIMARY | TAKE_LARGER;
 
+/// allocator for Monitors
+static Slab monitorSlab = SLAB(Monitor);
 Monitor* newMonitor(MonitorID id, Rect base, const char* name, bool fake) {
-    Monitor* monitor = (Monitor*)malloc(sizeof(Monitor));
+    Monitor* monitor = slabAlloc(&monitorSlab);
     Monitor temp = {.id = id, .base = base, .view = base, .fake = fake};
     memmove(monitor, &temp, sizeof(Monitor));
     strncpy(monitor->name, name, MAX_NAME_LEN - 1);
@@ -47,7 +50,7 @@ void freeMonitor(Monitor* monitor) {
     if(getWorkspaceOfMonitor(monitor))
         setMonitor(getWorkspaceOfMonitor(monitor), NULL);
     removeElement(&monitors, monitor, sizeof(MonitorID));
-    free(monitor);
+    slabFree(&monitorSlab, monitor);
 }
 
 
@@ -111,8 +114,8 @@ bool resizeToAvoidDock(Monitor* monitor, WindowInfo* winInfo) {
 void resizeAllMonitorsToAvoidAllDocks(void) {
     FOR_EACH(Monitor*, monitor, getAllMonitors()) {
         monitor->view = monitor->base;
-        FOR_EACH(WindowInfo*, winInfo, getAllWindows()) {
-            if(winInfo->dock && hasMask(winInfo, MAPPED_MASK))
+        FOR_EACH_WINDOW_WITH_MASK(winInfo, MAPPED_MASK) {
+            if(winInfo->dock)
                 resizeToAvoidDock(monitor, winInfo);
         }
     }
@@ -6,9 +6,13 @@
 #include <unistd.h>
 
 #include "communications.h"
+#include "event-record.h"
 #include "globals.h"
 #include "settings.h"
 #include "system.h"
+#include "timers.h"
+#include "util/flight-recorder.h"
+#include "util/timeline.h"
 #include "util/logger.h"
 #include "wm-rules.h"
 #include "wmfunctions.h"
@@ -42,6 +46,18 @@ static void dumpOptions() {
 static void setWindow(WindowID win) { active = win;}
 static void noEventLoop() {RUN_EVENT_LOOP = 0;}
 static void replaceWM() {STEAL_WM_SELECTION = 1;}
+static void useXReaderThread() {X_READER_THREAD = 1;}
+/// file to record events to once X has been initialized
+static const char* recordPath;
+static void recordEvents(const char* path) {recordPath = path;}
+static void writeTimeline(const char* path) {
+    if(!startTimeline(path))
+        exit(SYS_CALL_FAILED);
+}
+static void flushFlightRecorderTo(const char* path) {
+    if(!startFlushingFlightRecorder(path))
+        exit(SYS_CALL_FAILED);
+}
 
 static void version() {
     printf("1.3.0\n");
@@ -57,6 +73,11 @@ static Option options[] = {
     {"no-event-loop", {noEventLoop}},
     {"no-run-as-window-manager", {clearWMSettings}},
     {"replace", {replaceWM}},
+    {"x-reader-thread", {useXReaderThread}},
+    {"record", {recordEvents}, .flags = REQUEST_STR},
+    {"flight-recorder", {flushFlightRecorderTo}, .flags = REQUEST_STR},
+    {"flight-recorder-level", {setFlightRecorderLevel}, .flags = REQUEST_INT},
+    {"trace", {writeTimeline}, .flags = REQUEST_STR},
     {"die-on-idle", {addShutdownOnIdleRule}},
     {"as", {setWindow}, .flags = REQUEST_INT},
 };
@@ -79,8 +100,8 @@ static inline bool callStartupOption(const char* const* argv, int* n) {
         Option* option = &options[i];
         bool increment = 0;
         if(strcmp(argv[*n] + 2, option->name) == 0) {
-            if(option->flags & REQUEST_INT) {
-                value = argv[*n + 1];
+            if(option->flags & (REQUEST_INT | REQUEST_STR)) {
+                value = argv[*n + 1] ? argv[*n + 1] : "";
                 increment = 1;
             }
             else
@@ -136,7 +157,6 @@ void shutdownWhenNoOutstandingMessages() {
 }
 
 void timeoutWaitingForRequests() {
-    alarm(IDLE_TIMEOUT_CLI_SEC);
     if(hasOutStandingMessages()) {
         err(WM_NOT_RESPONDING, "WM did not confirm request(s)");
     }
@@ -154,6 +174,8 @@ int _main(int argc, const char* const* argv) {
         parseArgs(argc, argv);
     if(!hasXConnectionBeenOpened())
         onStartup();
+    if(recordPath && !startRecordingEvents(recordPath))
+        exit(SYS_CALL_FAILED);
     if(RUN_EVENT_LOOP)
         runEventLoop();
     else if(getNumberOfMessageSent()) {
@@ -161,8 +183,7 @@ int _main(int argc, const char* const* argv) {
             TRACE("waiting for send receipts");
             registerForWindowEvents(getPrivateWindow(), XCB_EVENT_MASK_PROPERTY_CHANGE);
             addEvent(XCB_PROPERTY_NOTIFY, DEFAULT_EVENT(shutdownWhenNoOutstandingMessages));
-            alarm(IDLE_TIMEOUT_CLI_SEC);
-            createSigAction(SIGALRM, timeoutWaitingForRequests);
+            addPeriodicTimer(IDLE_TIMEOUT_CLI_SEC * 1000, IDLE_TIMEOUT_CLI_SEC * 1000, timeoutWaitingForRequests, NULL);
             runEventLoop();
             DEBUG("WM Running: %d; Outstanding messages: %d", isMPXManagerRunning(), hasOutStandingMessages());
         }
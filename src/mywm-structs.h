@@ -32,6 +32,7 @@ typedef uint32_t WindowMask;
 typedef struct Monitor Monitor;
 typedef struct Layout Layout;
 typedef struct Master Master;
+typedef struct FocusNode FocusNode;
 typedef struct Slave Slave;
 typedef struct WindowInfo WindowInfo;
 typedef struct Workspace Workspace;
@@ -75,9 +76,7 @@ const ArrayList* getAllWindows();
  * @param win
  * @return pointer to struct with info on the given window
  */
-static inline WindowInfo* getWindowInfo(WindowID win) {
-    return findElement(getAllWindows(), &win, sizeof(WindowID));
-}
+WindowInfo* getWindowInfo(WindowID win);
 
 __DECLARE_GET_X_BY_NAME(Master);
 __DECLARE_GET_X_BY_NAME(Monitor);
@@ -0,0 +1,110 @@
+/**
+ * @file replay-trace.c
+ * @brief Replays traces recorded with --record through the event rules
+ *
+ * Usage: replay-trace [--realtime] [--profile] TRACE...
+ *
+ * The normal settings are loaded and the rules are run against the X server in $DISPLAY (normally a private Xvfb
+ * instance; see run_in_x_container.sh). Events are replayed as fast as possible unless --realtime is given in which
+ * case the original spacing between events is kept. The total time and the cost of each event type is printed at
+ * the end.
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <xcb/xinput.h>
+
+#include "boundfunction.h"
+#include "event-record.h"
+#include "globals.h"
+#include "settings.h"
+#include "system.h"
+#include "util/debug.h"
+#include "util/logger.h"
+#include "util/time.h"
+#include "xevent.h"
+#include "xutil/xsession.h"
+
+/// if true the time between events in the trace is preserved
+static bool realTime;
+
+/// Discards the events generated by the replayed rules; only the recorded events are of interest
+static void discardXEvents(void) {
+    xcb_generic_event_t* event;
+    while((event = xcb_poll_for_event(dis)))
+        free(event);
+}
+static void sleepUntil(TimeStamp time) {
+    TimeStamp now = getTimeNs();
+    if(now < time)
+        usleep((time - now) / 1000);
+}
+
+/**
+ * Feeds every record of the trace at path through processXEvent
+ * @return 0 on success
+ */
+static int replayTrace(const char* path) {
+    EventTraceHeader header;
+    FILE* fp = openEventTrace(path, &header);
+    if(!fp)
+        return 1;
+    uint8_t xiOpcode = xcb_get_extension_data(dis, &xcb_input_id)->major_opcode;
+    uint32_t numberOfEvents = 0, numberOfIdles = 0;
+    TraceRecord record;
+    TimeStamp start = getTimeNs();
+    while(readTraceRecord(fp, &record)) {
+        if(realTime)
+            sleepUntil(start + record.time);
+        if(record.event) {
+            xcb_ge_generic_event_t* event = (xcb_ge_generic_event_t*)record.event;
+            // the XInput opcode is assigned by the server so it may differ from the one the trace was recorded with
+            if((event->response_type & 127) == XCB_GE_GENERIC && event->extension == header.xiOpcode)
+                event->extension = xiOpcode;
+            processXEvent(record.event);
+            numberOfEvents++;
+        }
+        else {
+            applyEventRules(IDLE, NULL);
+            flush();
+            discardXEvents();
+            numberOfIdles++;
+        }
+    }
+    flush();
+    TimeStamp total = getTimeNs() - start;
+    fclose(fp);
+    printf("%s: replayed %d events and %d idle points in %.3f ms (%.3f us/event)\n", path, numberOfEvents,
+        numberOfIdles, total / 1e6, numberOfEvents ? total / 1e3 / numberOfEvents : 0);
+    return 0;
+}
+
+int main(int argc, const char* const argv[]) {
+    setLogLevel(LOG_LEVEL_WARN);
+    int i = 1;
+    for(; i < argc && argv[i][0] == '-'; i++) {
+        if(strcmp(argv[i], "--realtime") == 0)
+            realTime = 1;
+        else if(strcmp(argv[i], "--profile") == 0)
+            PROFILE_RULES = 1;
+        else
+            break;
+    }
+    if(i == argc || argv[i][0] == '-') {
+        fprintf(stderr, "Usage: %s [--realtime] [--profile] TRACE...\n", argv[0]);
+        return INVALID_OPTION;
+    }
+    startupMethod = loadSettings;
+    onStartup();
+    discardXEvents();
+    int status = 0;
+    for(; i < argc; i++)
+        status |= replayTrace(argv[i]);
+    printf("\n");
+    dumpLatency();
+    if(PROFILE_RULES) {
+        printf("\n");
+        dumpRules();
+    }
+    return status;
+}
@@ -1,4 +1,5 @@
 #include "slaves.h"
+#include "util/slab.h"
 #include <stdlib.h>
 #include <string.h>
 
@@ -9,8 +10,10 @@ const ArrayList* getAllSlaves(void) {
 __DEFINE_GET_X_BY_NAME(Slave)
 
 void setMasterForSlave(Slave* slave, MasterID master);
+/// allocator for Slaves
+static Slab slaveSlab = SLAB(Slave);
 Slave* newSlave(const MasterID id, MasterID attachment, bool keyboard, const char* name, int nameLen) {
-    Slave* slave = malloc(sizeof(Slave));
+    Slave* slave = slabAlloc(&slaveSlab);
     Slave temp = {.id = id, .keyboard = keyboard};
     memmove(slave, &temp, sizeof(Slave));
     strncpy(slave->name, name, MIN(nameLen, MAX_NAME_LEN - 1));
@@ -21,7 +24,7 @@ Slave* newSlave(const MasterID id, MasterID attachment, bool keyboard, const cha
 void freeSlave(Slave* slave) {
     setMasterForSlave(slave, 0);
     removeElement(&slaveList, slave, sizeof(SlaveID));
-    free(slave);
+    slabFree(&slaveSlab, slave);
 }
 Slave* getSlaveByID(SlaveID id) {
     FOR_EACH(Slave*, slave, getAllSlaves()) {
@@ -14,6 +14,8 @@
 #include "system.h"
 #include "util/arraylist.h"
 #include "util/debug.h"
+#include "util/flight-recorder.h"
+#include "util/timeline.h"
 #include "util/logger.h"
 #include "windows.h"
 #include "workspaces.h"
@@ -128,14 +130,19 @@ void restart() {
 }
 void quit(int exitCode) {
     DEBUG("Exiting");
+    stopFlushingFlightRecorder();
+    stopTimeline();
     exit(exitCode);
 }
 
 static void handler(int sig) {
     ERROR("Error: signal %d:", sig);
     printSummary();
-    if(sig == SIGSEGV || sig == SIGABRT)
+    if(sig == SIGSEGV || sig == SIGABRT) {
+        int fd = getFlightRecorderFD();
+        dumpFlightRecorder(fd == -1 ? STDERR_FILENO : fd);
         exit(sig);
+    }
     quit(sig);
 }
 
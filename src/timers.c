@@ -0,0 +1,247 @@
+#include <assert.h>
+#include <poll.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include "timers.h"
+#include "util/logger.h"
+#include "util/slab.h"
+#include "util/time.h"
+#include "xevent.h"
+
+/// log2 of the number of slots per level
+#define WHEEL_BITS 6
+#define WHEEL_SIZE (1 << WHEEL_BITS)
+#define WHEEL_MASK (WHEEL_SIZE - 1)
+/// Level i holds timers expiring in less than WHEEL_SIZE^(i+1) ms; timers further out are re-cascaded
+#define NUMBER_OF_LEVELS 4
+
+struct Timer {
+    /// the time (ms) the timer should run
+    TimeStamp expires;
+    /// time between runs or 0 for one shot timers
+    uint32_t period;
+    void(*callBack)();
+    void* arg;
+    Timer* next;
+    /// the next pointer of the previous timer or the slot this timer is at the head of
+    Timer** pprev;
+};
+
+/// timers in each slot of each level
+static Timer* wheel[NUMBER_OF_LEVELS][WHEEL_SIZE];
+/// bitmap of non-empty slots for each level
+static uint64_t occupiedSlots[NUMBER_OF_LEVELS];
+/// the next tick (ms) to process; every tick before it has been processed
+static TimeStamp currentTick;
+static uint32_t numberOfTimers;
+static Slab timerSlab = SLAB(Timer);
+/// the timer whose callback is being called
+static Timer* runningTimer;
+/// set when runningTimer is cancelled by its own callback
+static bool runningTimerCancelled;
+
+static int timerFD = -1;
+/// the event loop callback for timerFD; only registered while there are timers so it never keeps the loop alive
+static FDHandler* timerFDHandler;
+/// the time timerFD is set to expire or 0 if not armed
+static TimeStamp armedTick;
+
+static void linkTimer(Timer* timer, Timer** head) {
+    timer->next = *head;
+    if(timer->next)
+        timer->next->pprev = &timer->next;
+    timer->pprev = head;
+    *head = timer;
+}
+static void unlinkTimer(Timer* timer) {
+    *timer->pprev = timer->next;
+    if(timer->next)
+        timer->next->pprev = timer->pprev;
+}
+/**
+ * Removes all timers from the given slot
+ * @param list set to the head of the list of removed timers; the oldest timer is first
+ */
+static void detachSlot(int level, int slot, Timer** list) {
+    Timer* timer = wheel[level][slot];
+    wheel[level][slot] = NULL;
+    occupiedSlots[level] &= ~(1ULL << slot);
+    // timers are added to the head of a slot so reversing the list restores the order they were added in
+    for(*list = NULL; timer;) {
+        Timer* next = timer->next;
+        linkTimer(timer, list);
+        timer = next;
+    }
+}
+
+/// adds timer to the level and slot matching its expiration relative to currentTick
+static void placeTimer(Timer* timer) {
+    TimeStamp expires = timer->expires < currentTick ? currentTick : timer->expires;
+    TimeStamp delta = expires - currentTick;
+    int level = 0;
+    while(level < NUMBER_OF_LEVELS - 1 && delta >> (level + 1) * WHEEL_BITS)
+        level++;
+    // timers past the end of the wheel are parked in the last slot and re-placed when it is cascaded
+    if(delta >> NUMBER_OF_LEVELS * WHEEL_BITS)
+        expires = currentTick + (1UL << NUMBER_OF_LEVELS * WHEEL_BITS) - 1;
+    int slot = expires >> level * WHEEL_BITS & WHEEL_MASK;
+    Timer** head = &wheel[level][slot];
+    if(!*head)
+        occupiedSlots[level] |= 1ULL << slot;
+    linkTimer(timer, head);
+}
+static void removeTimer(Timer* timer) {
+    unlinkTimer(timer);
+    // clear the occupied bit if the timer was the last one in its slot
+    for(int level = 0; level < NUMBER_OF_LEVELS; level++)
+        if(timer->pprev >= &wheel[level][0] && timer->pprev < &wheel[level][WHEEL_SIZE] && !*timer->pprev)
+            occupiedSlots[level] &= ~(1ULL << (timer->pprev - &wheel[level][0]));
+}
+
+/**
+ * Moves the timers in the current slot of level into lower levels.
+ * Called when the level below wraps around
+ */
+static void cascade(int level) {
+    int slot = currentTick >> level * WHEEL_BITS & WHEEL_MASK;
+    Timer* list;
+    detachSlot(level, slot, &list);
+    while(list) {
+        Timer* timer = list;
+        list = timer->next;
+        placeTimer(timer);
+    }
+    if(!slot && level + 1 < NUMBER_OF_LEVELS)
+        cascade(level + 1);
+}
+
+/**
+ * @return a time at or before the next time a timer has to run or be cascaded or 0 if there are no timers
+ */
+static TimeStamp getNextTimerTick(void) {
+    if(!numberOfTimers)
+        return 0;
+    TimeStamp next = 0;
+    for(int level = 0; level < NUMBER_OF_LEVELS; level++) {
+        if(!occupiedSlots[level])
+            continue;
+        int shift = level * WHEEL_BITS;
+        int index = currentTick >> shift & WHEEL_MASK;
+        // the current slot of higher levels only has timers for the next rotation
+        int start = level ? index + 1 : index;
+        uint64_t later = start < WHEEL_SIZE ? occupiedSlots[level] & ~0ULL << start : 0;
+        int slot = __builtin_ctzll(later ? later : occupiedSlots[level]);
+        TimeStamp tick = (currentTick >> (shift + WHEEL_BITS) << (shift + WHEEL_BITS)) + ((TimeStamp)slot << shift);
+        if(!later)
+            tick += 1UL << (shift + WHEEL_BITS);
+        if(!next || tick < next)
+            next = tick;
+    }
+    return next;
+}
+static void armTimerFD(TimeStamp tick) {
+    struct itimerspec spec = {.it_value = {tick / 1000, tick % 1000 * 1000000}};
+    if(timerfd_settime(timerFD, TFD_TIMER_ABSTIME, &spec, NULL)) {
+        WARN("Could not arm timer fd for %ld", (long)tick);
+        armedTick = 0;
+        return;
+    }
+    armedTick = tick;
+}
+/// Stops polling timerFD once the last timer is gone
+static void releaseTimerFDIfUnused(void) {
+    if(numberOfTimers || !timerFDHandler)
+        return;
+    armTimerFD(0);
+    removeExtraEvent(timerFDHandler);
+    timerFDHandler = NULL;
+}
+static void onTimerFDReady(int fd) {
+    uint64_t expirations;
+    // the fd is non-blocking and may have been re-armed since it was polled, in which case there is nothing to read
+    if(read(fd, &expirations, sizeof(expirations)) != sizeof(expirations))
+        TRACE("Timer fd woke up without expirations");
+    armedTick = 0;
+    runExpiredTimers(getTime());
+}
+
+int runExpiredTimers(TimeStamp now) {
+    int count = 0;
+    while(currentTick <= now) {
+        if(!numberOfTimers) {
+            currentTick = now + 1;
+            break;
+        }
+        int index = currentTick & WHEEL_MASK;
+        if(!index)
+            cascade(1);
+        Timer* expired;
+        detachSlot(0, index, &expired);
+        currentTick++;
+        while(expired) {
+            Timer* timer = expired;
+            unlinkTimer(timer);
+            runningTimer = timer;
+            runningTimerCancelled = 0;
+            timer->callBack(timer->arg);
+            count++;
+            runningTimer = NULL;
+            if(timer->period && !runningTimerCancelled) {
+                timer->expires += timer->period * ((now - timer->expires) / timer->period + 1);
+                placeTimer(timer);
+            }
+            else {
+                numberOfTimers--;
+                slabFree(&timerSlab, timer);
+            }
+        }
+        // skip to the next non-empty slot or the next time level 0 wraps around
+        uint64_t later = occupiedSlots[0] & ~((2ULL << index) - 1);
+        TimeStamp next = later ? (currentTick & ~(TimeStamp)WHEEL_MASK) + __builtin_ctzll(later) :
+            ((currentTick - 1) | WHEEL_MASK) + 1;
+        if(next > currentTick)
+            currentTick = MIN(next, now + 1);
+    }
+    if(count)
+        TRACE("Ran %d timers", count);
+    if(timerFD != -1 && numberOfTimers)
+        armTimerFD(getNextTimerTick());
+    releaseTimerFDIfUnused();
+    return count;
+}
+
+Timer* addPeriodicTimer(uint32_t delay, uint32_t period, void(*callBack)(), void* arg) {
+    TimeStamp now = getTime();
+    if(!numberOfTimers)
+        currentTick = now;
+    Timer* timer = slabAlloc(&timerSlab);
+    *timer = (Timer) {.expires = now + delay, .period = period, .callBack = callBack, .arg = arg};
+    placeTimer(timer);
+    numberOfTimers++;
+    if(timerFD == -1)
+        timerFD = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if(!timerFDHandler)
+        timerFDHandler = addExtraEvent(timerFD, POLLIN, onTimerFDReady);
+    if(!armedTick || timer->expires < armedTick)
+        armTimerFD(timer->expires);
+    return timer;
+}
+Timer* addTimer(uint32_t delay, void(*callBack)(), void* arg) {
+    return addPeriodicTimer(delay, 0, callBack, arg);
+}
+
+void cancelTimer(Timer* timer) {
+    if(timer == runningTimer) {
+        runningTimerCancelled = 1;
+        return;
+    }
+    removeTimer(timer);
+    numberOfTimers--;
+    slabFree(&timerSlab, timer);
+    releaseTimerFDIfUnused();
+}
+
+uint32_t getNumberOfTimers(void) {
+    return numberOfTimers;
+}
@@ -0,0 +1,56 @@
+/**
+ * @file timers.h
+ * @brief Callbacks scheduled to run after a delay
+ *
+ * Timers are stored in a hierarchical timing wheel so adding, cancelling and expiring a timer are all O(1).
+ * The wheel is driven by a timerfd registered with the event loop, so timers only run while the event loop is running
+ * or when runExpiredTimers is called directly.
+ */
+#ifndef MPX_TIMERS_H_
+#define MPX_TIMERS_H_
+
+#include <stdint.h>
+#include "mywm-structs.h"
+
+/// Handle to a scheduled callback
+typedef struct Timer Timer;
+
+/**
+ * Calls callBack(arg) once after delay ms.
+ * The handle is no longer valid once the callback has been called.
+ *
+ * @param delay time to wait in ms
+ * @param callBack
+ * @param arg
+ * @return a handle that can be passed to cancelTimer
+ */
+Timer* addTimer(uint32_t delay, void(*callBack)(), void* arg);
+/**
+ * Calls callBack(arg) after delay ms and every period ms after that until cancelled.
+ * If the event loop falls behind, missed periods are skipped instead of run back to back.
+ *
+ * @param delay time to wait in ms before the first call
+ * @param period a non-zero time in ms between calls
+ * @param callBack
+ * @param arg
+ * @return a handle that can be passed to cancelTimer
+ */
+Timer* addPeriodicTimer(uint32_t delay, uint32_t period, void(*callBack)(), void* arg);
+/**
+ * Prevents timer from running again. May be called from any timer callback including timer's own.
+ * @param timer a periodic timer or a one shot timer that has not run yet
+ */
+void cancelTimer(Timer* timer);
+/**
+ * @return the number of timers that are scheduled
+ */
+uint32_t getNumberOfTimers(void);
+/**
+ * Runs every timer that expires at or before now.
+ * This is normally called by the event loop.
+ *
+ * @param now the current time as returned by getTime
+ * @return the number of callbacks called
+ */
+int runExpiredTimers(TimeStamp now);
+#endif
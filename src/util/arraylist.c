@@ -23,6 +23,13 @@ int getIndex(const ArrayList* array, const void* p, size_t size) {
     }
     return -1;
 }
+int getIndexOfPtr(const ArrayList* array, const void* p) {
+    for(int i = 0; i < array->size; i++) {
+        if(array->__arr[i] == p)
+            return i;
+    }
+    return -1;
+}
 void* findElement(const ArrayList* array, const void* p, size_t size) {
     int index  = getIndex(array, p, size);
     return index == -1 ? NULL : array->__arr[index];
@@ -34,16 +41,14 @@ void* removeElement(ArrayList* array, const void* p, size_t size) {
 }
 void* removeIndex(ArrayList* array, uint32_t index) {
     void* value = getElement(array, index);
-    for(uint32_t i = index; i < array->size - 1; i++)
-        array->__arr[i] = array->__arr[i + 1];
+    memmove(&array->__arr[index], &array->__arr[index + 1], sizeof(void*) * (array->size - index - 1));
     array->size--;
     return value;
 }
 void shiftToPos(ArrayList* array, uint32_t index, int endingPos) {
     assert(index >= endingPos);
     void* value = getElement(array, index);
-    for(int i = index; i > endingPos; i--)
-        array->__arr[i] = array->__arr[i - 1];
+    memmove(&array->__arr[endingPos + 1], &array->__arr[endingPos], sizeof(void*) * (index - endingPos));
     array->__arr[endingPos] = value;
 }
 void addElementAt(ArrayList* array, void* value, uint32_t index) {
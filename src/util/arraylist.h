@@ -27,6 +27,12 @@ static inline void* getHead(const ArrayList* array) { return getElement(array, 0
 static inline void* getTail(const ArrayList* array) { return getElement(array, array->size-1);}
 void addElement(ArrayList* array, void* p);
 int getIndex(const ArrayList* array, const void* p, size_t size);
+/**
+ * Like getIndex but compares the elements themselves instead of what they point to
+ * @param p
+ * @return the index of p or -1
+ */
+int getIndexOfPtr(const ArrayList* array, const void* p);
 void* findElement(const ArrayList* array, const void* p, size_t size);
 void* removeElement(ArrayList* array, const void* p, size_t size);
 /**
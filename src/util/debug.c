@@ -8,7 +8,9 @@
 #include "../user-events.h"
 #include "../window-masks.h"
 #include "../windows.h"
+#include "../wmfunctions.h"
 #include "../workspaces.h"
+#include "../xevent.h"
 #include "debug.h"
 #include "logger.h"
 
@@ -132,7 +134,7 @@ void dumpWorkspace(Workspace* workspace) {
         printf(" %s", getMaskAsString(workspace->mask, buffer));
     printf("Windows: {");
     if(getWorkspaceWindowStack(workspace)->size) {
-        FOR_EACH(WindowInfo*, winInfo, getWorkspaceWindowStack(workspace))
+        FOR_EACH_VALUE(WindowInfo*, winInfo, getWorkspaceWindowStack(workspace))
         printf(" %d", winInfo->id);
     }
     printf("}\n");
@@ -157,17 +159,23 @@ void dumpSlave(Slave*slave) {
     printf("ID: %3d; Master %3d; Keyboard %3d; %s\n", slave->id, slave->attachment, slave->keyboard, slave->name);
 }
 
+void dumpSlab(const Slab* slab) {
+    printf("%-16s size %4d; used %6d; capacity %6d; peak %6d; allocations %d\n", slab->name, slab->objectSize,
+        slab->used, getSlabCapacity(slab), slab->peak, slab->allocations);
+}
+
 void dumpWindowInfo(WindowInfo* winInfo) {
     printf("{ID %d%s ", winInfo->id, (isTileable(winInfo) ? "*" : !isMappable(winInfo) ? "?" :  ""));
+    WindowProperties* properties = getWindowProperties(winInfo);
     if(winInfo->type)
-        printf("Title '%s' Class '%s' '%s' ", winInfo->title, winInfo->className, winInfo->instanceName);
-    if(winInfo->role[0])
-        printf("Role '%s' ", winInfo->role);
+        printf("Title '%s' Class '%s' '%s' ", properties->title, properties->className, properties->instanceName);
+    if(properties->role[0])
+        printf("Role '%s' ", properties->role);
     if(winInfo->dock) {
         printf("Dock ");
     }
     if(winInfo->type) {
-        printf("Type %s %d ", winInfo->typeName, winInfo->implicitType);
+        printf("Type %s %d ", properties->typeName, winInfo->implicitType);
     }
     printf("%s ", getMaskAsString(winInfo->mask, buffer));
     printf("Geometry: ");
@@ -182,7 +190,8 @@ void dumpWindowFilter(WindowMask filterMask) {
 }
 void dumpWindowByClass(const char* match) {
     FOR_EACH(WindowInfo*, winInfo, getAllWindows()) {
-        if(!strcmp(winInfo->className, match) || !strcmp(winInfo->instanceName, match))
+        if(!strcmp(getWindowProperties(winInfo)->className, match) ||
+            !strcmp(getWindowProperties(winInfo)->instanceName, match))
             dumpWindowInfo(winInfo);
     }
 }
@@ -217,20 +226,88 @@ void printSummary(void) {
     FOR_EACH(WindowInfo*, winInfo, getAllWindows()) {
         dumpWindowInfo(winInfo);
     }
+    printf("\nSlabs:\n");
+    FOR_EACH(Slab*, slab, getAllSlabs()) {
+        dumpSlab(slab);
+    }
+    printf("\nCoalesced events:\n");
+    for(int i = 0; i < LAST_REAL_EVENT; i++)
+        if(getNumberOfCoalescedEvents(i))
+            printf("%s: %d\n", eventTypeToString(i), getNumberOfCoalescedEvents(i));
+    printf("\nConfigure requests: %d sent; %d suppressed; %d values suppressed\n", getNumberOfConfigureRequests(),
+        getNumberOfSuppressedConfigureRequests(), getNumberOfSuppressedConfigureValues());
 }
 
-ArrayList* getEventList(int type, bool batch);
-
+/// prints a line of latency percentiles (us) if histogram isn't empty
+static void dumpHistogram(const char* name, const Histogram* histogram) {
+    if(!histogram->count)
+        return;
+    printf("%-32s %8lu %10.1f %10.1f %10.1f %10.1f %10.1f\n", name, (unsigned long)histogram->count,
+        getHistogramMean(histogram) / 1e3, getHistogramPercentile(histogram, 50) / 1e3,
+        getHistogramPercentile(histogram, 90) / 1e3, getHistogramPercentile(histogram, 99) / 1e3,
+        histogram->max / 1e3);
+}
+void dumpLatency(void) {
+    const char* header = "%-32s %8s %10s %10s %10s %10s %10s\n";
+    printf("Dispatch latency (us):\n");
+    printf(header, "event", "count", "mean", "p50", "p90", "p99", "max");
+    for(int i = 0; i < NUMBER_OF_MPX_EVENTS; i++)
+        dumpHistogram(eventTypeToString(i), getEventLatency(i));
+    printf("\nQueue wait (us):\n");
+    printf(header, "event", "count", "mean", "p50", "p90", "p99", "max");
+    for(int i = 0; i < LASTEvent; i++)
+        dumpHistogram(eventTypeToString(i), getEventQueueWait(i));
+}
+void resetStats(void) {
+    clearEventLatency();
+    clearRuleStats();
+    clearEventQueueStats();
+}
 
+/// A rule and the event it is registered for
+typedef struct {
+    const BoundFunction* func;
+    int type;
+    bool batch;
+} ProfiledRule;
+/// orders rules by descending self time
+static int compareRuleCost(const void* a, const void* b) {
+    TimeStamp costA = ((const ProfiledRule*)a)->func->stats->selfTime;
+    TimeStamp costB = ((const ProfiledRule*)b)->func->stats->selfTime;
+    return costA < costB ? 1 : costA > costB ? -1 : 0;
+}
 void dumpRules(void) {
+    int numberOfRules = 0;
     for(int batch = 0; batch < 2; batch++) {
         for(int i = 0; i < NUMBER_OF_MPX_EVENTS; i++)
-            if(!getEventList(i, batch)->size) {
+            if(getEventList(i, batch)->size) {
                 printf("%s%s: {", batch ? "BATCH_" : "", eventTypeToString(i));
-                FOR_EACH(BoundFunction*, b, getEventList(i, batch)) {
+                FOR_EACH_VECTOR(BoundFunction, b, getEventList(i, batch)) {
                     printf("%s, ", b->name);
+                    numberOfRules += b->stats && b->stats->invocations;
                 }
                 printf("}\n");
             }
     }
+    if(!numberOfRules)
+        return;
+    ProfiledRule* rules = malloc(sizeof(ProfiledRule) * numberOfRules);
+    int n = 0;
+    for(int batch = 0; batch < 2; batch++)
+        for(int i = 0; i < NUMBER_OF_MPX_EVENTS; i++) {
+            FOR_EACH_VECTOR(BoundFunction, b, getEventList(i, batch)) {
+                if(b->stats && b->stats->invocations)
+                    rules[n++] = (ProfiledRule) {b, i, batch};
+            }
+        }
+    qsort(rules, numberOfRules, sizeof(ProfiledRule), compareRuleCost);
+    printf("\nRule profile (us):\n");
+    printf("%-40s %-32s %8s %8s %12s %10s %12s\n", "rule", "event", "calls", "aborts", "self", "max", "X wait");
+    for(int i = 0; i < numberOfRules; i++) {
+        const RuleStats* stats = rules[i].func->stats;
+        sprintf(buffer, "%s%s", rules[i].batch ? "BATCH_" : "", eventTypeToString(rules[i].type));
+        printf("%-40s %-32s %8u %8u %12.1f %10.1f %12.1f\n", rules[i].func->name, buffer, stats->invocations,
+            stats->aborts, stats->selfTime / 1e3, stats->maxTime / 1e3, stats->xTime / 1e3);
+    }
+    free(rules);
 }
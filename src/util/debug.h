@@ -6,6 +6,7 @@
 #define MPXMANAGER_DEBUG_H_
 #include "../mywm-structs.h"
 #include "rect.h"
+#include "slab.h"
 #include <stdbool.h>
 
 
@@ -29,9 +30,19 @@ void dumpWindowFilter(WindowMask filterMask);
  */
 void printSummary(void);
 /**
- * Prints all set rules
+ * Prints all set rules followed by the profile of each rule that has run while PROFILE_RULES was set, most expensive
+ * first
  */
 void dumpRules(void);
+/**
+ * Prints percentiles of the time spent applying the rules of each event type and of the time X events spent
+ * queued before being processed
+ */
+void dumpLatency(void);
+/**
+ * Clears all latency histograms, event counters and rule profiles
+ */
+void resetStats(void);
 static inline void dumpWindowSingleWindow() {dumpWindowFilter(0);}
 
 /**
@@ -46,6 +57,12 @@ void dumpWindowByClass(const char* match);
  * @param master
  */
 void dumpMaster(Master* master) ;
+/**
+ * Prints the usage statistics of slab
+ *
+ * @param slab
+ */
+void dumpSlab(const Slab* slab);
 /**
  * Stringifies type
  *
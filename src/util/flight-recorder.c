@@ -0,0 +1,520 @@
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../xevent.h"
+#include "flight-recorder.h"
+#include "time.h"
+
+/// The records of a single thread
+typedef struct {
+    /// number of records ever written; only written by the owning thread
+    uint64_t head;
+    /// number of records that have been flushed or lost; only accessed while holding flushLock
+    uint64_t flushed;
+    /// set while a thread owns the ring
+    bool inUse;
+    LogRecord records[FLIGHT_RECORDER_SIZE];
+} FlightRecorderRing;
+
+/**
+ * Rings are never freed since the flusher may be reading them; the ring of a thread that exited is handed to the next
+ * new thread, which keeps appending after the records that are left
+ */
+static FlightRecorderRing* rings[MAX_FLIGHT_RECORDER_THREADS];
+/// the ring of the calling thread
+static __thread FlightRecorderRing* threadRing;
+/// set if the calling thread could not be given a ring
+static __thread bool noThreadRing;
+/// releases the ring of a thread when it exits
+static pthread_key_t threadRingKey;
+static pthread_once_t threadRingKeyOnce = PTHREAD_ONCE_INIT;
+
+static pthread_mutex_t flushLock = PTHREAD_MUTEX_INITIALIZER;
+static int flushFD = -1;
+static uint64_t lostRecords;
+/// set while flushFlightRecorder writes to flushFD
+static bool flushWriting;
+/// set once dumpFlightRecorder starts; nothing is flushed after that so the dump isn't interleaved with a flush
+static bool dumping;
+
+static void releaseThreadRing(void* ring) {
+    __atomic_store_n(&((FlightRecorderRing*)ring)->inUse, 0, __ATOMIC_RELEASE);
+}
+static void createThreadRingKey(void) {
+    pthread_key_create(&threadRingKey, releaseThreadRing);
+}
+/// @return an unused ring marked as in use or NULL if MAX_FLIGHT_RECORDER_THREADS threads already have one
+static FlightRecorderRing* claimRing(void) {
+    for(int i = 0; i < MAX_FLIGHT_RECORDER_THREADS; i++) {
+        FlightRecorderRing* ring = __atomic_load_n(&rings[i], __ATOMIC_ACQUIRE);
+        if(!ring) {
+            FlightRecorderRing* newRing = calloc(1, sizeof(FlightRecorderRing));
+            if(!newRing)
+                return NULL;
+            newRing->inUse = 1;
+            if(__atomic_compare_exchange_n(&rings[i], &ring, newRing, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE))
+                return newRing;
+            // another thread created ring i first
+            free(newRing);
+        }
+        bool inUse = 0;
+        if(__atomic_compare_exchange_n(&ring->inUse, &inUse, 1, 0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+            return ring;
+    }
+    return NULL;
+}
+static FlightRecorderRing* getThreadRing(void) {
+    if(!threadRing && !noThreadRing) {
+        pthread_once(&threadRingKeyOnce, createThreadRingKey);
+        threadRing = claimRing();
+        if(threadRing)
+            pthread_setspecific(threadRingKey, threadRing);
+        else
+            noThreadRing = 1;
+    }
+    return threadRing;
+}
+
+/// A single printf conversion specification
+typedef struct {
+    /// the spec starting with '%'
+    const char* start;
+    int len;
+    /// number of '*' width/precision arguments that precede the value
+    int stars;
+    /// true if the value is 8 bytes wide
+    bool wide;
+    /// true if the spec has the 'L' length modifier
+    bool longDouble;
+    char conversion;
+} ConversionSpec;
+
+static inline bool isFlagOrWidth(char c) {
+    return c >= '0' && c <= '9' || c == '-' || c == '+' || c == ' ' || c == '#' || c == '.' || c == '*' || c == '\'';
+}
+static inline bool isLengthModifier(char c) {
+    return c == 'l' || c == 'h' || c == 'z' || c == 'L' || c == 'q' || c == 'j' || c == 't';
+}
+/**
+ * @param format
+ * @param spec set to the next conversion in format
+ * @return a pointer to the first char after the conversion or NULL if there are none left
+ */
+static const char* nextConversion(const char* format, ConversionSpec* spec) {
+    for(; (format = strchr(format, '%')); format++) {
+        if(format[1] == '%') {
+            format++;
+            continue;
+        }
+        const char* p = format + 1;
+        *spec = (ConversionSpec) {.start = format};
+        for(; isFlagOrWidth(*p); p++)
+            spec->stars += *p == '*';
+        for(; isLengthModifier(*p); p++) {
+            spec->wide |= *p != 'h';
+            spec->longDouble |= *p == 'L';
+        }
+        if(!*p)
+            return NULL;
+        spec->conversion = *p;
+        spec->len = p + 1 - format;
+        return p + 1;
+    }
+    return NULL;
+}
+static inline bool isFloatConversion(char c) {
+    switch(c | 0x20) {
+        case 'a':
+        case 'e':
+        case 'f':
+        case 'g':
+            return 1;
+    }
+    return 0;
+}
+
+/**
+ * Copies the arguments of format to args.
+ * Arguments that don't fit are dropped; a string is truncated to fit if needed
+ *
+ * @return the number of bytes of args used
+ */
+static int copyArgs(char* args, const char* format, va_list* list) {
+    int size = 0;
+    ConversionSpec spec;
+    while((format = nextConversion(format, &spec))) {
+        for(int i = 0; i < spec.stars; i++) {
+            int64_t value = va_arg(*list, int);
+            if(size + sizeof(value) <= LOG_RECORD_ARGS_SIZE) {
+                memcpy(args + size, &value, sizeof(value));
+                size += sizeof(value);
+            }
+        }
+        if(spec.conversion == 's') {
+            const char* str = va_arg(*list, const char*);
+            if(!str)
+                str = "(null)";
+            int len = strlen(str);
+            if(size < LOG_RECORD_ARGS_SIZE) {
+                if(len > LOG_RECORD_ARGS_SIZE - size - 1)
+                    len = LOG_RECORD_ARGS_SIZE - size - 1;
+                memcpy(args + size, str, len);
+                args[size + len] = 0;
+                size += len + 1;
+            }
+            continue;
+        }
+        int64_t value;
+        if(isFloatConversion(spec.conversion)) {
+            double d = spec.longDouble ? (double)va_arg(*list, long double) : va_arg(*list, double);
+            memcpy(&value, &d, sizeof(value));
+        }
+        else if(spec.conversion == 'p' || spec.conversion == 'n')
+            value = (intptr_t)va_arg(*list, void*);
+        else
+            value = spec.wide ? va_arg(*list, int64_t) : va_arg(*list, int);
+        if(spec.conversion != 'n' && size + sizeof(value) <= LOG_RECORD_ARGS_SIZE) {
+            memcpy(args + size, &value, sizeof(value));
+            size += sizeof(value);
+        }
+    }
+    return size;
+}
+
+void recordLogMessage(LogLevel level, const char* format, va_list args) {
+    FlightRecorderRing* ring = getThreadRing();
+    if(!ring)
+        return;
+    uint64_t index = ring->head;
+    LogRecord* record = &ring->records[index & (FLIGHT_RECORDER_SIZE - 1)];
+    // readers that see 0 before or after copying the record know it was being overwritten
+    __atomic_store_n(&record->sequence, 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    record->time = getTimeNs();
+    record->format = format;
+    record->level = level;
+    record->xSequence = getCurrentSequenceNumber();
+    record->idleCount = getIdleCount();
+    int depth;
+    const char* const* contexts = getContextStack(&depth);
+    int numContexts = depth < LOG_RECORD_CONTEXTS ? depth : LOG_RECORD_CONTEXTS;
+    for(int i = 0; i < numContexts; i++)
+        record->contexts[i] = contexts[depth - numContexts + i];
+    record->numContexts = depth < UINT8_MAX ? depth : UINT8_MAX;
+    va_list list;
+    va_copy(list, args);
+    record->size = copyArgs(record->args, format, &list);
+    va_end(list);
+    __atomic_store_n(&record->sequence, index + 1, __ATOMIC_RELEASE);
+    __atomic_store_n(&ring->head, index + 1, __ATOMIC_RELEASE);
+}
+
+/// Reads the next 8 byte argument of record
+/// @return false if there are none left
+static bool readArg(const LogRecord* record, int* offset, int64_t* value) {
+    if(*offset + sizeof(*value) > record->size)
+        return 0;
+    memcpy(value, record->args + *offset, sizeof(*value));
+    *offset += sizeof(*value);
+    return 1;
+}
+
+/**
+ * Appends the literal text between start and end of a format to buffer; "%%" is appended as "%"
+ * @return the new length of buffer which may exceed limit
+ */
+static int appendText(char* buffer, int len, int limit, const char* start, const char* end) {
+    for(const char* p = start; p < end; p++) {
+        if(*p == '%' && p + 1 < end && p[1] == '%')
+            p++;
+        if(len < limit - 1)
+            buffer[len] = *p;
+        len++;
+    }
+    if(len < limit)
+        buffer[len] = 0;
+    return len;
+}
+
+static const char* levelNames[] = {"VERBOSE", "TRACE", "DEBUG", "INFO", "WARN", "ERROR"};
+
+int formatLogRecord(const LogRecord* record, char* buffer, int size) {
+    // 1 byte is reserved for the new line
+    int limit = size - 1;
+    int len = 0;
+#define APPEND(X...) len += snprintf(buffer + (len < limit ? len : limit), len < limit ? limit - len : 0, X)
+    APPEND("%lu.%09lu|%s|%04X|%04X|", record->time / 1000000000UL, record->time % 1000000000UL,
+        record->level < LEN(levelNames) ? levelNames[record->level] : "?", record->xSequence, record->idleCount);
+    int numContexts = record->numContexts < LOG_RECORD_CONTEXTS ? record->numContexts : LOG_RECORD_CONTEXTS;
+    if(record->numContexts > numContexts)
+        APPEND("[...]");
+    for(int i = 0; i < numContexts; i++)
+        APPEND("[%s]", record->contexts[i]);
+    const char* format = record->format;
+    int offset = 0;
+    ConversionSpec spec;
+    for(const char* next; (next = nextConversion(format, &spec)); format = next) {
+        len = appendText(buffer, len, limit, format, spec.start);
+        char conversion[32];
+        int stars[2] = {0};
+        bool complete = spec.len < sizeof(conversion) && spec.stars <= LEN(stars);
+        for(int i = 0; complete && i < spec.stars; i++) {
+            int64_t value;
+            complete = readArg(record, &offset, &value);
+            stars[i] = value;
+        }
+        if(complete) {
+            // the value is passed as a double so the long double length modifier is dropped
+            int n = 0;
+            for(int i = 0; i < spec.len; i++)
+                if(spec.start[i] != 'L')
+                    conversion[n++] = spec.start[i];
+            conversion[n] = 0;
+        }
+#define APPEND_VALUE(VALUE) do { \
+            if(spec.stars == 0) APPEND(conversion, VALUE); \
+            else if(spec.stars == 1) APPEND(conversion, stars[0], VALUE); \
+            else APPEND(conversion, stars[0], stars[1], VALUE); \
+        } while(0)
+        int64_t value;
+        if(!complete)
+            ;
+        else if(spec.conversion == 'n')
+            continue;
+        else if(spec.conversion == 's') {
+            complete = offset < record->size;
+            if(complete) {
+                const char* str = record->args + offset;
+                APPEND_VALUE(str);
+                offset += strlen(str) + 1;
+            }
+        }
+        else if((complete = readArg(record, &offset, &value))) {
+            if(isFloatConversion(spec.conversion)) {
+                double d;
+                memcpy(&d, &value, sizeof(d));
+                APPEND_VALUE(d);
+            }
+            else if(spec.conversion == 'p')
+                APPEND_VALUE((void*)(intptr_t)value);
+            else if(spec.wide)
+                APPEND_VALUE((long long)value);
+            else
+                APPEND_VALUE((int)value);
+        }
+        if(!complete) {
+            APPEND("...");
+            format = "";
+            break;
+        }
+    }
+    len = appendText(buffer, len, limit, format, format + strlen(format));
+    if(len > limit - 1)
+        len = limit - 1;
+    buffer[len++] = '\n';
+    buffer[len] = 0;
+    return len;
+}
+
+static void writeAll(int fd, const char* buffer, int size) {
+    while(size > 0) {
+        int n = write(fd, buffer, size);
+        if(n <= 0)
+            return;
+        buffer += n;
+        size -= n;
+    }
+}
+
+/**
+ * Writes buffer to fd.
+ * A flush marks itself as writing first so dumpFlightRecorder can wait for it to finish instead of interleaving lines
+ *
+ * @param flushing true if called by flushFlightRecorder
+ * @return false if a dump has started so the flush should stop
+ */
+static bool writeBuffer(int fd, const char* buffer, int size, bool flushing) {
+    if(flushing) {
+        __atomic_store_n(&flushWriting, 1, __ATOMIC_SEQ_CST);
+        if(__atomic_load_n(&dumping, __ATOMIC_SEQ_CST)) {
+            __atomic_store_n(&flushWriting, 0, __ATOMIC_SEQ_CST);
+            return 0;
+        }
+    }
+    writeAll(fd, buffer, size);
+    if(flushing)
+        __atomic_store_n(&flushWriting, 0, __ATOMIC_SEQ_CST);
+    return 1;
+}
+
+/**
+ * Copies the record at index of ring.
+ * @return false if the record has been or is being overwritten
+ */
+static bool readRecord(const FlightRecorderRing* ring, uint64_t index, LogRecord* record) {
+    const LogRecord* src = &ring->records[index & (FLIGHT_RECORDER_SIZE - 1)];
+    if(__atomic_load_n(&src->sequence, __ATOMIC_ACQUIRE) != index + 1)
+        return 0;
+    memcpy(record, src, sizeof(LogRecord));
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    return __atomic_load_n(&src->sequence, __ATOMIC_RELAXED) == index + 1;
+}
+
+/**
+ * Writes the records of every ring between cursors[i] and ends[i] to fd in time order
+ *
+ * @param fd
+ * @param cursors the index of the first record of each ring to write; set to ends
+ * @param ends
+ * @return the number of records that were overwritten before they could be read
+ */
+static uint64_t writeRecords(int fd, uint64_t* cursors, const uint64_t* ends, bool flushing) {
+    LogRecord next[MAX_FLIGHT_RECORDER_THREADS];
+    bool valid[MAX_FLIGHT_RECORDER_THREADS] = {0};
+    uint64_t lost = 0;
+    char buffer[4096];
+    int used = 0;
+    while(1) {
+        int earliest = -1;
+        for(int i = 0; i < MAX_FLIGHT_RECORDER_THREADS; i++) {
+            while(!valid[i] && cursors[i] < ends[i]) {
+                valid[i] = readRecord(rings[i], cursors[i], &next[i]);
+                cursors[i]++;
+                lost += !valid[i];
+            }
+            if(valid[i] && (earliest == -1 || next[i].time < next[earliest].time))
+                earliest = i;
+        }
+        if(earliest == -1)
+            break;
+        valid[earliest] = 0;
+        if(used > sizeof(buffer) - 512) {
+            if(!writeBuffer(fd, buffer, used, flushing))
+                return lost;
+            used = 0;
+        }
+        used += formatLogRecord(&next[earliest], buffer + used, 512);
+    }
+    writeBuffer(fd, buffer, used, flushing);
+    return lost;
+}
+
+/// @return the number of records ever written to ring or 0 if ring is NULL
+static inline uint64_t getRingHead(const FlightRecorderRing* ring) {
+    return ring ? __atomic_load_n(&ring->head, __ATOMIC_ACQUIRE) : 0;
+}
+
+void flushFlightRecorder(void) {
+    pthread_mutex_lock(&flushLock);
+    if(flushFD != -1) {
+        uint64_t cursors[MAX_FLIGHT_RECORDER_THREADS] = {0};
+        uint64_t ends[MAX_FLIGHT_RECORDER_THREADS] = {0};
+        for(int i = 0; i < MAX_FLIGHT_RECORDER_THREADS; i++) {
+            FlightRecorderRing* ring = __atomic_load_n(&rings[i], __ATOMIC_ACQUIRE);
+            if(!ring)
+                continue;
+            ends[i] = getRingHead(ring);
+            if(ends[i] - ring->flushed > FLIGHT_RECORDER_SIZE) {
+                lostRecords += ends[i] - ring->flushed - FLIGHT_RECORDER_SIZE;
+                ring->flushed = ends[i] - FLIGHT_RECORDER_SIZE;
+            }
+            cursors[i] = ring->flushed;
+            ring->flushed = ends[i];
+        }
+        lostRecords += writeRecords(flushFD, cursors, ends, 1);
+    }
+    pthread_mutex_unlock(&flushLock);
+}
+
+void dumpFlightRecorder(int fd) {
+    __atomic_store_n(&dumping, 1, __ATOMIC_SEQ_CST);
+    // wait for a flush that is mid write; it never finishes if this interrupted the flushing thread, so give up after
+    // a while
+    for(int i = 0; i < 100 && __atomic_load_n(&flushWriting, __ATOMIC_SEQ_CST); i++)
+        nanosleep(&(struct timespec) {.tv_nsec = 1000000}, NULL);
+    uint64_t cursors[MAX_FLIGHT_RECORDER_THREADS] = {0};
+    uint64_t ends[MAX_FLIGHT_RECORDER_THREADS] = {0};
+    for(int i = 0; i < MAX_FLIGHT_RECORDER_THREADS; i++) {
+        ends[i] = getRingHead(__atomic_load_n(&rings[i], __ATOMIC_ACQUIRE));
+        cursors[i] = ends[i] > FLIGHT_RECORDER_SIZE ? ends[i] - FLIGHT_RECORDER_SIZE : 0;
+    }
+    writeRecords(fd, cursors, ends, 0);
+    __atomic_store_n(&dumping, 0, __ATOMIC_SEQ_CST);
+}
+
+static pthread_t flushThread;
+static bool flushThreadRunning;
+static bool stopFlushThread;
+static pthread_mutex_t flushThreadLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t flushThreadCondition = PTHREAD_COND_INITIALIZER;
+
+static void* flushPeriodically(void* arg) {
+    pthread_mutex_lock(&flushThreadLock);
+    while(!stopFlushThread) {
+        struct timespec timeout;
+        clock_gettime(CLOCK_REALTIME, &timeout);
+        timeout.tv_nsec += FLIGHT_RECORDER_FLUSH_INTERVAL * 1000000L;
+        timeout.tv_sec += timeout.tv_nsec / 1000000000L;
+        timeout.tv_nsec %= 1000000000L;
+        pthread_cond_timedwait(&flushThreadCondition, &flushThreadLock, &timeout);
+        pthread_mutex_unlock(&flushThreadLock);
+        flushFlightRecorder();
+        pthread_mutex_lock(&flushThreadLock);
+    }
+    pthread_mutex_unlock(&flushThreadLock);
+    return NULL;
+}
+
+bool startFlushingFlightRecorder(const char* path) {
+    stopFlushingFlightRecorder();
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if(fd == -1) {
+        WARN("Could not open flight recorder file '%s'", path);
+        return 0;
+    }
+    pthread_mutex_lock(&flushLock);
+    flushFD = fd;
+    // only records logged from now on are flushed
+    for(int i = 0; i < MAX_FLIGHT_RECORDER_THREADS; i++)
+        if(rings[i])
+            rings[i]->flushed = getRingHead(rings[i]);
+    pthread_mutex_unlock(&flushLock);
+    stopFlushThread = 0;
+    flushThreadRunning = !pthread_create(&flushThread, NULL, flushPeriodically, NULL);
+    if(!flushThreadRunning)
+        WARN("Could not start flight recorder thread; records will only be flushed on exit");
+    return 1;
+}
+
+void stopFlushingFlightRecorder(void) {
+    if(flushThreadRunning) {
+        pthread_mutex_lock(&flushThreadLock);
+        stopFlushThread = 1;
+        pthread_cond_signal(&flushThreadCondition);
+        pthread_mutex_unlock(&flushThreadLock);
+        pthread_join(flushThread, NULL);
+        flushThreadRunning = 0;
+    }
+    flushFlightRecorder();
+    pthread_mutex_lock(&flushLock);
+    if(flushFD != -1)
+        close(flushFD);
+    flushFD = -1;
+    pthread_mutex_unlock(&flushLock);
+}
+
+int getFlightRecorderFD(void) {
+    return flushFD;
+}
+
+uint64_t getNumberOfLogRecords(void) {
+    return getRingHead(threadRing);
+}
+uint64_t getNumberOfLostLogRecords(void) {
+    return lostRecords;
+}
@@ -0,0 +1,110 @@
+/**
+ * @file flight-recorder.h
+ * @brief In memory ring of recent log messages
+ *
+ * Log messages at or above the flight recorder level are stored as fixed size binary records (time, level, format
+ * pointer and a copy of the arguments) in a ring owned by the logging thread; nothing is formatted until the records
+ * are flushed. Writers never block or take a lock. Readers detect records that were overwritten while being copied and
+ * drop them.
+ */
+#ifndef MPX_FLIGHT_RECORDER_H_
+#define MPX_FLIGHT_RECORDER_H_
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "../mywm-structs.h"
+#include "logger.h"
+
+/// number of records in each thread's ring; must be a power of 2
+#define FLIGHT_RECORDER_SIZE 1024
+/// max number of threads that can record at once; messages from other threads are dropped. Rings of exited threads
+/// are reused
+#define MAX_FLIGHT_RECORDER_THREADS 8
+/// number of innermost contexts saved with each record
+#define LOG_RECORD_CONTEXTS 3
+/// bytes available to the copied arguments of a record
+#define LOG_RECORD_ARGS_SIZE 64
+/// how often (ms) the background thread flushes new records
+#define FLIGHT_RECORDER_FLUSH_INTERVAL 100
+
+/// A single log message
+typedef struct {
+    /// 1 + the index of the record in its ring or 0 while the record is being written
+    uint64_t sequence;
+    /// time (ns) the message was logged
+    TimeStamp time;
+    /// printf style format; assumed to be a string literal
+    const char* format;
+    /// the innermost contexts at the time of the message; outermost first
+    const char* contexts[LOG_RECORD_CONTEXTS];
+    /// the sequence number of the last X event that was processed
+    uint16_t xSequence;
+    uint16_t idleCount;
+    uint8_t level;
+    /// the depth of the context stack; may be larger than LOG_RECORD_CONTEXTS
+    uint8_t numContexts;
+    /// bytes of args that are used
+    uint8_t size;
+    /// each integer, pointer or double argument takes 8 bytes; strings are copied with their NUL terminator
+    char args[LOG_RECORD_ARGS_SIZE];
+} LogRecord;
+
+/**
+ * Stores a message in the ring of the calling thread
+ *
+ * @param level
+ * @param format a printf style format that outlives the recorder
+ * @param args the arguments of format
+ */
+void recordLogMessage(LogLevel level, const char* format, va_list args);
+/**
+ * Formats a record like the messages printed to stdout: time, level, X sequence number, idle count, contexts and the
+ * message.
+ *
+ * @param record
+ * @param buffer
+ * @param size the size of buffer
+ * @return the length of the formatted line (excluding the NUL terminator); always less than size
+ */
+int formatLogRecord(const LogRecord* record, char* buffer, int size);
+/**
+ * Writes the records that haven't been flushed yet to the file given to startFlushingFlightRecorder.
+ * Does nothing if no file is open
+ */
+void flushFlightRecorder(void);
+/**
+ * Opens path and starts a background thread that flushes new records every FLIGHT_RECORDER_FLUSH_INTERVAL ms.
+ * Any previously opened file is closed first.
+ *
+ * @param path file to truncate and write to
+ * @return true if the file could be opened
+ */
+bool startFlushingFlightRecorder(const char* path);
+/**
+ * Stops the background thread, flushes any remaining records and closes the file
+ */
+void stopFlushingFlightRecorder(void);
+/**
+ * @return the fd of the file opened by startFlushingFlightRecorder or -1
+ */
+int getFlightRecorderFD(void);
+/**
+ * Writes every record still in the rings of all threads, flushed or not, to fd.
+ * Doesn't allocate or take any locks so it can be called from a signal handler. A flush that is writing when the dump
+ * starts is waited for (briefly) and no flush writes anything while the dump runs, so their lines don't interleave
+ *
+ * @param fd
+ */
+void dumpFlightRecorder(int fd);
+/**
+ * @return the number of records ever written to the ring of the calling thread, including those of exited threads that
+ * owned it before
+ */
+uint64_t getNumberOfLogRecords(void);
+/**
+ * @return the number of records that were overwritten before they could be flushed
+ */
+uint64_t getNumberOfLostLogRecords(void);
+#endif
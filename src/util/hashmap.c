@@ -0,0 +1,85 @@
+#include <assert.h>
+#include <stdlib.h>
+#include "hashmap.h"
+
+/// initial number of slots; maps are grown once they are half full
+#define MIN_CAPACITY 16
+
+static inline uint32_t getSlot(const HashMap* map, uint32_t key) {
+    // Fibonacci hashing; spreads sequential ids (like X resource ids) across the table
+    return (key * 2654435769U) >> (32 - __builtin_ctz(map->capacity));
+}
+
+static HashMapEntry* findEntry(const HashMap* map, uint32_t key) {
+    if(!map->capacity)
+        return NULL;
+    for(uint32_t i = getSlot(map, key);; i = (i + 1) & (map->capacity - 1)) {
+        HashMapEntry* entry = &map->__entries[i];
+        if(!entry->value)
+            return NULL;
+        if(entry->key == key)
+            return entry;
+    }
+}
+
+static void insertEntry(HashMap* map, uint32_t key, void* value) {
+    for(uint32_t i = getSlot(map, key);; i = (i + 1) & (map->capacity - 1)) {
+        HashMapEntry* entry = &map->__entries[i];
+        if(!entry->value || entry->key == key) {
+            map->size += !entry->value;
+            *entry = (HashMapEntry) {key, value};
+            return;
+        }
+    }
+}
+
+static void resize(HashMap* map, uint32_t capacity) {
+    HashMapEntry* oldEntries = map->__entries;
+    uint32_t oldCapacity = map->capacity;
+    map->__entries = calloc(capacity, sizeof(HashMapEntry));
+    map->capacity = capacity;
+    map->size = 0;
+    for(uint32_t i = 0; i < oldCapacity; i++)
+        if(oldEntries[i].value)
+            insertEntry(map, oldEntries[i].key, oldEntries[i].value);
+    free(oldEntries);
+}
+
+void* getValue(const HashMap* map, uint32_t key) {
+    HashMapEntry* entry = findEntry(map, key);
+    return entry ? entry->value : NULL;
+}
+
+void putValue(HashMap* map, uint32_t key, void* value) {
+    assert(value);
+    if((map->size + 1) * 2 > map->capacity)
+        resize(map, map->capacity ? map->capacity * 2 : MIN_CAPACITY);
+    insertEntry(map, key, value);
+}
+
+void* removeKey(HashMap* map, uint32_t key) {
+    HashMapEntry* entry = findEntry(map, key);
+    if(!entry)
+        return NULL;
+    void* value = entry->value;
+    uint32_t mask = map->capacity - 1;
+    uint32_t hole = entry - map->__entries;
+    // shift back any entry in the same probe chain so there are no gaps
+    for(uint32_t i = (hole + 1) & mask; map->__entries[i].value; i = (i + 1) & mask) {
+        uint32_t home = getSlot(map, map->__entries[i].key);
+        if(((i - home) & mask) >= ((i - hole) & mask)) {
+            map->__entries[hole] = map->__entries[i];
+            hole = i;
+        }
+    }
+    map->__entries[hole].value = NULL;
+    map->size--;
+    return value;
+}
+
+void clearMap(HashMap* map) {
+    free(map->__entries);
+    map->__entries = NULL;
+    map->size = 0;
+    map->capacity = 0;
+}
@@ -0,0 +1,55 @@
+/**
+ * @file hashmap.h
+ * @brief Open addressing hash map from 32 bit keys to pointers
+ */
+#ifndef HASH_MAP_H
+#define HASH_MAP_H
+
+#include <stdint.h>
+
+/// A single key/value pair; a NULL value marks an unused slot
+typedef struct {
+    uint32_t key;
+    void* value;
+} HashMapEntry;
+
+/**
+ * Map from uint32_t keys to non-NULL pointers.
+ * Uses linear probing with backwards shift deletion so lookups never have to skip over tombstones.
+ * A zero-initialized HashMap is a valid empty map.
+ */
+typedef struct HashMap {
+    HashMapEntry* __entries;
+    /// number of keys in the map
+    uint32_t size;
+    /// number of slots allocated; always 0 or a power of 2
+    uint32_t capacity;
+} HashMap;
+
+/**
+ * @param map
+ * @param key
+ * @return the value associated with key or NULL
+ */
+void* getValue(const HashMap* map, uint32_t key);
+/**
+ * Associates key with value, replacing any existing value
+ *
+ * @param map
+ * @param key
+ * @param value a non-NULL pointer
+ */
+void putValue(HashMap* map, uint32_t key, void* value);
+/**
+ * Removes key from the map
+ *
+ * @param map
+ * @param key
+ * @return the value that was associated with key or NULL
+ */
+void* removeKey(HashMap* map, uint32_t key);
+/**
+ * Removes all keys and frees the memory backing the map
+ */
+void clearMap(HashMap* map);
+#endif
@@ -0,0 +1,36 @@
+#include <string.h>
+
+#include "histogram.h"
+
+/// @return the largest value counted in bucket
+static uint64_t getBucketUpperBound(uint32_t bucket) {
+    if(bucket < HISTOGRAM_SUB_BUCKETS)
+        return bucket;
+    if(bucket == HISTOGRAM_BUCKETS - 1)
+        return UINT64_MAX;
+    int exp = bucket / HISTOGRAM_SUB_BUCKETS + HISTOGRAM_SUB_BUCKET_BITS - 1;
+    uint64_t subBucket = bucket % HISTOGRAM_SUB_BUCKETS;
+    return ((HISTOGRAM_SUB_BUCKETS + subBucket + 1) << (exp - HISTOGRAM_SUB_BUCKET_BITS)) - 1;
+}
+
+uint64_t getHistogramPercentile(const Histogram* histogram, double percentile) {
+    if(!histogram->count)
+        return 0;
+    // the rank of the value at percentile; the min for 0 and the max for 100
+    uint64_t rank = percentile / 100 * (histogram->count - 1) + 1;
+    uint64_t seen = 0;
+    for(uint32_t i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        seen += histogram->buckets[i];
+        if(seen >= rank) {
+            uint64_t value = getBucketUpperBound(i);
+            return value < histogram->max ? value : histogram->max;
+        }
+    }
+    return histogram->max;
+}
+uint64_t getHistogramMean(const Histogram* histogram) {
+    return histogram->count ? histogram->total / histogram->count : 0;
+}
+void clearHistogram(Histogram* histogram) {
+    memset(histogram, 0, sizeof(Histogram));
+}
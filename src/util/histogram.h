@@ -0,0 +1,72 @@
+/**
+ * @file histogram.h
+ * @brief Fixed memory histograms of non-negative values
+ *
+ * Values are counted in log scale buckets: each power of two is split into HISTOGRAM_SUB_BUCKETS linear buckets,
+ * so recording is O(1) and any reported percentile is within 1/HISTOGRAM_SUB_BUCKETS of the real value.
+ */
+#ifndef MPX_HISTOGRAM_H_
+#define MPX_HISTOGRAM_H_
+
+#include <stdint.h>
+
+/// log2 of the number of buckets per power of 2
+#define HISTOGRAM_SUB_BUCKET_BITS 3
+#define HISTOGRAM_SUB_BUCKETS (1 << HISTOGRAM_SUB_BUCKET_BITS)
+/// values at or above 2^HISTOGRAM_MAX_BITS are counted in the last bucket
+#define HISTOGRAM_MAX_BITS 40
+#define HISTOGRAM_BUCKETS ((HISTOGRAM_MAX_BITS - HISTOGRAM_SUB_BUCKET_BITS + 1) * HISTOGRAM_SUB_BUCKETS)
+
+typedef struct {
+    /// number of recorded values
+    uint64_t count;
+    /// sum of all recorded values
+    uint64_t total;
+    /// largest recorded value
+    uint64_t max;
+    uint32_t buckets[HISTOGRAM_BUCKETS];
+} Histogram;
+
+/**
+ * @param value
+ * @return the index of the bucket value is counted in
+ */
+static inline uint32_t getHistogramBucket(uint64_t value) {
+    if(value < HISTOGRAM_SUB_BUCKETS)
+        return value;
+    int exp = 63 - __builtin_clzll(value);
+    if(exp >= HISTOGRAM_MAX_BITS)
+        return HISTOGRAM_BUCKETS - 1;
+    return (exp - HISTOGRAM_SUB_BUCKET_BITS + 1) * HISTOGRAM_SUB_BUCKETS +
+        (value >> (exp - HISTOGRAM_SUB_BUCKET_BITS) & (HISTOGRAM_SUB_BUCKETS - 1));
+}
+/**
+ * Records a single value
+ * @param histogram
+ * @param value
+ */
+static inline void addHistogramValue(Histogram* histogram, uint64_t value) {
+    histogram->buckets[getHistogramBucket(value)]++;
+    histogram->count++;
+    histogram->total += value;
+    if(value > histogram->max)
+        histogram->max = value;
+}
+/**
+ * @param histogram
+ * @param percentile in the range [0, 100]
+ * @return the largest value that could have been counted in the bucket holding the value at percentile or 0 if
+ * histogram is empty. The result is never more than max
+ */
+uint64_t getHistogramPercentile(const Histogram* histogram, double percentile);
+/**
+ * @param histogram
+ * @return the average of the recorded values or 0 if there are none
+ */
+uint64_t getHistogramMean(const Histogram* histogram);
+/**
+ * Forgets all recorded values
+ * @param histogram
+ */
+void clearHistogram(Histogram* histogram);
+#endif
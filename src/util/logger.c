@@ -1,35 +1,74 @@
 #include <assert.h>
+#include <stdarg.h>
 #include <stdio.h>
 #include <unistd.h>
 
 #include "../globals.h"
 #include "../system.h"
 #include "../xevent.h"
-#include "arraylist.h"
+#include "flight-recorder.h"
 #include "logger.h"
 
 static LogLevel LOG_LEVEL = 0;
+/// only warnings and errors are recorded by default so hot INFO messages don't pay for recording
+static LogLevel FLIGHT_RECORDER_LEVEL = LOG_LEVEL_WARN;
+LogLevel minLogLevel = 0;
 
+static void updateMinLogLevel(void) {
+    minLogLevel = LOG_LEVEL < FLIGHT_RECORDER_LEVEL ? LOG_LEVEL : FLIGHT_RECORDER_LEVEL;
+}
 LogLevel getLogLevel() {
     return LOG_LEVEL;
 }
 void setLogLevel(LogLevel level) {
     LOG_LEVEL = level;
+    updateMinLogLevel();
+}
+LogLevel getFlightRecorderLevel() {
+    return FLIGHT_RECORDER_LEVEL;
+}
+void setFlightRecorderLevel(LogLevel level) {
+    FLIGHT_RECORDER_LEVEL = level;
+    updateMinLogLevel();
 }
 
-ArrayList context;
+void _logMessage(LogLevel level, const char* format, ...) {
+    va_list args;
+    if(level >= FLIGHT_RECORDER_LEVEL) {
+        va_start(args, format);
+        recordLogMessage(level, format, args);
+        va_end(args);
+    }
+    if(isLogging(level)) {
+        printContextStr();
+        va_start(args, format);
+        vprintf(format, args);
+        va_end(args);
+        printf("\n");
+    }
+}
+
+/// the contexts of each thread
+static __thread const char* context[MAX_CONTEXT_DEPTH];
+static __thread int contextDepth;
 void pushContext(const char* c) {
-    addElement(&context, (char*)c);
+    if(contextDepth < MAX_CONTEXT_DEPTH)
+        context[contextDepth] = c;
+    contextDepth++;
 }
 void popContext() {
-    assert(context.size);
-    removeIndex(&context, context.size - 1);
+    assert(contextDepth);
+    contextDepth--;
+}
+const char* const* getContextStack(int* depth) {
+    *depth = contextDepth < MAX_CONTEXT_DEPTH ? contextDepth : MAX_CONTEXT_DEPTH;
+    return context;
 }
 
-int getEventQueueSize();
 void printContextStr() {
-    // TODO
     printf("%d|%04X|%04X|", RESTART_COUNTER, getCurrentSequenceNumber(), getIdleCount());
-    for(int i = 0; i < context.size; i++)
-        printf("[%s]", (char*)getElement(&context, i));
+    int depth;
+    const char* const* stack = getContextStack(&depth);
+    for(int i = 0; i < depth; i++)
+        printf("[%s]", stack[i]);
 }
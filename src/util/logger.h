@@ -50,11 +50,8 @@ typedef enum LogLevel {
     do{if(isLogging(i)){code;}}while(0)
 
 #define _LOG(LEVEL, str...) do { \
-    if(isLogging(LEVEL)) {\
-        printContextStr();\
-        printf(str);\
-        printf("\n");\
-    }\
+    if(LOGGING && (LEVEL) >= minLogLevel) \
+        _logMessage(LEVEL, str); \
 }while(0)
 
 /// @{ Logging macros
@@ -73,11 +70,23 @@ typedef enum LogLevel {
 /// @}
 
 
+/// max number of contexts printed with a message
+#define MAX_CONTEXT_DEPTH 32
+
 /// if false then all logging will be disabled
 #ifndef LOGGING
 #define LOGGING 1
 #endif
 
+/// the lower of the log level and the flight recorder level; messages below it are dropped without a function call
+extern LogLevel minLogLevel;
+/**
+ * Records the message in the flight recorder and/or prints it depending on level
+ *
+ * @param level
+ * @param format
+ */
+void _logMessage(LogLevel level, const char* format, ...) __attribute__((__format__(__printf__, 2, 3)));
 /**
  * @return the current log level
  */
@@ -87,6 +96,15 @@ LogLevel getLogLevel();
  * @param level the new log level
  */
 void setLogLevel(LogLevel level);
+/**
+ * @return the min level of messages stored in the flight recorder
+ */
+LogLevel getFlightRecorderLevel();
+/**
+ * Sets the min level of messages stored in the flight recorder; LOG_LEVEL_NONE disables it
+ * @param level
+ */
+void setFlightRecorderLevel(LogLevel level);
 /**
  * If message at log level i will be logged
  *
@@ -108,6 +126,12 @@ void pushContext(const char* context);
  */
 void popContext();
 
+/**
+ * @param depth set to the number of contexts that have been pushed and not popped
+ * @return the contexts of the calling thread; only the first MAX_CONTEXT_DEPTH are stored
+ */
+const char* const* getContextStack(int* depth);
+
 /**
  * prints a string representation of everything on the context stack
  */
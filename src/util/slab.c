@@ -0,0 +1,76 @@
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "slab.h"
+
+/// list of slabs that have allocated memory; used for statistics
+static ArrayList slabs;
+const ArrayList* getAllSlabs(void) {
+    return &slabs;
+}
+
+static inline char* getBlock(const Slab* slab, int index) {
+    return getElement(&slab->__blocks, index);
+}
+/// the distance between consecutive objects in a block
+static inline uint32_t getSlabStride(const Slab* slab) {
+    return SLAB_HEADER_SIZE + slab->objectSize;
+}
+
+#ifndef NDEBUG
+static void poison(const Slab* slab, void* p) {
+    memset((char*)p + sizeof(void*), SLAB_POISON, slab->objectSize - sizeof(void*));
+}
+static void checkPoison(const Slab* slab, const void* p) {
+    for(uint32_t i = sizeof(void*); i < slab->objectSize; i++)
+        assert(((const unsigned char*)p)[i] == SLAB_POISON && "object was modified after being freed");
+}
+#else
+#define poison(S, P)
+#define checkPoison(S, P)
+#endif
+
+void* slabAlloc(Slab* slab) {
+    void* p;
+    if(slab->__freeList) {
+        p = slab->__freeList;
+        slab->__freeList = *(void**)p;
+        checkPoison(slab, p);
+    }
+    else {
+        if(!slab->__blocks.size || slab->__blockUsed == SLAB_BLOCK_SIZE) {
+            if(!slab->allocations)
+                addElement(&slabs, slab);
+            addElement(&slab->__blocks, malloc(SLAB_BLOCK_SIZE * getSlabStride(slab)));
+            slab->__blockUsed = 0;
+        }
+        uint32_t index = (slab->__blocks.size - 1) * SLAB_BLOCK_SIZE + slab->__blockUsed++;
+        p = getSlabObject(slab, index);
+        // the index is stored once when the slot is first handed out and stays valid as long as the block
+        *(uint32_t*)((char*)p - SLAB_HEADER_SIZE) = index;
+    }
+    memset(p, 0, slab->objectSize);
+    slab->allocations++;
+    if(++slab->used > slab->peak)
+        slab->peak = slab->used;
+    return p;
+}
+
+void slabFree(Slab* slab, void* p) {
+    assert(slab->used);
+    if(!--slab->used) {
+        while(slab->__blocks.size > 1)
+            free(pop(&slab->__blocks));
+        slab->__blockUsed = 0;
+        slab->__freeList = NULL;
+        return;
+    }
+    poison(slab, p);
+    *(void**)p = slab->__freeList;
+    slab->__freeList = p;
+}
+
+void* getSlabObject(const Slab* slab, uint32_t index) {
+    return getBlock(slab, index / SLAB_BLOCK_SIZE) + index % SLAB_BLOCK_SIZE * getSlabStride(slab) + SLAB_HEADER_SIZE;
+}
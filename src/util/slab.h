@@ -0,0 +1,91 @@
+/**
+ * @file slab.h
+ * @brief Fixed size object allocator
+ *
+ * Objects of a single type are carved out of blocks and freed objects are kept on a per type free list so
+ * creating and destroying objects doesn't fragment the heap.
+ */
+#ifndef SLAB_H
+#define SLAB_H
+
+#include <stdint.h>
+#include "arraylist.h"
+
+/// number of objects allocated at a time
+#define SLAB_BLOCK_SIZE 64
+/// bytes before each object holding its index; a multiple of the max alignment of the objects
+#define SLAB_HEADER_SIZE 8
+
+/**
+ * Allocator for objects of a single size.
+ * Should be created with the SLAB macro.
+ *
+ * In debug builds freed objects are filled with SLAB_POISON and checked when they are reused to detect writes after
+ * free.
+ */
+typedef struct Slab {
+    /// name of the type being allocated; used for statistics
+    const char* name;
+    /// size of each object
+    uint32_t objectSize;
+    /// number of objects currently in use
+    uint32_t used;
+    /// the max value used has reached
+    uint32_t peak;
+    /// the total number of calls to slabAlloc
+    uint32_t allocations;
+    /// blocks of SLAB_BLOCK_SIZE objects
+    ArrayList __blocks;
+    /// number of objects handed out from the newest block
+    uint32_t __blockUsed;
+    /// singly linked list of freed objects
+    void* __freeList;
+} Slab;
+
+/// byte freed objects are filled with in debug builds
+#define SLAB_POISON 0xDB
+
+/// Creates an empty Slab for TYPE
+#define SLAB(TYPE) {.name = #TYPE, .objectSize = sizeof(TYPE) < sizeof(void*) ? sizeof(void*) : sizeof(TYPE)}
+
+/**
+ * @param slab
+ * @return a zeroed object
+ */
+void* slabAlloc(Slab* slab);
+/**
+ * Returns p to slab.
+ * Once every object has been freed, all but the first block is released so a slab that keeps going between 0 and a
+ * few objects doesn't allocate
+ *
+ * @param slab the slab p was allocated from
+ * @param p
+ */
+void slabFree(Slab* slab, void* p);
+/**
+ * @param slab
+ * @param p an object allocated from slab
+ * @return an index unique among the objects currently allocated from the slab; indexes of freed objects are reused
+ */
+static inline uint32_t getSlabIndex(const Slab* slab, const void* p) {
+    return *(const uint32_t*)((const char*)p - SLAB_HEADER_SIZE);
+}
+/**
+ * The inverse of getSlabIndex
+ * @param slab
+ * @param index an index less than getSlabCapacity
+ * @return the object at index; it may not currently be allocated
+ */
+void* getSlabObject(const Slab* slab, uint32_t index);
+/**
+ * @param slab
+ * @return the number of objects slab has space for without allocating more memory
+ */
+static inline uint32_t getSlabCapacity(const Slab* slab) {
+    return slab->__blocks.size * SLAB_BLOCK_SIZE;
+}
+/**
+ * @return a list of every Slab that has ever allocated memory
+ */
+const ArrayList* getAllSlabs(void);
+#endif
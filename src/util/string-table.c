@@ -0,0 +1,102 @@
+#include <assert.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hashmap.h"
+#include "string-table.h"
+
+/// Header stored in front of every interned string
+typedef struct InternedString {
+    /// next string in the table with the same hash
+    struct InternedString* next;
+    uint32_t hash;
+    /// number of outstanding internString calls
+    uint32_t refs;
+    char str[];
+} InternedString;
+
+/// map of hashes to the chain of strings with that hash
+static HashMap stringTable;
+static uint32_t numberOfStrings;
+/// the empty string is never stored in the table and can't be freed
+static const char emptyString[1];
+/// the last string returned from the table; lets repeated lookups of an interned string skip hashing
+static const char* lastString;
+
+static inline InternedString* getHeader(const char* str) {
+    return (InternedString*)(str - offsetof(InternedString, str));
+}
+
+static uint32_t hashString(const char* str) {
+    // FNV-1a
+    uint32_t hash = 2166136261U;
+    for(; *str; str++)
+        hash = (hash ^ (uint8_t) * str) * 16777619U;
+    return hash;
+}
+
+static InternedString* findString(const char* str, uint32_t hash) {
+    for(InternedString* entry = getValue(&stringTable, hash); entry; entry = entry->next)
+        if(strcmp(entry->str, str) == 0)
+            return entry;
+    return NULL;
+}
+
+const char* findInternedString(const char* str) {
+    if(str == lastString)
+        return str;
+    if(!str[0])
+        return emptyString;
+    InternedString* entry = findString(str, hashString(str));
+    return entry ? lastString = entry->str : NULL;
+}
+
+const char* internString(const char* str) {
+    if(!str[0])
+        return emptyString;
+    uint32_t hash = hashString(str);
+    InternedString* entry = findString(str, hash);
+    if(!entry) {
+        size_t len = strlen(str);
+        entry = malloc(sizeof(InternedString) + len + 1);
+        entry->next = getValue(&stringTable, hash);
+        entry->hash = hash;
+        entry->refs = 0;
+        memcpy(entry->str, str, len + 1);
+        putValue(&stringTable, hash, entry);
+        numberOfStrings++;
+    }
+    entry->refs++;
+    return lastString = entry->str;
+}
+
+void releaseString(const char* str) {
+    if(!str || str == emptyString)
+        return;
+    InternedString* entry = getHeader(str);
+    assert(entry->refs);
+    if(--entry->refs)
+        return;
+    InternedString* head = getValue(&stringTable, entry->hash);
+    if(head == entry) {
+        if(entry->next)
+            putValue(&stringTable, entry->hash, entry->next);
+        else
+            removeKey(&stringTable, entry->hash);
+    }
+    else {
+        while(head->next != entry)
+            head = head->next;
+        head->next = entry->next;
+    }
+    if(lastString == entry->str)
+        lastString = NULL;
+    free(entry);
+    if(!--numberOfStrings)
+        clearMap(&stringTable);
+}
+
+uint32_t getNumberOfInternedStrings(void) {
+    return numberOfStrings;
+}
@@ -0,0 +1,48 @@
+/**
+ * @file string-table.h
+ * @brief Table of interned strings
+ *
+ * Equal strings that have been interned share the same pointer so they can be compared with ==.
+ */
+#ifndef STRING_TABLE_H
+#define STRING_TABLE_H
+
+#include <stdint.h>
+
+/**
+ * Returns the shared copy of str, adding it to the table if needed.
+ * The returned string is immutable and has to be released with releaseString
+ *
+ * @param str
+ * @return the interned copy of str
+ */
+const char* internString(const char* str);
+/**
+ * Like internString except the table isn't modified and the reference count is not incremented
+ *
+ * @param str
+ * @return the interned copy of str or NULL if str hasn't been interned
+ */
+const char* findInternedString(const char* str);
+/**
+ * Drops a reference to str; the string is freed once all references are released
+ *
+ * @param str a string returned from internString or NULL
+ */
+void releaseString(const char* str);
+/**
+ * Points dest at the interned copy of str and releases the string dest previously held
+ *
+ * @param dest
+ * @param str
+ */
+static inline void replaceInternedString(const char** dest, const char* str) {
+    const char* old = *dest;
+    *dest = internString(str);
+    releaseString(old);
+}
+/**
+ * @return the number of distinct strings in the table
+ */
+uint32_t getNumberOfInternedStrings(void);
+#endif
@@ -5,14 +5,24 @@
 #ifndef MPXMANAGER_TIME_H_
 #define MPXMANAGER_TIME_H_
 #include <time.h>
-#include <sys/time.h>
+#include "../mywm-structs.h"
 /**
  * Returns a monotonically increasing number that servers the time in ms.
+ * The value is unaffected by changes to the system clock and is only meaningful relative to other calls
  * @return the current time (ms)
  */
-static inline unsigned int getTime() {
-    struct timeval start;
-    gettimeofday(&start, NULL);
-    return start.tv_sec * 1000 + start.tv_usec * 1e-3;
+static inline TimeStamp getTime() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000UL + now.tv_nsec / 1000000;
+}
+/**
+ * Like getTime but with nanosecond resolution
+ * @return the current time (ns)
+ */
+static inline TimeStamp getTimeNs() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000000UL + now.tv_nsec;
 }
 #endif
@@ -0,0 +1,87 @@
+#include <stdio.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "logger.h"
+#include "timeline.h"
+
+bool timelineEnabled;
+static FILE* timelineFile;
+static int pid;
+/// the kernel thread id of the calling thread
+static __thread int tid;
+
+static inline int getTid(void) {
+    if(!tid)
+        tid = syscall(SYS_gettid);
+    return tid;
+}
+
+/// Writes str as a JSON string
+static void writeString(const char* str) {
+    fputc('"', timelineFile);
+    for(; *str; str++) {
+        if(*str == '"' || *str == '\\')
+            fputc('\\', timelineFile);
+        if((unsigned char)*str < ' ')
+            fprintf(timelineFile, "\\u%04x", *str);
+        else
+            fputc(*str, timelineFile);
+    }
+    fputc('"', timelineFile);
+}
+/// Starts a new event; every event is preceded by a comma since the file starts with a metadata event
+static void writeEventStart(const char* name, const char* phase, TimeStamp time) {
+    fputs(",\n{\"name\":", timelineFile);
+    writeString(name);
+    fprintf(timelineFile, ",\"ph\":\"%s\",\"ts\":%lu.%03lu,\"pid\":%d,\"tid\":%d", phase, time / 1000, time % 1000,
+        pid, getTid());
+}
+
+bool startTimeline(const char* path) {
+    stopTimeline();
+    timelineFile = fopen(path, "w");
+    if(!timelineFile) {
+        WARN("Could not open timeline file '%s'", path);
+        return 0;
+    }
+    pid = getpid();
+    fprintf(timelineFile, "[{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%d,\"args\":{\"name\":\"mpxmanager\"}}",
+        pid);
+#ifndef NO_TIMELINE
+    timelineEnabled = 1;
+#endif
+    return 1;
+}
+
+void stopTimeline(void) {
+    if(!timelineFile)
+        return;
+#ifndef NO_TIMELINE
+    timelineEnabled = 0;
+#endif
+    fputs("\n]\n", timelineFile);
+    fclose(timelineFile);
+    timelineFile = NULL;
+}
+
+void addTimelineSpan(const char* name, const char* category, TimeStamp start, TimeStamp end) {
+    // the timeline may have been stopped while the span was open
+    if(!timelineFile)
+        return;
+    flockfile(timelineFile);
+    writeEventStart(name, "X", start);
+    fprintf(timelineFile, ",\"dur\":%lu.%03lu,\"cat\":", (end - start) / 1000, (end - start) % 1000);
+    writeString(category);
+    fputc('}', timelineFile);
+    funlockfile(timelineFile);
+}
+
+void addTimelineCounter(const char* name, int64_t value) {
+    if(!timelineFile)
+        return;
+    flockfile(timelineFile);
+    writeEventStart(name, "C", getTimeNs());
+    fprintf(timelineFile, ",\"args\":{\"value\":%ld}}", value);
+    funlockfile(timelineFile);
+}
@@ -0,0 +1,68 @@
+/**
+ * @file timeline.h
+ * @brief Writes spans and counters as Chrome/Perfetto trace event JSON
+ *
+ * The output can be loaded in chrome://tracing or https://ui.perfetto.dev to see which rules ran for each event,
+ * where the WM blocked on X and how IDLE batches interleave with input.
+ * Nothing is recorded unless a timeline has been started and all hooks compile out when NO_TIMELINE is defined.
+ */
+#ifndef MPX_TIMELINE_H_
+#define MPX_TIMELINE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "../mywm-structs.h"
+#include "time.h"
+
+#ifndef NO_TIMELINE
+/// set while a timeline is being written
+extern bool timelineEnabled;
+static inline bool isTimelineEnabled(void) {
+    return timelineEnabled;
+}
+#else
+#define isTimelineEnabled() 0
+#endif
+
+/**
+ * @return the start time to pass to TIMELINE_SPAN_END or 0 if no timeline is being written
+ */
+#define TIMELINE_SPAN_START() (isTimelineEnabled() ? getTimeNs() : 0)
+/**
+ * Adds a span from START until now if START is non zero
+ * @param START the value of TIMELINE_SPAN_START
+ * @param NAME the name of the span; must be valid until the timeline is stopped
+ * @param CATEGORY
+ */
+#define TIMELINE_SPAN_END(START, NAME, CATEGORY) \
+    do {if(START) addTimelineSpan(NAME, CATEGORY, START, getTimeNs());} while(0)
+
+/**
+ * Starts writing a timeline to path; any timeline being written is stopped first
+ *
+ * @param path
+ * @return true if path could be opened
+ */
+bool startTimeline(const char* path);
+/**
+ * Finishes the JSON and closes the file; does nothing if no timeline is being written
+ */
+void stopTimeline(void);
+/**
+ * Adds a complete span
+ *
+ * @param name
+ * @param category
+ * @param start time (ns)
+ * @param end time (ns)
+ */
+void addTimelineSpan(const char* name, const char* category, TimeStamp start, TimeStamp end);
+/**
+ * Adds a sample of a counter that will be graphed over time
+ *
+ * @param name
+ * @param value
+ */
+void addTimelineCounter(const char* name, int64_t value);
+#endif
@@ -0,0 +1,139 @@
+/**
+ * @file vector.h
+ * @brief Typed dynamic arrays that store their elements inline
+ *
+ * Unlike ArrayList, elements aren't pointers to separately allocated objects so iterating doesn't chase pointers and
+ * comparisons don't dereference elements.
+ *
+ * DECLARE_VECTOR(int, IntVector) declares the type IntVector and functions named IntVectorAdd, IntVectorInsert etc.
+ * A zero-initialized vector is a valid empty vector.
+ */
+#ifndef VECTOR_H
+#define VECTOR_H
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Iterates over every element of VEC; VAR is a pointer to the current element
+ */
+#define FOR_EACH_VECTOR(TYPE, VAR, VEC) for(TYPE* VAR = (VEC)->data; VAR < (VEC)->data + (VEC)->size; VAR++)
+
+#define __VAR_CAT_HELPER(x, y) x##y
+#define __VAR_CAT(x, y) __VAR_CAT_HELPER(x, y)
+/**
+ * Like FOR_EACH but for vectors; VAR is a copy of the current element
+ */
+#define FOR_EACH_VALUE(TYPE, VAR, VEC) int __VAR_CAT(__i, __LINE__) = 0;\
+    for(TYPE VAR; __VAR_CAT(__i, __LINE__) < (VEC)->size && (VAR = (VEC)->data[__VAR_CAT(__i, __LINE__)], 1); \
+        __VAR_CAT(__i, __LINE__)++)
+/**
+ * Like FOR_EACH_R but for vectors; VAR is a copy of the current element
+ */
+#define FOR_EACH_VALUE_R(TYPE, VAR, VEC) int __VAR_CAT(__i, __LINE__) = (VEC)->size;\
+    for(TYPE VAR; --__VAR_CAT(__i, __LINE__) >= 0 && (VAR = (VEC)->data[__VAR_CAT(__i, __LINE__)], 1);)
+
+/**
+ * Declares a vector named NAME of TYPE.
+ */
+#define DECLARE_VECTOR(TYPE, NAME) \
+    typedef struct NAME { \
+        TYPE* data; \
+        int size; \
+        int capacity; \
+    } NAME; \
+    /** Ensures that there is space for at least capacity elements */ \
+    static inline void NAME##Reserve(NAME* vec, int capacity) { \
+        if(capacity > vec->capacity) { \
+            vec->capacity = capacity; \
+            vec->data = realloc(vec->data, sizeof(TYPE) * capacity); \
+        } \
+    } \
+    static inline TYPE* NAME##Get(const NAME* vec, int index) { \
+        assert(index >= 0 && index < vec->size); \
+        return &vec->data[index]; \
+    } \
+    /** Inserts value at index, shifting all later elements back */ \
+    static inline TYPE* NAME##Insert(NAME* vec, int index, TYPE value) { \
+        assert(index >= 0 && index <= vec->size); \
+        if(vec->size == vec->capacity) \
+            NAME##Reserve(vec, vec->capacity ? vec->capacity * 2 : 16); \
+        memmove(&vec->data[index + 1], &vec->data[index], sizeof(TYPE) * (vec->size - index)); \
+        vec->data[index] = value; \
+        vec->size++; \
+        return &vec->data[index]; \
+    } \
+    static inline TYPE* NAME##Add(NAME* vec, TYPE value) { \
+        return NAME##Insert(vec, vec->size, value); \
+    } \
+    /** Removes the element at index preserving the order of the remaining elements */ \
+    static inline TYPE NAME##RemoveIndex(NAME* vec, int index) { \
+        TYPE value = *NAME##Get(vec, index); \
+        memmove(&vec->data[index], &vec->data[index + 1], sizeof(TYPE) * (vec->size - index - 1)); \
+        vec->size--; \
+        return value; \
+    } \
+    /** Moves the element at index to endingPos, shifting the elements in between by one */ \
+    static inline void NAME##Move(NAME* vec, int index, int endingPos) { \
+        TYPE value = *NAME##Get(vec, index); \
+        assert(endingPos >= 0 && endingPos < vec->size); \
+        if(index > endingPos) \
+            memmove(&vec->data[endingPos + 1], &vec->data[endingPos], sizeof(TYPE) * (index - endingPos)); \
+        else \
+            memmove(&vec->data[index], &vec->data[index + 1], sizeof(TYPE) * (endingPos - index)); \
+        vec->data[endingPos] = value; \
+    } \
+    /** Removes the element at index in O(1) by replacing it with the last element */ \
+    static inline TYPE NAME##SwapRemove(NAME* vec, int index) { \
+        TYPE value = *NAME##Get(vec, index); \
+        vec->data[index] = vec->data[--vec->size]; \
+        return value; \
+    } \
+    /** @return the index of the element p points to or -1 if p doesn't point into vec */ \
+    static inline int NAME##IndexOfPtr(const NAME* vec, TYPE const* p) { \
+        return p >= vec->data && p < vec->data + vec->size ? p - vec->data : -1; \
+    } \
+    /** Frees the memory backing vec */ \
+    static inline void NAME##Clear(NAME* vec) { \
+        free(vec->data); \
+        vec->data = NULL; \
+        vec->size = 0; \
+        vec->capacity = 0; \
+    }
+
+/**
+ * Declares a vector named NAME of TYPE, where TYPE can be compared with == and <, and
+ * adds search functions to it
+ */
+#define DECLARE_SCALAR_VECTOR(TYPE, NAME) \
+    DECLARE_VECTOR(TYPE, NAME) \
+    /** @return the first index of value or -1 */ \
+    static inline int NAME##IndexOf(const NAME* vec, TYPE value) { \
+        for(int i = 0; i < vec->size; i++) \
+            if(vec->data[i] == value) \
+                return i; \
+        return -1; \
+    } \
+    /** @return the index of the first element of a sorted vector that is not less than value */ \
+    static inline int NAME##LowerBound(const NAME* vec, TYPE value) { \
+        int low = 0, high = vec->size; \
+        while(low < high) { \
+            int mid = (low + high) / 2; \
+            if(vec->data[mid] < value) \
+                low = mid + 1; \
+            else \
+                high = mid; \
+        } \
+        return low; \
+    } \
+    /** @return the index of value in a sorted vector or -1 */ \
+    static inline int NAME##BinarySearch(const NAME* vec, TYPE value) { \
+        int index = NAME##LowerBound(vec, value); \
+        return index < vec->size && vec->data[index] == value ? index : -1; \
+    } \
+    /** Inserts value into a sorted vector keeping it sorted */ \
+    static inline TYPE* NAME##InsertSorted(NAME* vec, TYPE value) { \
+        return NAME##Insert(vec, NAME##LowerBound(vec, value), value); \
+    }
+#endif
@@ -6,9 +6,13 @@
 #include "globals.h"
 #include "masters.h"
 #include "user-events.h"
+#include "util/hashmap.h"
 #include "util/logger.h"
+#include "util/slab.h"
+#include "util/string-table.h"
 #include "windows.h"
 #include "workspaces.h"
+#include "xutil/window-properties.h"
 
 
 ///list of all windows
@@ -16,22 +20,81 @@ static ArrayList windows;
 const ArrayList* getAllWindows(void) {
     return &windows;
 }
+/// index of windows by id
+static HashMap windowMap;
+WindowInfo* getWindowInfo(WindowID win) {
+    return getValue(&windowMap, win);
+}
+
+/// allocator for WindowInfo; the slab index of a WindowInfo is its slot
+static Slab windowSlab = SLAB(WindowInfo);
+/// blocks of SLAB_BLOCK_SIZE WindowProperties indexed by slot
+static ArrayList propertyBlocks;
+
+/// number of slots covered by a word of maskIndex
+#define MASK_INDEX_WORD_BITS 64
+/// per mask bit sets of window slots; the word for slots [i * 64, i * 64 + 64) of bit b is at i * NUM_WINDOW_MASKS + b
+static uint64_t* maskIndex;
+/// number of words in maskIndex per mask bit
+static uint32_t maskIndexWords;
+/// number of windows with each mask bit
+static uint32_t maskCounts[NUM_WINDOW_MASKS];
+
+static WindowInfo* allocWindowInfo(void) {
+    WindowInfo* winInfo = slabAlloc(&windowSlab);
+    *(uint32_t*)&winInfo->slot = getSlabIndex(&windowSlab, winInfo);
+    if(winInfo->slot / SLAB_BLOCK_SIZE == propertyBlocks.size)
+        addElement(&propertyBlocks, malloc(SLAB_BLOCK_SIZE * sizeof(WindowProperties)));
+    if(winInfo->slot / MASK_INDEX_WORD_BITS == maskIndexWords) {
+        maskIndex = realloc(maskIndex, ++maskIndexWords * NUM_WINDOW_MASKS * sizeof(uint64_t));
+        memset(maskIndex + (maskIndexWords - 1) * NUM_WINDOW_MASKS, 0, NUM_WINDOW_MASKS * sizeof(uint64_t));
+    }
+    return winInfo;
+}
+static void freeWindowInfoMemory(WindowInfo* winInfo) {
+    slabFree(&windowSlab, winInfo);
+    // like the slab, keep the memory for the first block of slots
+    if(!windowSlab.used && propertyBlocks.size > 1) {
+        while(propertyBlocks.size > 1)
+            free(pop(&propertyBlocks));
+        maskIndexWords = 1;
+        maskIndex = realloc(maskIndex, maskIndexWords * NUM_WINDOW_MASKS * sizeof(uint64_t));
+    }
+}
+
+WindowProperties* getWindowProperties(const WindowInfo* winInfo) {
+    return (WindowProperties*)getElement(&propertyBlocks, winInfo->slot / SLAB_BLOCK_SIZE) + winInfo->slot %
+        SLAB_BLOCK_SIZE;
+}
 
 WindowInfo* newWindowInfo(WindowID id, WindowID parent) {
-    WindowInfo* winInfo = malloc(sizeof(WindowInfo));
-    WindowInfo temp = {.id = id, .parent = parent};
+    WindowInfo* winInfo = allocWindowInfo();
+    WindowInfo temp = {.id = id, .parent = parent, .workspaceIndex = NO_WORKSPACE, .slot = winInfo->slot};
     memmove(winInfo, &temp, sizeof(WindowInfo));
+    WindowProperties* properties = getWindowProperties(winInfo);
+    memset(properties, 0, sizeof(WindowProperties));
+    properties->typeName = properties->className = properties->instanceName = properties->role = internString("");
     addElement(&windows, winInfo);
+    putValue(&windowMap, id, winInfo);
     return winInfo;
 }
 
 void freeWindowInfo(WindowInfo* winInfo) {
-    FOR_EACH(Master*, master, getAllMasters()) {
-        removeWindowFromFocusStack(master, winInfo->id);
-    }
+    removeWindowFromAllFocusStacks(winInfo);
     removeFromWorkspace(winInfo);
-    removeElement(&windows, winInfo, sizeof(WindowID));
-    free(winInfo);
+    setWindowMask(winInfo, 0);
+    removeIndex(&windows, getIndexOfPtr(&windows, winInfo));
+    removeKey(&windowMap, winInfo->id);
+    WindowProperties* properties = getWindowProperties(winInfo);
+    releaseString(properties->typeName);
+    releaseString(properties->className);
+    releaseString(properties->instanceName);
+    releaseString(properties->role);
+    if(winInfo->pendingProperties)
+        discardWindowPropertyCookies(winInfo->pendingProperties);
+    if(!windowMap.size)
+        clearMap(&windowMap);
+    freeWindowInfoMemory(winInfo);
 }
 
 bool isNotInInvisibleWorkspace(WindowInfo* winInfo) {
@@ -44,8 +107,10 @@ void removeFromWorkspace(WindowInfo* winInfo) {
     Workspace* w = getWorkspaceOfWindow(winInfo);
     if(w) {
         applyEventRules(WORKSPACE_WINDOW_REMOVE, winInfo);
-        removeIndex(getWorkspaceWindowStack(w), getIndex(getWorkspaceWindowStack(w), &winInfo->id, sizeof(WindowID)));
+        WindowStackRemoveIndex(getWorkspaceWindowStack(w), WindowStackIndexOf(getWorkspaceWindowStack(w), winInfo));
+        updateWorkspaceMaskCounts(w, winInfo->mask, -1);
     }
+    winInfo->workspaceIndex = NO_WORKSPACE;
 }
 
 void moveToWorkspace(WindowInfo* winInfo, WorkspaceID destIndex) {
@@ -59,7 +124,9 @@ void moveToWorkspace(WindowInfo* winInfo, WorkspaceID destIndex) {
     if(destIndex != getWorkspaceIndexOfWindow(winInfo)) {
         DEBUG("Moving %d to workspace %d from %d", winInfo->id, destIndex, getWorkspaceIndexOfWindow(winInfo));
         removeFromWorkspace(winInfo);
-        addElement(&getWorkspace(destIndex)->windows, winInfo);
+        WindowStackAdd(&getWorkspace(destIndex)->windows, winInfo);
+        winInfo->workspaceIndex = destIndex;
+        updateWorkspaceMaskCounts(getWorkspace(destIndex), winInfo->mask, 1);
         applyEventRules(WORKSPACE_WINDOW_ADD, winInfo);
     }
 }
@@ -92,6 +159,43 @@ WindowMask getEffectiveMask(const WindowInfo* winInfo) {
     return mask;
 }
 
+void setWindowMask(WindowInfo* winInfo, WindowMask mask) {
+    WindowMask changed = winInfo->mask ^ mask;
+    Workspace* workspace = getWorkspaceOfWindow(winInfo);
+    if(workspace) {
+        updateWorkspaceMaskCounts(workspace, changed & winInfo->mask, -1);
+        updateWorkspaceMaskCounts(workspace, changed & mask, 1);
+    }
+    uint64_t* words = maskIndex + winInfo->slot / MASK_INDEX_WORD_BITS * NUM_WINDOW_MASKS;
+    uint64_t slotBit = 1ULL << winInfo->slot % MASK_INDEX_WORD_BITS;
+    for(; changed; changed &= changed - 1) {
+        int i = __builtin_ctz(changed);
+        words[i] ^= slotBit;
+        maskCounts[i] += mask & 1U << i ? 1 : -1;
+    }
+    winInfo->mask = mask;
+}
+
+uint32_t getNumberOfWindowsWithMask(WindowMask mask) {
+    assert(mask && !(mask & (mask - 1)));
+    return maskCounts[__builtin_ctz(mask)];
+}
+
+WindowInfo* getNextWindowWithMask(WindowMask mask, uint32_t* slot) {
+    assert(mask && !(mask & (mask - 1)));
+    int bit = __builtin_ctz(mask);
+    for(uint32_t i = *slot / MASK_INDEX_WORD_BITS; i < maskIndexWords; i++) {
+        uint64_t word = maskIndex[i * NUM_WINDOW_MASKS + bit];
+        if(i == *slot / MASK_INDEX_WORD_BITS)
+            word &= ~0ULL << *slot % MASK_INDEX_WORD_BITS;
+        if(word) {
+            *slot = i * MASK_INDEX_WORD_BITS + __builtin_ctzll(word);
+            return getSlabObject(&windowSlab, *slot);
+        }
+    }
+    return NULL;
+}
+
 WindowMask getMasksToSync(WindowInfo* winInfo) {
     return hasMask(winInfo, SYNC_ALL_MASKS) ? (WindowMask) ~EXTERNAL_MASKS : MASKS_TO_SYNC;
 }
@@ -27,7 +27,33 @@ typedef struct DockProperties {
     uint16_t end;
 } DockProperties;
 
-///holds data on a window
+/**
+ * String metadata about a window.
+ * It is only read when matching/printing windows so it is stored apart from WindowInfo
+ *
+ * All fields except the title are interned (see util/string-table.h) so they can be compared by pointer and
+ * must be set with replaceInternedString
+ * @see getWindowProperties
+ */
+typedef struct WindowProperties {
+    /**string xcb_atom representing the window type*/
+    const char* typeName;
+    /**class name of window*/
+    const char* className;
+    /** instance name of window*/
+    const char* instanceName;
+    /** Application specified role of the window*/
+    const char* role;
+    /**title of window*/
+    char title[MAX_NAME_LEN];
+} WindowProperties;
+
+/**
+ * holds data on a window
+ *
+ * Only fields that are frequently read are stored here and all WindowInfos are allocated from a dense table so
+ * scanning the masks/geometry of every window touches as little memory as possible.
+ */
 struct WindowInfo {
     const WindowID id;
     /// the parent of this window
@@ -45,6 +71,10 @@ struct WindowInfo {
      */
     WindowMask mask;
     WindowMask savedMask;
+    /// the Workspace this window is in or NO_WORKSPACE
+    WorkspaceID workspaceIndex;
+    /** The last know size of the window */
+    Rect geometry;
     /// set to 1 iff the window is a dock
     bool dock;
     /// 1 iff override_redirect flag set
@@ -55,20 +85,11 @@ struct WindowInfo {
     bool implicitType;
     /// the window won't/cannot be fully managed
     bool notManageable;
+    /// WM_DELETE_WINDOW is in the window's WM_PROTOCOLS
+    bool supportsDeleteWindow;
     /**xcb_atom representing the window type*/
     uint32_t type;
 
-    /**string xcb_atom representing the window type*/
-    char typeName[MAX_NAME_LEN];
-    /**class name of window*/
-    char className[MAX_NAME_LEN];
-    /** instance name of window*/
-    char instanceName[MAX_NAME_LEN];
-    /**title of window*/
-    char title[MAX_NAME_LEN];
-    /** Application specified role of the window*/
-    char role[MAX_NAME_LEN];
-
     ///time the window was last pinged
     TimeStamp pingTimeStamp;
     /// the time the window was created or 0, if it existed before us
@@ -88,9 +109,17 @@ struct WindowInfo {
     Rect tilingOverride;
     uint16_t tilingOverrideBorder;
     uint8_t tilingOverridePercent;
-    /** The last know size of the window */
-    Rect geometry;
     DockProperties dockProperties;
+    /// index of this window in the window tables; stable for the lifetime of the window
+    const uint32_t slot;
+    /// list of nodes of the focus stacks containing this window
+    FocusNode* focusNodes;
+    /// property requests sent ahead of time whose replies haven't been collected yet
+    struct WindowPropertyCookies* pendingProperties;
+    /// the x, y, width, height and border width last sent by configureWindowInfo
+    short sentConfig[5];
+    /// bitmask of the XCB_CONFIG_WINDOW_* values of sentConfig that are known to still be in effect
+    uint8_t sentConfigMask;
 };
 static inline void setGeometry(WindowInfo* winInfo, const short* s) { winInfo->geometry = *(Rect*)s;}
 
@@ -104,6 +133,10 @@ WindowInfo* newWindowInfo(WindowID id, WindowID parent);
  * Removes this window from Workspace & Master stack(s)
  */
 void freeWindowInfo(WindowInfo* winInfo);
+/**
+ * @return the string metadata of winInfo
+ */
+WindowProperties* getWindowProperties(const WindowInfo* winInfo);
 
 static inline bool isOverrideRedirectWindow(WindowInfo* winInfo) {return winInfo->overrideRedirect;};
 static inline bool isInputOnlyWindow(WindowInfo* winInfo) {return winInfo->inputOnly;};
@@ -209,6 +242,28 @@ void setDockProperties(WindowInfo* winInfo, int* properties, bool partial);
 
 WindowMask getEffectiveMask(const WindowInfo* winInfo);
 
+/**
+ * Unlike hasMask, only the window's own mask is considered; workspace masks are ignored
+ * @param mask a single mask bit
+ * @return the number of windows with mask
+ */
+uint32_t getNumberOfWindowsWithMask(WindowMask mask);
+/**
+ * Finds the first window, in slot order, at or after *slot whose own mask contains mask.
+ * Runs in time proportional to the number of matches instead of the number of windows.
+ *
+ * @param mask a single mask bit
+ * @param slot the slot to start searching from; set to the slot of the returned window
+ * @return the window found or NULL
+ */
+WindowInfo* getNextWindowWithMask(WindowMask mask, uint32_t* slot);
+/**
+ * Iterates over every window whose own mask contains the single bit MASK.
+ * Windows may gain or lose masks while iterating
+ */
+#define FOR_EACH_WINDOW_WITH_MASK(VAR, MASK) uint32_t __VAR_CAT(__slot, __LINE__) = 0;\
+    for(WindowInfo* VAR; (VAR = getNextWindowWithMask(MASK, &__VAR_CAT(__slot, __LINE__))); __VAR_CAT(__slot, __LINE__)++)
+
 /**
  * @param mask
  * @return the intersection of mask and the window mask
@@ -233,19 +288,27 @@ static inline bool hasAndHasNotMasks(const WindowInfo* winInfo, WindowMask has,
     return hasMask(winInfo, has) && !hasPartOfMask(winInfo, hasNot);
 }
 
+/**
+ * Sets the mask of the window to mask and updates the per mask window index and workspace counters.
+ * addMask and removeMask should generally be used instead
+ * @param mask
+ */
+void setWindowMask(WindowInfo* winInfo, WindowMask mask);
 /**
  * Adds the states give by mask to the window
  * @param mask
  */
 static inline void addMask(WindowInfo* winInfo, WindowMask mask) {
-    winInfo->mask |= mask;
+    if((winInfo->mask | mask) != winInfo->mask)
+        setWindowMask(winInfo, winInfo->mask | mask);
 }
 /**
  * Removes the states give by mask from the window
  * @param mask
  */
 static inline void removeMask(WindowInfo* winInfo, WindowMask mask) {
-    winInfo->mask &= ~mask;
+    if(winInfo->mask & mask)
+        setWindowMask(winInfo, winInfo->mask & ~mask);
 }
 /**
  * Adds or removes the mask depending if the window already contains
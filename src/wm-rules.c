@@ -12,6 +12,7 @@
 #include "time.h"
 #include "user-events.h"
 #include "util/logger.h"
+#include "util/string-table.h"
 #include "windows.h"
 #include "wm-rules.h"
 #include "wmfunctions.h"
@@ -69,7 +70,10 @@ void onHierarchyChangeEvent(xcb_input_hierarchy_event_t* event) {
 void onConfigureNotifyEvent(xcb_configure_notify_event_t* event) {
     WindowInfo* winInfo = getWindowInfo(event->window);
     if(winInfo) {
+        if(winInfo->pendingProperties)
+            discardPrefetchedGeometry(winInfo->pendingProperties);
         setGeometry(winInfo, &event->x);
+        clearStaleSentConfig(winInfo, &event->x);
         applyEventRules(WINDOW_MOVE, winInfo);
     }
     if(event->window == root) {
@@ -93,7 +97,11 @@ void onCreateEvent(xcb_create_notify_event_t* event) {
     }
     if(registerWindow(event->window, event->parent, NULL)) {
         WindowInfo* winInfo = getWindowInfo(event->window);
+        // we are now listening for property changes so the prefetched replies can be kept up to date
+        if(!winInfo->overrideRedirect)
+            winInfo->pendingProperties = prefetchWindowProperties(winInfo->id);
         setGeometry(winInfo, &event->x);
+        clearStaleSentConfig(winInfo, &event->x);
         applyEventRules(WINDOW_MOVE, winInfo);
         if(!hasMask(winInfo, ABOVE_MASK))
             raiseWindowInfo(winInfo, 0);
@@ -176,12 +184,17 @@ void onMapRequestEvent(xcb_map_request_event_t* event) {
 
 void onPropertyEvent(xcb_property_notify_event_t* event) {
     WindowInfo* winInfo = getWindowInfo(event->window);
+    if(winInfo && winInfo->pendingProperties)
+        refreshStaleWindowPropertyCookie(winInfo->pendingProperties, winInfo->id, event->atom,
+            ((xcb_generic_event_t*)event)->full_sequence);
     // only reload properties if a window is mapped
     if(winInfo && hasMask(winInfo, MAPPED_MASK)) {
         if(event->atom == ewmh->_NET_WM_NAME || event->atom == XCB_ATOM_WM_NAME)
-            getWindowTitle(winInfo->id, winInfo->title);
+            getWindowTitle(winInfo->id, getWindowProperties(winInfo)->title);
         else if(event->atom == XCB_ATOM_WM_HINTS)
             loadWindowHints(winInfo);
+        else if(event->atom == ewmh->WM_PROTOCOLS)
+            loadWindowProtocols(winInfo);
     }
 }
 bool onSelectionClearEvent(xcb_selection_clear_event_t* event) {
@@ -248,7 +261,7 @@ void updateAllWindowWorkspaceState(int unmapped) {
     for (int i = 0; i < 2; i++) {
         FOR_EACH(Workspace*, workspace, getAllWorkspaces()) {
             if(isWorkspaceVisible(workspace) == !unmapped) {
-                FOR_EACH(WindowInfo*, winInfo, getWorkspaceWindowStack(workspace)) {
+                FOR_EACH_VALUE(WindowInfo*, winInfo, getWorkspaceWindowStack(workspace)) {
                     // unmap obscured windows first
                     if(i == isVisible(winInfo))
                         updateWindowWorkspaceState(winInfo);
@@ -285,37 +298,46 @@ void assignDefaultLayoutsToWorkspace() {
     }
 }
 
-void loadGeometry(WindowInfo* winInfo) {
-    xcb_get_geometry_reply_t* reply = xcb_get_geometry_reply(dis, xcb_get_geometry(dis, winInfo->id), NULL);
-    if(reply) {
-        setGeometry(getWindowInfo(winInfo->id), &reply->x);
-        free(reply);
-    }
+void loadWindowPropertiesOfWindows(WindowInfo* const* windows, int num) {
+    if(!num)
+        return;
+    TRACE("loading window properties of %d windows", num);
+    WindowPropertyCookies cookies[num];
+    bool sentRequests = 0;
+    for(int i = 0; i < num; i++)
+        if(windows[i]->pendingProperties) {
+            cookies[i] = *windows[i]->pendingProperties;
+            free(windows[i]->pendingProperties);
+            windows[i]->pendingProperties = NULL;
+        }
+        else {
+            requestWindowProperties(windows[i]->id, &cookies[i]);
+            sentRequests = 1;
+        }
+    // prefetched requests were sent earlier so their round trip overlapped with other work and is not counted
+    if(sentRequests)
+        countXRoundTrip();
+    for(int i = 0; i < num; i++)
+        collectWindowProperties(windows[i], &cookies[i]);
+    // the type names depend on the replies above so any that aren't cached need a second round trip
+    xcb_get_atom_name_cookie_t typeNameCookies[num];
+    sentRequests = 0;
+    for(int i = 0; i < num; i++)
+        if(getCachedAtomName(windows[i]->type))
+            typeNameCookies[i].sequence = 0;
+        else {
+            typeNameCookies[i] = xcb_get_atom_name(dis, windows[i]->type);
+            sentRequests = 1;
+        }
+    if(sentRequests)
+        countXRoundTrip();
+    char buffer[MAX_NAME_LEN];
+    for(int i = 0; i < num; i++)
+        replaceInternedString(&getWindowProperties(windows[i])->typeName, typeNameCookies[i].sequence ?
+            getAtomNameReply(windows[i]->type, typeNameCookies[i], buffer) : getCachedAtomName(windows[i]->type));
 }
-
 void loadWindowProperties(WindowInfo* winInfo) {
-    TRACE("loading window properties %d", winInfo->id);
-    getClassInfo(winInfo->id, winInfo->className, winInfo->instanceName);
-    getWindowTitle(winInfo->id, winInfo->title);
-    xcb_window_t prop;
-    if(xcb_icccm_get_wm_transient_for_reply(dis, xcb_icccm_get_wm_transient_for(dis, winInfo->id), &prop, NULL))
-        winInfo->transientFor = prop;
-    winInfo->type = getWindowType(winInfo->id);
-    if(!winInfo->type) {
-        TRACE("could not read window type; using default based on transient being set to %d",
-            winInfo->transientFor);
-        winInfo->type = winInfo->transientFor ? ewmh->_NET_WM_WINDOW_TYPE_DIALOG : ewmh->_NET_WM_WINDOW_TYPE_NORMAL;
-        winInfo->implicitType = 1;
-    }
-    getAtomName(winInfo->type, winInfo->typeName);
-    // TODO loadProtocols(winInfo);
-    loadWindowHints(winInfo);
-    // TODO loadWindowSizeHints(winInfo);
-    getWindowPropertyString(winInfo->id, WM_WINDOW_ROLE, XCB_ATOM_STRING, winInfo->role);
-    if(winInfo->type == ewmh->_NET_WM_WINDOW_TYPE_DOCK) {
-        DEBUG("Marking window as dock");
-        winInfo->dock = 1;
-    }
+    loadWindowPropertiesOfWindows(&winInfo, 1);
 }
 
 static void setWMState(WindowInfo* winInfo) {
@@ -347,10 +369,12 @@ void addBasicRules() {
     addEvent(TRUE_IDLE, DEFAULT_EVENT(setIdleProperty, LOWER_PRIORITY));
     addEvent(IDLE, DEFAULT_EVENT(applyBatchEventRules));
     addEvent(0, DEFAULT_EVENT(logError));
+    onFocusFailure = updateFocusAfterFailure;
     addEvent(XCB_CREATE_NOTIFY, DEFAULT_EVENT(onCreateEvent));
     addEvent(XCB_DESTROY_NOTIFY, DEFAULT_EVENT(onDestroyEvent));
     addEvent(XCB_DESTROY_NOTIFY, DEFAULT_EVENT(shutdownIfPrivateWindowWasDestroyed, LOWER_PRIORITY));
-    addEvent(XCB_VISIBILITY_NOTIFY, DEFAULT_EVENT(onVisibilityEvent, HIGH_PRIORITY));
+    addEvent(XCB_VISIBILITY_NOTIFY, DEFAULT_EVENT(onVisibilityEvent, HIGH_PRIORITY,
+            .precondition = {.flags = MANAGED_WINDOWS_ONLY}));
     addEvent(XCB_UNMAP_NOTIFY, DEFAULT_EVENT(onUnmapEvent));
     addEvent(XCB_MAP_NOTIFY, DEFAULT_EVENT(onMapEvent));
     addEvent(XCB_MAP_REQUEST, DEFAULT_EVENT(onMapRequestEvent));
@@ -366,7 +390,6 @@ void addBasicRules() {
     addEvent(X_CONNECTION, DEFAULT_EVENT(assignUnusedMonitorsToWorkspaces, HIGH_PRIORITY));
     addEvent(X_CONNECTION, DEFAULT_EVENT(onXConnect, HIGH_PRIORITY));
     addEvent(CLIENT_MAP_ALLOW, DEFAULT_EVENT(loadWindowProperties, HIGHER_PRIORITY));
-    addEvent(CLIENT_MAP_ALLOW, DEFAULT_EVENT(loadGeometry, HIGHER_PRIORITY));
 
     addEvent(POST_REGISTER_WINDOW, FILTER_EVENT(listenForNonRootEventsFromWindow, HIGHER_PRIORITY));
     addBatchEvent(SCREEN_CHANGE, DEFAULT_EVENT(detectMonitors, HIGH_PRIORITY));
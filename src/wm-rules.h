@@ -10,11 +10,21 @@
 #include "mywm-structs.h"
 
 /**
- * Load various window properties
+ * Load various window properties and the geometry
  * This should be called when a window is requested to be mapped
  * @param winInfo
  */
 void loadWindowProperties(WindowInfo* winInfo);
+/**
+ * Loads the properties of num windows at once.
+ * All requests are sent before any reply is read so this costs at most two round trips no matter how many windows
+ * there are; none if the properties were prefetched and the type names are cached
+ *
+ * @param windows
+ * @param num
+ * @see loadWindowProperties
+ */
+void loadWindowPropertiesOfWindows(WindowInfo* const* windows, int num);
 
 /**
  * Adds onDeviceEvent for the appropriate rules
@@ -15,6 +15,7 @@
 #include "monitors.h"
 #include "system.h"
 #include "threads.h"
+#include "timers.h"
 #include "user-events.h"
 #include "util/logger.h"
 #include "util/time.h"
@@ -26,8 +27,8 @@
 #include "xutil/xsession.h"
 
 WindowID isMPXManagerRunning(void) {
-    xcb_get_selection_owner_reply_t* ownerReply = xcb_get_selection_owner_reply(dis, xcb_get_selection_owner(dis,
-                MPX_WM_SELECTION_ATOM), NULL);
+    xcb_get_selection_owner_reply_t* ownerReply = X_ROUND_TRIP(xcb_get_selection_owner_reply(dis, xcb_get_selection_owner(dis,
+                MPX_WM_SELECTION_ATOM), NULL));
     WindowID win = 0;
     if(ownerReply && ownerReply->owner) {
         if(getWindowPropertyValueInt(ownerReply->owner, ewmh->_NET_WM_PID, XCB_ATOM_CARDINAL))
@@ -39,8 +40,8 @@ WindowID isMPXManagerRunning(void) {
 
 void ownSelection(xcb_atom_t selectionAtom) {
     if(!STEAL_WM_SELECTION) {
-        xcb_get_selection_owner_reply_t* ownerReply = xcb_get_selection_owner_reply(dis, xcb_get_selection_owner(dis,
-                    selectionAtom), NULL);
+        xcb_get_selection_owner_reply_t* ownerReply = X_ROUND_TRIP(xcb_get_selection_owner_reply(dis, xcb_get_selection_owner(dis,
+                    selectionAtom), NULL));
         if(ownerReply->owner) {
             ERROR("Selection %d is already owned by window %d", selectionAtom, ownerReply->owner);
             quit(WM_ALREADY_RUNNING);
@@ -59,7 +60,7 @@ bool registerWindowInfo(WindowInfo* winInfo, xcb_get_window_attributes_reply_t*
     const bool freeAttr = !attr;
     const bool newlyCreated = !attr;
     if(!attr)
-        attr = xcb_get_window_attributes_reply(dis, xcb_get_window_attributes(dis, winInfo->id), NULL);
+        attr = X_ROUND_TRIP(xcb_get_window_attributes_reply(dis, xcb_get_window_attributes(dis, winInfo->id), NULL));
     if(attr) {
         if(attr->override_redirect)
             winInfo->overrideRedirect = 1;
@@ -99,7 +100,7 @@ void scan(xcb_window_t baseWindow) {
     assert(baseWindow);
     TRACE("Scanning children of window %d", baseWindow);
     xcb_query_tree_reply_t* reply;
-    reply = xcb_query_tree_reply(dis, xcb_query_tree(dis, baseWindow), 0);
+    reply = X_ROUND_TRIP(xcb_query_tree_reply(dis, xcb_query_tree(dis, baseWindow), 0));
     if(reply) {
         xcb_get_window_attributes_reply_t* attr;
         int numberOfChildren = xcb_query_tree_children_length(reply);
@@ -108,13 +109,31 @@ void scan(xcb_window_t baseWindow) {
         xcb_get_window_attributes_cookie_t cookies[numberOfChildren];
         for(int i = 0; i < numberOfChildren; i++)
             cookies[i] = xcb_get_window_attributes(dis, children[i]);
+        xcb_get_window_attributes_reply_t* attrs[numberOfChildren];
+        WindowPropertyCookies* prefetchedProperties[numberOfChildren];
+        countXRoundTrip();
+        for(int i = 0; i < numberOfChildren; i++) {
+            attr = attrs[i] = X_REPLY(xcb_get_window_attributes_reply(dis, cookies[i], NULL));
+            // the properties of mapped windows, which are loaded as soon as they are registered, are requested
+            // before any window is registered so they arrive in one batch
+            prefetchedProperties[i] = NULL;
+            if(attr && !attr->override_redirect && attr->map_state != XCB_MAP_STATE_UNMAPPED) {
+                // like onCreateEvent, listen for property changes before prefetching so a property that changes in
+                // between isn't missed; registering the window later selects the final mask
+                uint32_t mask = NON_ROOT_EVENT_MASKS | XCB_EVENT_MASK_PROPERTY_CHANGE;
+                XCALL(xcb_change_window_attributes, dis, children[i], XCB_CW_EVENT_MASK, &mask);
+                prefetchedProperties[i] = prefetchWindowProperties(children[i]);
+            }
+        }
         // iterate in bottom to top order
         for(int i = 0; i < numberOfChildren; i++) {
             TRACE("processing child %d", children[i]);
-            attr = xcb_get_window_attributes_reply(dis, cookies[i], NULL);
-            registerWindow(children[i], baseWindow, attr);
-            if(attr)
-                free(attr);
+            assert(!getWindowInfo(children[i]) && "Window registered exists");
+            WindowInfo* winInfo = newWindowInfo(children[i], baseWindow);
+            winInfo->pendingProperties = prefetchedProperties[i];
+            registerWindowInfo(winInfo, attrs[i]);
+            if(attrs[i])
+                free(attrs[i]);
         }
         free(reply);
     }
@@ -151,6 +170,11 @@ void updateFocusForAllMasters(WindowInfo* winInfo) {
         }
     }
 }
+void updateFocusAfterFailure(WindowID win) {
+    WindowInfo* winInfo = getWindowInfo(win);
+    if(winInfo)
+        updateFocusForAllMasters(winInfo);
+}
 
 bool unregisterWindow(WindowInfo* winInfo, bool unregisterForEvents) {
     if(!winInfo)
@@ -207,7 +231,7 @@ void switchToWorkspace(int workspaceIndex) {
             }
         }
         DEBUG("Swapping visible workspace %d with %d", currentIndex, workspaceIndex);
-        FOR_EACH_R(WindowInfo*, winInfo, getWorkspaceWindowStack(getWorkspace(currentIndex))) {
+        FOR_EACH_VALUE_R(WindowInfo*, winInfo, getWorkspaceWindowStack(getWorkspace(currentIndex))) {
             if(hasMask(winInfo, STICKY_MASK))
                 moveToWorkspace(winInfo, workspaceIndex);
         }
@@ -224,9 +248,9 @@ void activateWorkspace(WorkspaceID workspaceIndex) {
             return;
         }
     }
-    ArrayList* list = getWorkspaceWindowStack(getWorkspace(workspaceIndex));
-    if(list->size)
-        activateWindow(getHead(list));
+    WindowStack* stack = getWorkspaceWindowStack(getWorkspace(workspaceIndex));
+    if(stack->size)
+        activateWindow(stack->data[0]);
     else
         INFO("activateWorkspace: no window was activated");
 }
@@ -258,13 +282,64 @@ static inline int popcount(int x) {
     return c;
 }
 
-void configureWindow(WindowID win, uint32_t mask, uint32_t* values) {
+static uint32_t numberOfConfigureRequests;
+static uint32_t numberOfSuppressedConfigureRequests;
+static uint32_t numberOfSuppressedConfigureValues;
+uint32_t getNumberOfConfigureRequests(void) {
+    return numberOfConfigureRequests;
+}
+uint32_t getNumberOfSuppressedConfigureRequests(void) {
+    return numberOfSuppressedConfigureRequests;
+}
+uint32_t getNumberOfSuppressedConfigureValues(void) {
+    return numberOfSuppressedConfigureValues;
+}
+static void sendConfigureRequest(WindowID win, uint32_t mask, const uint32_t* values) {
     assert(mask);
     assert(mask < 128);
     INFO("Config %d: mask %d (%d bits)", win, mask, popcount(mask));
     LOG_RUN(LOG_LEVEL_INFO, PRINT_ARR("Config values", values, popcount(mask)));
+    numberOfConfigureRequests++;
     XCALL(xcb_configure_window, dis, win, mask, values);
 }
+void configureWindow(WindowID win, uint32_t mask, uint32_t* values) {
+    WindowInfo* winInfo = getWindowInfo(win);
+    if(winInfo)
+        winInfo->sentConfigMask &= ~mask;
+    sendConfigureRequest(win, mask, values);
+}
+void configureWindowInfo(WindowInfo* winInfo, uint32_t mask, const uint32_t* values) {
+    uint32_t changedValues[7];
+    uint32_t changedMask = 0;
+    for(int i = 0, n = 0, numChanged = 0; i < LEN(changedValues); i++) {
+        if(!(mask & (1 << i)))
+            continue;
+        uint32_t value = values[n++];
+        if(i < LEN(winInfo->sentConfig)) {
+            if(winInfo->sentConfigMask & (1 << i) && winInfo->sentConfig[i] == (short)value) {
+                numberOfSuppressedConfigureValues++;
+                continue;
+            }
+            winInfo->sentConfig[i] = value;
+            winInfo->sentConfigMask |= 1 << i;
+        }
+        changedValues[numChanged++] = value;
+        changedMask |= 1 << i;
+    }
+    if(changedMask)
+        sendConfigureRequest(winInfo->id, changedMask, changedValues);
+    else {
+        TRACE("Suppressed config of %d; nothing changed", winInfo->id);
+        numberOfSuppressedConfigureRequests++;
+    }
+}
+void clearStaleSentConfig(WindowInfo* winInfo, const short* geometry) {
+    // ConfigureNotify events for older requests may still be queued, so this can clear values that are in effect;
+    // they will just be sent again
+    for(int i = 0; i < LEN(winInfo->sentConfig); i++)
+        if(winInfo->sentConfig[i] != geometry[i])
+            winInfo->sentConfigMask &= ~(1 << i);
+}
 void setWindowPosition(WindowID win, const Rect geo) {
     uint32_t values[4];
     copyTo(&geo, values);
@@ -348,3 +423,20 @@ void raiseLowerWindowInfo(WindowInfo* winInfo, WindowID sibling, bool above) {
         }
     raiseLowerWindow(winInfo->id, sibling, above);
 }
+
+/// Kills the client if the window is still managed once KILL_TIMEOUT has elapsed
+static void killClientIfStillAlive(void* arg) {
+    WindowID win = (WindowID)(uintptr_t)arg;
+    if(getWindowInfo(win)) {
+        INFO("Window %d did not close after WM_DELETE_WINDOW; killing client", win);
+        killClientOfWindow(win);
+    }
+}
+void killClientOfWindowInfo(WindowInfo* winInfo) {
+    if(!winInfo->supportsDeleteWindow) {
+        killClientOfWindow(winInfo->id);
+        return;
+    }
+    sendDeleteWindowRequest(winInfo->id);
+    addTimer(KILL_TIMEOUT, killClientIfStillAlive, (void*)(uintptr_t)winInfo->id);
+}
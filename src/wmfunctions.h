@@ -50,7 +50,8 @@ bool registerWindow(WindowID win, WindowID parent, xcb_get_window_attributes_rep
 bool registerWindowInfo(WindowInfo* winInfo, xcb_get_window_attributes_reply_t* attr);
 
 /**
- * Queries the XServer for all direct children of baseWindow
+ * Queries the XServer for all direct children of baseWindow and registers them.
+ * The properties of mapped children are prefetched together
  * @param baseWindow
  */
 void scan(xcb_window_t baseWindow);
@@ -76,6 +77,13 @@ void updateWindowWorkspaceState(WindowInfo* winInfo);
  * @param winInfo
  */
 void updateFocusForAllMasters(WindowInfo* winInfo);
+/**
+ * Restarts the search for a window to focus for all masters still recorded as focusing win.
+ * Meant to be assigned to onFocusFailure so a failed focus request falls through to the next candidate.
+ *
+ * @param win the window that could not be focused
+ */
+void updateFocusAfterFailure(WindowID win);
 
 /**
  * Make the active workspace the one designated by workspaceIndex and make it visible.
@@ -107,9 +115,41 @@ void activateWorkspace(WorkspaceID workspaceIndex);
 
 
 /**
+ * Any cached values of win that are changed by this request are forgotten
  * @see xcb_configure_window
+ * @see configureWindowInfo
  */
 void configureWindow(WindowID win, uint32_t mask, uint32_t* values);
+/**
+ * Like configureWindow but values that match what was last sent for winInfo are left out of the request.
+ * Nothing is sent if every value matches.
+ *
+ * Values are only cached while ConfigureNotify events agree with them; @see clearStaleSentConfig
+ *
+ * @param winInfo
+ * @param mask
+ * @param values
+ */
+void configureWindowInfo(WindowInfo* winInfo, uint32_t mask, const uint32_t* values);
+/**
+ * Forgets the values last sent by configureWindowInfo that don't match the current geometry of the window
+ *
+ * @param winInfo
+ * @param geometry the x, y, width, height and border width of winInfo as reported by a ConfigureNotify event
+ */
+void clearStaleSentConfig(WindowInfo* winInfo, const short* geometry);
+/**
+ * @return the number of ConfigureWindow requests sent
+ */
+uint32_t getNumberOfConfigureRequests(void);
+/**
+ * @return the number of calls to configureWindowInfo that didn't send anything because no value changed
+ */
+uint32_t getNumberOfSuppressedConfigureRequests(void);
+/**
+ * @return the number of values configureWindowInfo left out of requests because they didn't change
+ */
+uint32_t getNumberOfSuppressedConfigureValues(void);
 
 /**
  * Sets the window position to be geo.
@@ -178,4 +218,12 @@ static inline void lowerWindow(WindowID win, WindowID sibling) {
 static inline void lowerWindowInfo(WindowInfo* winInfo, WindowID sibling) {
     raiseLowerWindowInfo(winInfo, sibling, 0);
 }
+
+/**
+ * Sends a WM_DELETE_WINDOW message or sends a kill requests.
+ * If the window supports WM_DELETE_WINDOW, its client is killed if the window is still managed after KILL_TIMEOUT ms
+ * @param winInfo
+ * @see killClientOfWindow
+ */
+void killClientOfWindowInfo(WindowInfo* winInfo);
 #endif
@@ -30,10 +30,11 @@ void addWorkspaces(int num) {
     }
 }
 void freeWorkspace(Workspace* workspace) {
-    FOR_EACH_R(WindowInfo*, winInfo, getWorkspaceWindowStack(workspace)) {
+    FOR_EACH_VALUE_R(WindowInfo*, winInfo, getWorkspaceWindowStack(workspace)) {
+        winInfo->workspaceIndex = NO_WORKSPACE;
         moveToWorkspace(winInfo, getNumberOfWorkspaces() - 1);
     }
-    clearArray(&workspace->windows);
+    WindowStackClear(&workspace->windows);
     clearArray(&workspace->layouts);
     free(workspace);
 }
@@ -59,16 +60,12 @@ bool isWorkspaceVisible(Workspace* workspace) {
     return getMonitor(workspace) && isMonitorActive(getMonitor(workspace));
 }
 
-ArrayList* getWorkspaceWindowStack(Workspace* workspace) {
+WindowStack* getWorkspaceWindowStack(Workspace* workspace) {
     return &workspace->windows;
 }
 
 Workspace* getWorkspaceOfWindow(const WindowInfo* winInfo) {
-    FOR_EACH(Workspace*, w, getAllWorkspaces()) {
-        if(findElement(getWorkspaceWindowStack(w), winInfo, sizeof(WindowID)))
-            return w;
-    }
-    return NULL;
+    return getWorkspace(winInfo->workspaceIndex);
 }
 
 WorkspaceID getWorkspaceIndexOfWindow(const WindowInfo* winInfo) {
@@ -116,13 +113,28 @@ uint32_t getLayoutOffset(Workspace* workspace) {
 }
 
 bool hasWindowWithMask(Workspace* workspace, WindowMask mask) {
-    FOR_EACH(WindowInfo*, winInfo, getWorkspaceWindowStack(workspace)) {
+    // bits in the workspace mask are shared by every window
+    WindowMask remaining = mask & ~workspace->mask;
+    if(!remaining)
+        return getWorkspaceWindowStack(workspace)->size;
+    for(WindowMask bits = remaining; bits; bits &= bits - 1)
+        if(!workspace->windowMaskCounts[__builtin_ctz(bits)])
+            return 0;
+    // a single bit is fully answered by its counter
+    if(!(remaining & (remaining - 1)))
+        return 1;
+    FOR_EACH_VALUE(WindowInfo*, winInfo, getWorkspaceWindowStack(workspace)) {
         if(hasMask(winInfo, mask))
             return 1;
     }
     return 0;
 }
 
+void updateWorkspaceMaskCounts(Workspace* workspace, WindowMask mask, int delta) {
+    for(; mask; mask &= mask - 1)
+        workspace->windowMaskCounts[__builtin_ctz(mask)] += delta;
+}
+
 void swapMonitors(WorkspaceID index1, WorkspaceID index2) {
     Monitor* monitor1 = getMonitor(getWorkspace(index1));
     Monitor* monitor2 = getMonitor(getWorkspace(index2));
@@ -10,8 +10,12 @@
 #include "mywm-structs.h"
 #include "util/arraylist.h"
 #include "util/rect.h"
+#include "util/vector.h"
 #include "window-masks.h"
 
+/// The windows of a workspace in stacking order; elements are stored inline so layouts iterate without calls
+DECLARE_SCALAR_VECTOR(WindowInfo*, WindowStack)
+
 /// Placeholder for WindowInfo->workspaceIndex; indicates the window is not in a workspace
 #ifndef NO_WORKSPACE
 #define NO_WORKSPACE ((WorkspaceID)-1)
@@ -60,7 +64,7 @@ struct Workspace {
     bool dirty;
 
     ///an windows stack
-    ArrayList windows;
+    WindowStack windows;
 
     ///the currently applied layout; does not have to be in layouts
     Layout* activeLayout ;
@@ -69,6 +73,8 @@ struct Workspace {
     /// offset into layouts when cycling
     uint32_t layoutOffset ;
     WindowMask mask;
+    /// the number of windows in this workspace with each mask bit set in their own mask
+    uint32_t windowMaskCounts[NUM_WINDOW_MASKS];
 };
 
 
@@ -83,7 +89,7 @@ static inline Workspace* getWorkspace(WorkspaceID index) {
 /**
  * @return the windows stack of the workspace
  */
-ArrayList* getWorkspaceWindowStack(Workspace* workspace);
+WindowStack* getWorkspaceWindowStack(Workspace* workspace);
 
 /**
  *
@@ -95,7 +101,7 @@ Workspace* getWorkspaceOfWindow(const WindowInfo* winInfo);
 /// @return the active Workspace or NULL
 static inline Workspace* getActiveWorkspace(void) {return getWorkspace(getActiveWorkspaceIndex());}
 /// @return the workspace of the active master
-static inline ArrayList* getActiveWindowStack() {return getWorkspaceWindowStack(getActiveWorkspace());}
+static inline WindowStack* getActiveWindowStack() {return getWorkspaceWindowStack(getActiveWorkspace());}
 
 /**
  * @return the monitor associate with the given workspace if any
@@ -136,6 +142,11 @@ void addLayout(Workspace* workspace, Layout* layout);
  * @return true if there exists at least one window in workspace with the given mask
  */
 bool hasWindowWithMask(Workspace* workspace, WindowMask mask) ;
+/**
+ * Adds delta to the counter of every bit in mask
+ * @see Workspace::windowMaskCounts
+ */
+void updateWorkspaceMaskCounts(Workspace* workspace, WindowMask mask, int delta);
 /**
  * Set the layout specified by offset to be the active layout
  *
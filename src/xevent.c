@@ -1,17 +1,31 @@
 #include <assert.h>
 #include <poll.h>
+#include <pthread.h>
+#include <stdlib.h>
 #include <string.h>
+#include <sys/eventfd.h>
 #include <unistd.h>
+#ifndef NO_EPOLL
+#include <sys/epoll.h>
+#endif
 
 #include <X11/Xlib-xcb.h>
 #include <xcb/xcb.h>
 #include <xcb/xcb_ewmh.h>
 
 #include "boundfunction.h"
+#include "event-record.h"
 #include "globals.h"
 #include "monitors.h"
+#include "mywm-structs.h"
 #include "user-events.h"
+#include "util/debug.h"
+#include "util/hashmap.h"
+#include "util/histogram.h"
 #include "util/logger.h"
+#include "util/slab.h"
+#include "util/time.h"
+#include "util/timeline.h"
 #include "xevent.h"
 #include "xutil/xsession.h"
 
@@ -27,116 +41,580 @@ static volatile int idle;
 int getIdleCount() {
     return idle;
 }
+/// the number of X events passed to processXEvent
+static uint32_t processedEvents;
+uint32_t getNumberOfProcessedEvents(void) {
+    return processedEvents;
+}
 static int lastDetectedEventSequenceNumber;
-static int lastEventSequenceNumber;
-uint32_t getLastDetectedEventSequenceNumber() {return lastDetectedEventSequenceNumber;}
+static uint32_t lastEventSequenceNumber;
+uint32_t getLastDetectedEventSequenceNumber() {return __atomic_load_n(&lastDetectedEventSequenceNumber, __ATOMIC_RELAXED);}
 uint16_t getCurrentSequenceNumber(void) {
     return lastEventSequenceNumber;
 }
+uint32_t getCurrentFullSequenceNumber(void) {
+    return lastEventSequenceNumber;
+}
 
-typedef struct {
+/// A fixed size block of the event queue
+typedef struct EventQueueChunk {
     xcb_generic_event_t* arr[MPX_EVENT_QUEUE_SIZE];
-    /// next index to read from
+    /// the time (ns) each event was pushed
+    TimeStamp pushTime[MPX_EVENT_QUEUE_SIZE];
+    /// the chunk written to after this one is full
+    struct EventQueueChunk* next;
+} EventQueueChunk;
+/**
+ * Unbounded single producer single consumer queue of X events.
+ * The producer is the reader thread if it is running and the main thread otherwise; the consumer is always the main
+ * thread. Only the counters are shared, so neither side needs a lock.
+ */
+typedef struct {
+    /// number of events ever pushed; only written by the producer
+    uint32_t pushed;
+    /// number of events ever popped; only written by the consumer
+    uint32_t popped;
+    /// chunk being read from and the index in it of the next event; only used by the consumer
+    EventQueueChunk* readChunk;
     uint16_t bufferIndexRead;
-    /// next index to write to
+    /// chunk being written to and the index in it of the next event; only used by the producer
+    EventQueueChunk* writeChunk;
     uint16_t bufferIndexWrite;
+    /// an emptied chunk kept so the producer doesn't have to allocate one every time it fills a chunk
+    EventQueueChunk* spareChunk;
 } EventQueue;
-static EventQueue eventQueue;
+static EventQueueChunk firstEventQueueChunk;
+static EventQueue eventQueue = {.readChunk = &firstEventQueueChunk, .writeChunk = &firstEventQueueChunk};
 int getEventQueueSize() {
-    return (eventQueue.bufferIndexWrite - eventQueue.bufferIndexRead + MPX_EVENT_QUEUE_SIZE) % MPX_EVENT_QUEUE_SIZE;
+    return __atomic_load_n(&eventQueue.pushed, __ATOMIC_ACQUIRE) - __atomic_load_n(&eventQueue.popped, __ATOMIC_ACQUIRE);
 }
 bool isEventQueueEmpty() {
-    return eventQueue.bufferIndexWrite == eventQueue.bufferIndexRead;
+    return __atomic_load_n(&eventQueue.pushed, __ATOMIC_ACQUIRE) == eventQueue.popped;
 }
 
-static bool pushEvent(xcb_generic_event_t* event) {
-    if(!event) {
-        TRACE("No more events to read");
-        return NULL;
+/// Adds events to the queue and makes them visible to the consumer
+static void pushEvents(xcb_generic_event_t** events, uint32_t num) {
+    if(!num)
+        return;
+    TimeStamp now = getTimeNs();
+    for(uint32_t i = 0; i < num; i++) {
+        if(eventQueue.bufferIndexWrite == MPX_EVENT_QUEUE_SIZE) {
+            EventQueueChunk* chunk = __atomic_exchange_n(&eventQueue.spareChunk, NULL, __ATOMIC_ACQUIRE);
+            if(!chunk)
+                chunk = malloc(sizeof(EventQueueChunk));
+            chunk->next = NULL;
+            eventQueue.writeChunk->next = chunk;
+            eventQueue.writeChunk = chunk;
+            eventQueue.bufferIndexWrite = 0;
+        }
+        eventQueue.writeChunk->pushTime[eventQueue.bufferIndexWrite] = now;
+        eventQueue.writeChunk->arr[eventQueue.bufferIndexWrite++] = events[i];
     }
-    eventQueue.arr[eventQueue.bufferIndexWrite++ % MPX_EVENT_QUEUE_SIZE] = event;
-    lastDetectedEventSequenceNumber = event->sequence;
-    return (eventQueue.bufferIndexWrite - eventQueue.bufferIndexRead) % MPX_EVENT_QUEUE_SIZE;
+    __atomic_store_n(&lastDetectedEventSequenceNumber, events[num - 1]->sequence, __ATOMIC_RELAXED);
+    __atomic_store_n(&eventQueue.pushed, eventQueue.pushed + num, __ATOMIC_RELEASE);
 }
 
+/// the time (ns) the last popped event was pushed
+static TimeStamp lastEventPushTime;
+/// @return the oldest event in the queue which must not be empty
 static xcb_generic_event_t* popEvent() {
-    return eventQueue.arr[eventQueue.bufferIndexRead++ % MPX_EVENT_QUEUE_SIZE];
+    if(eventQueue.bufferIndexRead == MPX_EVENT_QUEUE_SIZE) {
+        EventQueueChunk* chunk = eventQueue.readChunk;
+        eventQueue.readChunk = chunk->next;
+        eventQueue.bufferIndexRead = 0;
+        if(chunk != &firstEventQueueChunk)
+            free(__atomic_exchange_n(&eventQueue.spareChunk, chunk, __ATOMIC_RELEASE));
+    }
+    lastEventPushTime = eventQueue.readChunk->pushTime[eventQueue.bufferIndexRead];
+    xcb_generic_event_t* event = eventQueue.readChunk->arr[eventQueue.bufferIndexRead++];
+    __atomic_store_n(&eventQueue.popped, eventQueue.popped + 1, __ATOMIC_RELEASE);
+    return event;
 }
 
+/// A callback registered with addExtraEvent
+struct FDHandler {
+    int fd;
+    /// the poll events the callback is interested in
+    short events;
+    bool edgeTriggered;
+    /// set once removed; the memory is reclaimed once events are no longer being dispatched
+    bool removed;
+    void(*callBack)();
+    void* userData;
+    /// the next handler for the same fd
+    FDHandler* next;
+};
+/// All handlers for a single fd
+typedef struct {
+    int fd;
+    /// handlers for fd; newest first
+    FDHandler* handlers;
+    /// the events fd is registered for; the union of the events of handlers
+    uint32_t events;
+} FDEntry;
+
+/// FDEntries indexed by fd
+static HashMap fdEntries;
+static uint32_t numberOfFDHandlers;
+static Slab fdHandlerSlab = SLAB(FDHandler);
+static Slab fdEntrySlab = SLAB(FDEntry);
+/// true while callbacks are being called
+static bool dispatchingFDEvents;
+/// handlers and entries removed while dispatching that still need to be freed
+static ArrayList removedFDHandlers;
+static ArrayList removedFDEntries;
+/// the handler for the X connection
+static FDHandler* xHandler;
 
-struct {
-    struct pollfd pollFDs[255];
-    void(*extraEventCallBacks[255])();
-    int numberOfFDsToPoll;
-} eventFDInfo = {.numberOfFDsToPoll = 1};
-static int xFD;
-void addExtraEvent(int fd, int mask,  void(*callBack)()) {
-    int index = eventFDInfo.numberOfFDsToPoll++;
-    eventFDInfo.pollFDs[index] = (struct pollfd) {fd, mask};
-    eventFDInfo.extraEventCallBacks[index] = callBack;
+#ifndef NO_EPOLL
+/// max number of fds to process per wakeup; any others will be reported on the next wakeup
+#define MAX_EPOLL_EVENTS 64
+static int epollFD = -1;
+/**
+ * Registers entry with the kernel
+ * @param op one of EPOLL_CTL_ADD, EPOLL_CTL_MOD or EPOLL_CTL_DEL
+ * @return 0 on success
+ */
+static int updateRegisteredEvents(FDEntry* entry, int op) {
+    if(epollFD == -1)
+        epollFD = epoll_create1(EPOLL_CLOEXEC);
+    struct epoll_event event = {.events = entry->events, .data.ptr = entry};
+    return epoll_ctl(epollFD, op, entry->fd, &event);
 }
-static void removeExtraEvent(int index) {
-    for(int i = index + 1; i < eventFDInfo.numberOfFDsToPoll; i++) {
-        eventFDInfo.pollFDs[i - 1] = eventFDInfo.pollFDs[i];
-        eventFDInfo.extraEventCallBacks[i - 1] = eventFDInfo.extraEventCallBacks[i];
+#define FD_ADDED EPOLL_CTL_ADD
+#define FD_MODIFIED EPOLL_CTL_MOD
+#define FD_REMOVED EPOLL_CTL_DEL
+#else
+/// FDEntries in the order they were added; parallel to pollFDs
+static ArrayList pollEntries;
+static struct pollfd* pollFDs;
+static uint32_t pollFDsSize;
+static bool pollFDsDirty;
+#define FD_ADDED 0
+#define FD_MODIFIED 1
+#define FD_REMOVED 2
+static int updateRegisteredEvents(FDEntry* entry, int op) {
+    if(op == FD_ADDED)
+        addElement(&pollEntries, entry);
+    else if(op == FD_REMOVED)
+        removeIndex(&pollEntries, getIndexOfPtr(&pollEntries, entry));
+    pollFDsDirty = 1;
+    return 0;
+}
+#endif
+
+/**
+ * Recomputes the events entry is registered for from its handlers
+ * @return 0 on success
+ */
+static int updateFDEntry(FDEntry* entry, bool added) {
+    uint32_t events = 0;
+    bool edgeTriggered = 1;
+    for(FDHandler* handler = entry->handlers; handler; handler = handler->next) {
+        events |= handler->events;
+        edgeTriggered &= handler->edgeTriggered;
+    }
+#ifndef NO_EPOLL
+    if(edgeTriggered)
+        events |= EPOLLET;
+#endif
+    if(!added && events == entry->events)
+        return 0;
+    entry->events = events;
+    return updateRegisteredEvents(entry, added ? FD_ADDED : FD_MODIFIED);
+}
+
+FDHandler* addExtraEventWithData(int fd, int mask, bool edgeTriggered, void(*callBack)(), void* userData) {
+    FDEntry* entry = getValue(&fdEntries, fd);
+    bool added = !entry;
+    if(added) {
+        entry = slabAlloc(&fdEntrySlab);
+        entry->fd = fd;
+    }
+    FDHandler* handler = slabAlloc(&fdHandlerSlab);
+    *handler = (FDHandler) {.fd = fd, .events = mask, .edgeTriggered = edgeTriggered, .callBack = callBack,
+        .userData = userData, .next = entry->handlers};
+    entry->handlers = handler;
+    if(updateFDEntry(entry, added)) {
+        WARN("Could not listen for events on fd %d", fd);
+        entry->handlers = handler->next;
+        slabFree(&fdHandlerSlab, handler);
+        if(added)
+            slabFree(&fdEntrySlab, entry);
+        return NULL;
+    }
+    if(added)
+        putValue(&fdEntries, fd, entry);
+    numberOfFDHandlers++;
+    return handler;
+}
+FDHandler* addExtraEvent(int fd, int mask, void(*callBack)()) {
+    return addExtraEventWithData(fd, mask, 0, callBack, NULL);
+}
+
+void removeExtraEvent(FDHandler* handler) {
+    assert(!handler->removed);
+    FDEntry* entry = getValue(&fdEntries, handler->fd);
+    FDHandler** p = &entry->handlers;
+    while(*p != handler)
+        p = &(*p)->next;
+    // handler->next is left intact so it can be followed if handler is being dispatched
+    *p = handler->next;
+    handler->removed = 1;
+    if(!--numberOfFDHandlers) {
+        DEBUG("There are no fds left to poll");
+        requestShutdown();
+    }
+    if(handler == xHandler)
+        xHandler = NULL;
+    if(entry->handlers)
+        updateFDEntry(entry, 0);
+    else {
+        updateRegisteredEvents(entry, FD_REMOVED);
+        removeKey(&fdEntries, entry->fd);
+        if(!fdEntries.size)
+            clearMap(&fdEntries);
+    }
+    if(dispatchingFDEvents) {
+        addElement(&removedFDHandlers, handler);
+        if(!entry->handlers)
+            addElement(&removedFDEntries, entry);
+        return;
+    }
+    slabFree(&fdHandlerSlab, handler);
+    if(!entry->handlers)
+        slabFree(&fdEntrySlab, entry);
+}
+uint32_t getNumberOfExtraEvents(void) {
+    return numberOfFDHandlers;
+}
+
+/// frees everything removed while dispatching
+static void reclaimRemovedFDHandlers(void) {
+    FOR_EACH(FDHandler*, handler, &removedFDHandlers) {
+        slabFree(&fdHandlerSlab, handler);
+    }
+    FOR_EACH(FDEntry*, entry, &removedFDEntries) {
+        slabFree(&fdEntrySlab, entry);
+    }
+    removedFDHandlers.size = 0;
+    removedFDEntries.size = 0;
+}
+
+/// Removes handler for an fd that can no longer produce events
+static void removeClosedFDHandler(FDHandler* handler) {
+    WARN("Removing extra event for fd %d", handler->fd);
+    removeExtraEvent(handler);
+}
+
+static void dispatchFDEvents(FDEntry* entry, int revents) {
+    for(FDHandler* handler = entry->handlers; handler; handler = handler->next) {
+        if(handler->removed)
+            continue;
+        if(revents & handler->events)
+            handler->callBack(handler->fd, revents, handler->userData);
+        if(revents & (POLLERR | POLLNVAL | POLLHUP) && !handler->removed)
+            removeClosedFDHandler(handler);
     }
-    eventFDInfo.numberOfFDsToPoll--;
 }
 
 static inline int processEvents(int timeout) {
     int numEvents;
-    assert(eventFDInfo.numberOfFDsToPoll);
-    TRACE("polling for %d events timeout %d", eventFDInfo.numberOfFDsToPoll, timeout);
-    if((numEvents = poll(eventFDInfo.pollFDs, eventFDInfo.numberOfFDsToPoll, timeout))) {
-        TRACE("FD poll returned %d events out of %d", numEvents, eventFDInfo.numberOfFDsToPoll);
-        for(int i = eventFDInfo.numberOfFDsToPoll - 1; i >= 0; i--) {
-            if(eventFDInfo.pollFDs[i].revents) {
-                if(eventFDInfo.pollFDs[i].revents & eventFDInfo.pollFDs[i].events) {
-                    eventFDInfo.extraEventCallBacks[i](eventFDInfo.pollFDs[i].fd, eventFDInfo.pollFDs[i].revents);
-                }
-                if(eventFDInfo.pollFDs[i].revents & (POLLERR | POLLNVAL | POLLHUP)) {
-                    WARN("Removing extra event index %d", i);
-                    removeExtraEvent(i);
-                    if(!eventFDInfo.numberOfFDsToPoll){
-                        DEBUG("All fds have been close");
-                        requestShutdown();
-                    }
-
-                }
-            }
+    assert(numberOfFDHandlers);
+    TRACE("polling for %d fds timeout %d", fdEntries.size, timeout);
+#ifndef NO_EPOLL
+    struct epoll_event events[MAX_EPOLL_EVENTS];
+    if((numEvents = epoll_wait(epollFD, events, LEN(events), timeout)) > 0) {
+        TRACE("FD poll returned %d events out of %d", numEvents, fdEntries.size);
+        dispatchingFDEvents = 1;
+        for(int i = 0; i < numEvents; i++) {
+            FDEntry* entry = events[i].data.ptr;
+            if(entry->handlers)
+                dispatchFDEvents(entry, events[i].events);
+        }
+        dispatchingFDEvents = 0;
+        reclaimRemovedFDHandlers();
+    }
+#else
+    if(pollFDsDirty) {
+        if(pollFDsSize < pollEntries.size) {
+            pollFDsSize = pollEntries.size;
+            pollFDs = realloc(pollFDs, pollFDsSize * sizeof(struct pollfd));
+        }
+        for(int i = 0; i < pollEntries.size; i++) {
+            FDEntry* entry = getElement(&pollEntries, i);
+            pollFDs[i] = (struct pollfd) {entry->fd, entry->events};
         }
+        pollFDsDirty = 0;
     }
+    int numberOfFDs = pollEntries.size;
+    if((numEvents = poll(pollFDs, numberOfFDs, timeout)) > 0) {
+        TRACE("FD poll returned %d events out of %d", numEvents, numberOfFDs);
+        dispatchingFDEvents = 1;
+        // pollEntries may change while dispatching; pollFDs won't be touched until the next call
+        FDEntry* entries[numberOfFDs];
+        memcpy(entries, pollEntries.__arr, sizeof(entries));
+        for(int i = 0; i < numberOfFDs; i++)
+            if(pollFDs[i].revents && entries[i]->handlers)
+                dispatchFDEvents(entries[i], pollFDs[i].revents);
+        dispatchingFDEvents = 0;
+        reclaimRemovedFDHandlers();
+    }
+#endif
     return numEvents;
 }
 
-static inline xcb_generic_event_t* pollForXEvent(void) {
-    TRACE("Polling for event");
-    xcb_generic_event_t* event = xcb_poll_for_event(dis);
-    if(event) {
-        lastDetectedEventSequenceNumber = event->sequence;
-        TRACE("Reading events on the X queue");
-        while(pushEvent(xcb_poll_for_queued_event(dis)));
-        TRACE("Finished reading events off of the X queue");
+/// time (ns) events of each type spent in the event queue
+static Histogram queueWait[LASTEvent];
+const Histogram* getEventQueueWait(int type) {
+    return &queueWait[type];
+}
+
+/**
+ * number of events dropped by coalesceEvents for each event type.
+ * Incremented by the reader thread and read/cleared by the main thread so every access is atomic
+ */
+static uint32_t coalescedEvents[LAST_REAL_EVENT];
+uint32_t getNumberOfCoalescedEvents(int type) {
+    return __atomic_load_n(&coalescedEvents[type], __ATOMIC_RELAXED);
+}
+void clearEventQueueStats(void) {
+    for(int i = 0; i < LEN(queueWait); i++)
+        clearHistogram(&queueWait[i]);
+    for(int i = 0; i < LEN(coalescedEvents); i++)
+        __atomic_store_n(&coalescedEvents[i], 0, __ATOMIC_RELAXED);
+}
+
+/// An event that has been seen by coalesceEvents
+typedef struct {
+    /// the value of coalesceGeneration when this entry was set; entries from older generations are empty
+    uint32_t generation;
+    uint8_t responseType;
+    WindowID window;
+    /// the atom of a PropertyNotify or the device of an XI event
+    uint32_t detail;
+} CoalesceEntry;
+/// open addressing table of the events seen since the last barrier
+static CoalesceEntry coalesceTable[MPX_EVENT_QUEUE_SIZE * 2];
+static uint32_t coalesceGeneration;
+
+/// Forgets every event seen so far
+static void clearCoalesceTable(void) {
+    if(!++coalesceGeneration) {
+        memset(coalesceTable, 0, sizeof(coalesceTable));
+        coalesceGeneration++;
+    }
+}
+/**
+ * @param event
+ * @param window set to the window event is about
+ * @param detail set to the value that, along with window, distinguishes events of the same type
+ * @return the event type of event if it can be coalesced or 0
+ */
+static int getCoalesceKey(xcb_generic_event_t* event, WindowID* window, uint32_t* detail) {
+    int type = event->response_type & 127;
+    *detail = 0;
+    switch(type) {
+        case XCB_CONFIGURE_NOTIFY:
+            *window = ((xcb_configure_notify_event_t*)event)->window;
+            break;
+        case XCB_PROPERTY_NOTIFY:
+            *window = ((xcb_property_notify_event_t*)event)->window;
+            *detail = ((xcb_property_notify_event_t*)event)->atom;
+            break;
+        case XCB_GE_GENERIC:
+            if(((xcb_ge_generic_event_t*)event)->event_type != XCB_INPUT_MOTION ||
+                ((xcb_ge_generic_event_t*)event)->extension != xcb_get_extension_data(dis, &xcb_input_id)->major_opcode)
+                return 0;
+            type = GENERIC_EVENT_OFFSET + XCB_INPUT_MOTION;
+            *window = ((xcb_input_motion_event_t*)event)->event;
+            *detail = ((xcb_input_motion_event_t*)event)->deviceid;
+            break;
+        default:
+            return 0;
+    }
+    return COALESCE_EVENT_TYPES & 1ULL << type ? type : 0;
+}
+/**
+ * Events that change the existence or map state of a window.
+ * Events are never coalesced across one of these so rules see the same ordering
+ */
+static bool isCoalesceBarrier(xcb_generic_event_t* event) {
+    switch(event->response_type & 127) {
+        case XCB_CREATE_NOTIFY:
+        case XCB_DESTROY_NOTIFY:
+        case XCB_UNMAP_NOTIFY:
+        case XCB_MAP_NOTIFY:
+        case XCB_MAP_REQUEST:
+        case XCB_REPARENT_NOTIFY:
+            return 1;
+    }
+    return 0;
+}
+/**
+ * Records event as seen
+ * @return true if an event with the same key has already been seen
+ */
+static bool markSeen(uint8_t responseType, WindowID window, uint32_t detail) {
+    uint32_t index = (window * 2654435769U ^ detail * 40503U ^ responseType) % LEN(coalesceTable);
+    for(;; index = (index + 1) % LEN(coalesceTable)) {
+        CoalesceEntry* entry = &coalesceTable[index];
+        if(entry->generation != coalesceGeneration) {
+            *entry = (CoalesceEntry) {coalesceGeneration, responseType, window, detail};
+            return 0;
+        }
+        if(entry->responseType == responseType && entry->window == window && entry->detail == detail)
+            return 1;
     }
-    return event;
+}
+
+uint32_t coalesceEvents(xcb_generic_event_t** events, uint32_t num) {
+    assert(num <= MPX_EVENT_QUEUE_SIZE);
+    if(!COALESCE_EVENT_TYPES)
+        return num;
+    uint32_t dropped = 0;
+    clearCoalesceTable();
+    // walk backwards so the latest event of each key is the one kept
+    for(int i = num - 1; i >= 0; i--) {
+        WindowID window;
+        uint32_t detail;
+        int type;
+        if(isCoalesceBarrier(events[i]))
+            clearCoalesceTable();
+        else if((type = getCoalesceKey(events[i], &window, &detail)) &&
+            markSeen(events[i]->response_type, window, detail)) {
+            __atomic_fetch_add(&coalescedEvents[type], 1, __ATOMIC_RELAXED);
+            free(events[i]);
+            events[i] = NULL;
+            dropped++;
+        }
+    }
+    if(dropped) {
+        uint32_t size = 0;
+        for(uint32_t i = 0; i < num; i++)
+            if(events[i])
+                events[size++] = events[i];
+        TRACE("Coalesced %d out of %d events", dropped, num);
+    }
+    return num - dropped;
+}
+
+/// events read off the X connection but not yet pushed onto the event queue; only used by the producer
+static xcb_generic_event_t* eventBatch[MPX_EVENT_QUEUE_SIZE];
+/// true while the reader thread is the producer of the event queue
+static bool readerThreadRunning;
+static volatile bool readerThreadStopping;
+/// set by the reader thread when it exits because the X connection was lost
+static volatile bool readerThreadDisconnected;
+static pthread_t readerThread;
+/// signaled by the reader thread whenever it pushes events
+static int readerEventFD = -1;
+/// the window stopReaderThread sends an event to; 0 if the reader thread has never been started
+static WindowID readerWakeupWindow;
+
+/// @return true if event was sent by stopReaderThread to unblock the reader thread
+static bool isReaderWakeupEvent(xcb_generic_event_t* event) {
+    return (event->response_type & 127) == XCB_CLIENT_MESSAGE &&
+        ((xcb_client_message_event_t*)event)->window == readerWakeupWindow && readerWakeupWindow &&
+        ((xcb_client_message_event_t*)event)->type == XCB_ATOM_NONE;
+}
+/**
+ * Reads event and every event already queued by xcb after it (up to MPX_EVENT_QUEUE_SIZE), coalesces them and
+ * pushes them onto the event queue
+ */
+static void readXEventBatch(xcb_generic_event_t* event) {
+    uint32_t num = 0;
+    TRACE("Reading events on the X queue");
+    do {
+        if(isReaderWakeupEvent(event))
+            free(event);
+        else
+            eventBatch[num++] = event;
+    } while(num < LEN(eventBatch) && (event = xcb_poll_for_queued_event(dis)));
+    TRACE("Finished reading events off of the X queue");
+    pushEvents(eventBatch, coalesceEvents(eventBatch, num));
+}
+/**
+ * Reads a batch of events with poll if the event queue is being filled by the main thread
+ * @param poll either xcb_poll_for_event or xcb_poll_for_queued_event
+ * @return true if the event queue is not empty
+ */
+static bool fillEventQueue(xcb_generic_event_t* (*poll)(xcb_connection_t*)) {
+    if(isEventQueueEmpty() && !readerThreadRunning) {
+        TRACE("Polling for event");
+        xcb_generic_event_t* event = poll(dis);
+        if(event)
+            readXEventBatch(event);
+    }
+    return !isEventQueueEmpty();
+}
+
+/// Tells the main thread that the reader thread has pushed events or lost the connection
+static void wakeMainThread(void) {
+    uint64_t count = 1;
+    if(write(readerEventFD, &count, sizeof(count)) != sizeof(count))
+        WARN("Could not wake up the main thread; events may be delayed until the next wakeup");
+}
+static void* readXEvents(void* arg) {
+    (void)arg;
+    xcb_generic_event_t* event;
+    while(!readerThreadStopping && (event = xcb_wait_for_event(dis))) {
+        readXEventBatch(event);
+        wakeMainThread();
+    }
+    if(!readerThreadStopping) {
+        readerThreadDisconnected = 1;
+        wakeMainThread();
+    }
+    return NULL;
+}
+static void startReaderThread(void) {
+    if(readerEventFD == -1)
+        readerEventFD = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    // created here because the reader thread cannot create it lazily
+    readerWakeupWindow = getPrivateWindow();
+    readerThreadStopping = readerThreadDisconnected = 0;
+    readerThreadRunning = 1;
+    if(pthread_create(&readerThread, NULL, readXEvents, NULL)) {
+        WARN("Could not start X reader thread");
+        readerThreadRunning = 0;
+    }
+}
+/// Stops the reader thread so the main thread is the producer of the event queue again
+static void stopReaderThread(void) {
+    if(!readerThreadRunning)
+        return;
+    readerThreadStopping = 1;
+    // xcb_wait_for_event only returns once an event arrives
+    xcb_client_message_event_t event = {.response_type = XCB_CLIENT_MESSAGE, .format = 32,
+            .window = readerWakeupWindow, .type = XCB_ATOM_NONE
+        };
+    xcb_send_event(dis, 0, readerWakeupWindow, XCB_EVENT_MASK_NO_EVENT, (char*)&event);
+    flush();
+    pthread_join(readerThread, NULL);
+    readerThreadRunning = 0;
 }
 
 xcb_generic_event_t* getXEvent(void) {
-    xcb_generic_event_t* event = NULL;
-    if(!isEventQueueEmpty())
-        event = popEvent();
-    if(!event)
-        event = pollForXEvent();
-    return event;
+    return fillEventQueue(xcb_poll_for_event) ? popEvent() : NULL;
 }
 
-void processXEvent(xcb_generic_event_t* event) {
+/// @return the UserEvent that event will trigger
+static inline int getXEventType(xcb_generic_event_t* event) {
     int type = event->response_type & 127;
+    return type < LASTEvent ? type : EXTRA_EVENT;
+}
+void processXEvent(xcb_generic_event_t* event) {
     // TODO pre event processing rule
-    type = type < LASTEvent ? type : EXTRA_EVENT;
-    lastEventSequenceNumber = event->sequence;
+    TimeStamp spanStart = TIMELINE_SPAN_START();
+    int type = getXEventType(event);
+    lastEventSequenceNumber = event->full_sequence;
+    processedEvents++;
+    if(isRecordingEvents())
+        recordXEvent(event);
     applyEventRules(type, event);
     free(event);
+    TIMELINE_SPAN_END(spanStart, eventTypeToString(type), "x-event");
 }
 void processXEvents(void) {
     xcb_generic_event_t* event = NULL;
@@ -145,29 +623,55 @@ void processXEvents(void) {
         event = getXEvent();
         if(!event)
             break;
+        addHistogramValue(&queueWait[getXEventType(event)], getTimeNs() - lastEventPushTime);
+        if(isTimelineEnabled())
+            addTimelineCounter("event queue", getEventQueueSize());
         processXEvent(event);
     }
     TRACE("Finished Process X events");
 }
 
 void setIdleProperty() {
-    setWindowPropertyInt(getPrivateWindow(), MPX_IDLE_PROPERTY, XCB_ATOM_CARDINAL, getIdleCount());
+    // the sequence number of a request is the number of requests sent on the connection so far
+    uint32_t values[] = {getIdleCount(), processedEvents, lastTrackedRequestSequence, numberOfXRoundTrips};
+    setWindowProperty(getPrivateWindow(), MPX_IDLE_PROPERTY, XCB_ATOM_CARDINAL, values, LEN(values));
+}
+/// Called when the reader thread has pushed events
+static void onReaderThreadWakeup(int fd) {
+    uint64_t count;
+    // the counter may already have been drained by an earlier wakeup; the queue is processed regardless
+    if(read(fd, &count, sizeof(count)) != sizeof(count))
+        TRACE("Reader thread wakeup without a pending count");
+    processXEvents();
+    if(readerThreadDisconnected && isEventQueueEmpty() && xHandler)
+        removeClosedFDHandler(xHandler);
 }
 void runEventLoop() {
-    xFD = xcb_get_file_descriptor(dis);
-    eventFDInfo.pollFDs[0] = (struct pollfd) {xFD, POLLIN};
-    eventFDInfo.extraEventCallBacks[0] = processXEvents;
+    // the connection may have been reopened since the last run
+    if(xHandler)
+        removeExtraEvent(xHandler);
+    if(X_READER_THREAD) {
+        startReaderThread();
+        xHandler = addExtraEvent(readerEventFD, POLLIN, onReaderThreadWakeup);
+    }
+    else
+        xHandler = addExtraEvent(xcb_get_file_descriptor(dis), POLLIN, processXEvents);
     flush();
     shuttingDown = 0;
     INFO("Starting event loop");
+    // events pushed by the reader thread of a previous run
+    if(!isEventQueueEmpty())
+        processXEvents();
     while(!isShuttingDown()) {
-        assert(isEventQueueEmpty());
+        assert(readerThreadRunning || isEventQueueEmpty());
         if(processEvents(IDLE_TIMEOUT)) {
             continue;
         }
+        if(isRecordingEvents())
+            recordIdle();
         applyEventRules(IDLE, NULL);
         flush();
-        if(pushEvent(xcb_poll_for_queued_event(dis))) {
+        if(fillEventQueue(xcb_poll_for_queued_event)) {
             processXEvents();
             continue;
         }
@@ -179,13 +683,14 @@ void runEventLoop() {
         DEBUG("Idle %d", idle);
         flush();
         if(!isShuttingDown()) {
-            if(pushEvent(xcb_poll_for_event(dis))) {
+            if(fillEventQueue(xcb_poll_for_event)) {
                 processXEvents();
                 continue;
             }
             processEvents(-1);
         }
     }
+    stopReaderThread();
     INFO("Exiting event loop");
 }
 
@@ -8,11 +8,51 @@
 #include <stdbool.h>
 #include <xcb/xcb.h>
 
+#include "util/histogram.h"
+
+/// max number of events read off the X connection and coalesced at a time
 #define MPX_EVENT_QUEUE_SIZE (1 << 10)
 
 
-void addExtraEvent(int fd, int mask,  void(*callBack)());
+/// Handle for a callback registered with addExtraEvent
+typedef struct FDHandler FDHandler;
+/**
+ * Calls callBack(fd, revents) whenever fd has any of the poll events in mask.
+ * An fd may be registered any number of times. If fd hangs up or has an error, the callback is removed.
+ * Closing fd does not remove its callbacks: epoll silently drops closed fds without reporting POLLNVAL, so the
+ * handler would never fire again yet still count towards getNumberOfExtraEvents. Callers must call removeExtraEvent
+ * before closing fd.
+ *
+ * @param fd
+ * @param mask poll events like POLLIN
+ * @param callBack
+ * @return a handle that can be passed to removeExtraEvent or NULL if fd cannot be polled
+ */
+FDHandler* addExtraEvent(int fd, int mask,  void(*callBack)());
+/**
+ * Like addExtraEvent but callBack is called as callBack(fd, revents, userData)
+ *
+ * @param edgeTriggered if true, callBack will only be called when new events arrive instead of whenever the events
+ * are pending. An fd is only edge triggered if every callback for it is. Ignored when built with NO_EPOLL
+ * @param userData
+ */
+FDHandler* addExtraEventWithData(int fd, int mask, bool edgeTriggered, void(*callBack)(), void* userData);
+/**
+ * Stops calling the callback of handler. Safe to call from any callback.
+ * Removing the last handler requests a shutdown since the event loop would have nothing left to wait on.
+ * @param handler a handle returned by addExtraEvent that has not been removed
+ */
+void removeExtraEvent(FDHandler* handler);
+/**
+ * @return the number of callbacks registered with addExtraEvent including the one for the X connection
+ */
+uint32_t getNumberOfExtraEvents(void);
 
+/**
+ * Publishes the idle count, the number of processed events, the number of X requests sent and the number of round
+ * trips as MPX_IDLE_PROPERTY.
+ * The number of requests is lastTrackedRequestSequence so publishing it doesn't cost an extra request
+ */
 void setIdleProperty();
 void addXIEventSupport();
 
@@ -28,6 +68,10 @@ int isSyntheticEvent(void* event);
  * Returns a monotonically increasing counter indicating the number of times the event loop has been idle. Being idle means event loop has nothing to do at the moment which means it has responded to all prior events
 */
 int getIdleCount(void);
+/**
+ * @return the number of X events that have been passed to processXEvent
+ */
+uint32_t getNumberOfProcessedEvents(void);
 /**
  * @return the sequence number of the last event to be queued or 0
  */
@@ -35,9 +79,15 @@ uint32_t getLastDetectedEventSequenceNumber();
 
 /**
  * Continually listens and responds to event and applying corresponding Rules.
- * This method will only exit when the x connection is lost
+ * This method will only exit when the x connection is lost.
+ * If X_READER_THREAD is set, events are read on a separate thread for the duration of the call
  */
 void runEventLoop();
+/**
+ * Applies the Rules for event, appending it to the trace being recorded if any.
+ * @param event an event read off the X connection or from a trace; it is freed
+ */
+void processXEvent(xcb_generic_event_t* event);
 /**
  * To be called when a generic event is received
  * loads info related to the generic event which can be accessed by getLastEvent()
@@ -47,6 +97,10 @@ int loadGenericEvent(xcb_ge_generic_event_t* event);
  * @return the sequence number of the last event that started being processed
  */
 uint16_t getCurrentSequenceNumber(void);
+/**
+ * @return the full 32-bit sequence number of the last event that started being processed
+ */
+uint32_t getCurrentFullSequenceNumber(void);
 
 
 
@@ -66,7 +120,43 @@ bool isShuttingDown(void);
  */
 void addShutdownOnIdleRule();
 
+/**
+ * @return the number of events that have been read off the X connection but not processed
+ */
 int getEventQueueSize();
+/**
+ * @return true if getEventQueueSize() is 0
+ */
+bool isEventQueueEmpty();
+
+/**
+ * Drops events that are superseded by a later event in the same batch.
+ * A ConfigureNotify is superseded by a later ConfigureNotify for the same window, a PropertyNotify by one for the same
+ * window and atom and an XI Motion event by one for the same window and device. Synthetic events are only coalesced
+ * with other synthetic events.
+ * Events are never coalesced across a Create, Destroy, Map, Unmap or Reparent notify or a MapRequest.
+ *
+ * @param events the batch of events in the order they were received; dropped events are freed and the rest are
+ * shifted forward
+ * @param num the number of events
+ * @return the new number of events
+ * @see COALESCE_EVENT_TYPES
+ */
+uint32_t coalesceEvents(xcb_generic_event_t** events, uint32_t num);
+/**
+ * @param type the event type the events would have triggered
+ * @return the number of events of type dropped by coalesceEvents
+ */
+uint32_t getNumberOfCoalescedEvents(int type);
+/**
+ * @param type a regular X event type (less than LASTEvent)
+ * @return the time (ns) events of type spent between being read off the X connection and being processed
+ */
+const Histogram* getEventQueueWait(int type);
+/**
+ * Clears the histograms returned by getEventQueueWait and the counts returned by getNumberOfCoalescedEvents
+ */
+void clearEventQueueStats(void);
 
 #endif
 
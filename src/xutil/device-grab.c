@@ -39,7 +39,7 @@ int grabDevice(MasterID deviceID, uint32_t maskValue) {
     assert(!isSpecialID(deviceID));
     INFO("Grabbing device %d with mask %d", deviceID, maskValue);
     xcb_input_xi_grab_device_reply_t* reply;
-    reply = xcb_input_xi_grab_device_reply(dis, xcb_input_xi_grab_device(dis, root, XCB_CURRENT_TIME, XCB_NONE, deviceID, XCB_INPUT_GRAB_MODE_22_ASYNC, XCB_INPUT_GRAB_MODE_22_ASYNC, 1,  1, &maskValue), NULL);
+    reply = X_ROUND_TRIP(xcb_input_xi_grab_device_reply(dis, xcb_input_xi_grab_device(dis, root, XCB_CURRENT_TIME, XCB_NONE, deviceID, XCB_INPUT_GRAB_MODE_22_ASYNC, XCB_INPUT_GRAB_MODE_22_ASYNC, 1,  1, &maskValue), NULL));
     int status = reply->status;
     free(reply);
     return status;
@@ -56,7 +56,7 @@ int grabDetail(MasterID deviceID, uint32_t detail, uint32_t mod, uint32_t maskVa
     int size = ignoreMod ? LEN(modifiers) : LEN(modifiers) / 2;
     xcb_input_grab_type_t grabType = getKeyboardMask(maskValue) ? XCB_INPUT_GRAB_TYPE_KEYCODE: XCB_INPUT_GRAB_TYPE_BUTTON;
     xcb_input_xi_passive_grab_device_reply_t *reply;
-    reply = xcb_input_xi_passive_grab_device_reply(dis, xcb_input_xi_passive_grab_device(dis,XCB_CURRENT_TIME,root,XCB_CURSOR_NONE, detail, deviceID, size, 1, grabType, XCB_INPUT_GRAB_MODE_22_SYNC, XCB_INPUT_GRAB_MODE_22_SYNC, XCB_INPUT_GRAB_OWNER_OWNER, &maskValue, modifiers), NULL);
+    reply = X_ROUND_TRIP(xcb_input_xi_passive_grab_device_reply(dis, xcb_input_xi_passive_grab_device(dis,XCB_CURRENT_TIME,root,XCB_CURSOR_NONE, detail, deviceID, size, 1, grabType, XCB_INPUT_GRAB_MODE_22_SYNC, XCB_INPUT_GRAB_MODE_22_SYNC, XCB_INPUT_GRAB_OWNER_OWNER, &maskValue, modifiers), NULL));
 
     int errors = LEN(modifiers);
     if(reply) {
@@ -86,8 +86,9 @@ void replayKeyboardEvent() {
 
 void unfreezeServerEvents() {
     TRACE("unfreezing events");
-    catchError(xcb_input_allow_device_events_checked(dis, XCB_CURRENT_TIME, XCB_INPUT_EVENT_MODE_ASYNC_DEVICE, getActiveMaster()->id));
-    catchError(xcb_input_allow_device_events_checked(dis, XCB_CURRENT_TIME, XCB_INPUT_EVENT_MODE_ASYNC_PAIRED_DEVICE, getActiveMaster()->id));
+    // errors will be logged when they arrive; waiting for them would add a round trip to every device event
+    xcb_input_allow_device_events(dis, XCB_CURRENT_TIME, XCB_INPUT_EVENT_MODE_ASYNC_DEVICE, getActiveMaster()->id);
+    xcb_input_allow_device_events(dis, XCB_CURRENT_TIME, XCB_INPUT_EVENT_MODE_ASYNC_PAIRED_DEVICE, getActiveMaster()->id);
 }
 
 int registerForWindowEvents(WindowID window, int mask) {
@@ -8,6 +8,9 @@
 
 #include <stdio.h>
 
+#include "../util/arraylist.h"
+#include "../util/hashmap.h"
+#include "../util/string-table.h"
 #include "xsession.h"
 
 
@@ -21,21 +24,113 @@ void dumpAtoms(const xcb_atom_t* atoms, int numberOfAtoms) {
     printf("\n");
 }
 
-xcb_atom_t getAtom(const char* name) {
-    if(!name)return XCB_ATOM_NONE;
-    xcb_intern_atom_reply_t* reply;
-    reply = xcb_intern_atom_reply(dis, xcb_intern_atom(dis, 0, strlen(name), name), NULL);
-    xcb_atom_t atom = reply->atom;
+/// An atom and its name; atoms never change for the lifetime of the X server so they can be cached
+typedef struct AtomCacheEntry {
+    xcb_atom_t atom;
+    /// interned name of the atom
+    const char* name;
+    /// the next entry whose name has the same hash
+    struct AtomCacheEntry* next;
+} AtomCacheEntry;
+/// all cached entries
+static ArrayList atomCache;
+/// atom -> AtomCacheEntry
+static HashMap atomCacheByAtom;
+/// hash of the name -> AtomCacheEntry chain
+static HashMap atomCacheByName;
+
+static uint32_t hashAtomName(const char* name) {
+    uint32_t hash = 2166136261U;
+    for(; *name; name++)
+        hash = (hash ^ (uint8_t) * name) * 16777619U;
+    return hash;
+}
+static xcb_atom_t getCachedAtom(const char* name) {
+    for(AtomCacheEntry* entry = getValue(&atomCacheByName, hashAtomName(name)); entry; entry = entry->next)
+        if(strcmp(entry->name, name) == 0)
+            return entry->atom;
+    return XCB_ATOM_NONE;
+}
+const char* getCachedAtomName(xcb_atom_t atom) {
+    AtomCacheEntry* entry = getValue(&atomCacheByAtom, atom);
+    return entry ? entry->name : NULL;
+}
+static void cacheAtom(xcb_atom_t atom, const char* name) {
+    if(atom == XCB_ATOM_NONE || getValue(&atomCacheByAtom, atom))
+        return;
+    AtomCacheEntry* entry = malloc(sizeof(AtomCacheEntry));
+    uint32_t hash = hashAtomName(name);
+    *entry = (AtomCacheEntry) {atom, internString(name), getValue(&atomCacheByName, hash)};
+    putValue(&atomCacheByName, hash, entry);
+    putValue(&atomCacheByAtom, atom, entry);
+    addElement(&atomCache, entry);
+}
+void clearAtomCache(void) {
+    FOR_EACH(AtomCacheEntry*, entry, &atomCache) {
+        releaseString(entry->name);
+        free(entry);
+    }
+    clearArray(&atomCache);
+    clearMap(&atomCacheByAtom);
+    clearMap(&atomCacheByName);
+}
+
+/// Waits for the reply of cookie and caches the result
+static xcb_atom_t getAtomReply(xcb_intern_atom_cookie_t cookie, const char* name) {
+    xcb_intern_atom_reply_t* reply = X_REPLY(xcb_intern_atom_reply(dis, cookie, NULL));
+    xcb_atom_t atom = reply ? reply->atom : XCB_ATOM_NONE;
     free(reply);
+    cacheAtom(atom, name);
     return atom;
 }
+xcb_atom_t getAtom(const char* name) {
+    if(!name)return XCB_ATOM_NONE;
+    xcb_atom_t atom = getCachedAtom(name);
+    if(atom)
+        return atom;
+    countXRoundTrip();
+    return getAtomReply(xcb_intern_atom(dis, 0, strlen(name), name), name);
+}
+void createAtoms(const AtomBinding* bindings, int num) {
+    xcb_intern_atom_cookie_t cookies[num];
+    bool sentRequests = 0;
+    for(int i = 0; i < num; i++) {
+        *bindings[i].atom = getCachedAtom(bindings[i].name);
+        if(!*bindings[i].atom) {
+            cookies[i] = xcb_intern_atom(dis, 0, strlen(bindings[i].name), bindings[i].name);
+            sentRequests = 1;
+        }
+    }
+    if(sentRequests)
+        countXRoundTrip();
+    for(int i = 0; i < num; i++)
+        if(!*bindings[i].atom)
+            *bindings[i].atom = getAtomReply(cookies[i], bindings[i].name);
+}
 char* getAtomName(xcb_atom_t atom, char* buffer) {
+    const char* name = getCachedAtomName(atom);
+    if(!name) {
+        countXRoundTrip();
+        return getAtomNameReply(atom, xcb_get_atom_name(dis, atom), buffer);
+    }
+    if(!buffer)
+        buffer = __buffer;
+    strncpy(buffer, name, MAX_NAME_LEN - 1);
+    buffer[MAX_NAME_LEN - 1] = 0;
+    return buffer;
+}
+char* getAtomNameReply(xcb_atom_t atom, xcb_get_atom_name_cookie_t cookie, char* buffer) {
     if(!buffer)
         buffer = __buffer;
-    xcb_get_atom_name_reply_t* valueReply = xcb_get_atom_name_reply(dis, xcb_get_atom_name(dis, atom), NULL);
+    xcb_get_atom_name_reply_t* valueReply = X_REPLY(xcb_get_atom_name_reply(dis, cookie, NULL));
     if(valueReply) {
-        strncpy(buffer, xcb_get_atom_name_name(valueReply), MIN_NAME_LEN(valueReply->name_len));
-        buffer[MIN_NAME_LEN(valueReply->name_len)] = 0;
+        int len = xcb_get_atom_name_name_length(valueReply);
+        char name[len + 1];
+        memcpy(name, xcb_get_atom_name_name(valueReply), len);
+        name[len] = 0;
+        cacheAtom(atom, name);
+        strncpy(buffer, name, MIN_NAME_LEN(len));
+        buffer[MIN_NAME_LEN(len)] = 0;
         free(valueReply);
     }
     else {
@@ -47,7 +142,7 @@ char* getAtomName(xcb_atom_t atom, char* buffer) {
 xcb_get_property_reply_t* getWindowProperty(WindowID win, xcb_atom_t atom, xcb_atom_t type) {
     xcb_get_property_reply_t* reply;
     xcb_get_property_cookie_t cookie = xcb_get_property(dis, 0, win, atom, type, 0, -1);
-    if((reply = xcb_get_property_reply(dis, cookie, NULL)))
+    if((reply = X_ROUND_TRIP(xcb_get_property_reply(dis, cookie, NULL))))
         if(xcb_get_property_value_length(reply))
             return reply;
         else free(reply);
@@ -3,6 +3,7 @@
 #include <xcb/xcb_icccm.h>
 
 #include "../util/logger.h"
+#include "../util/string-table.h"
 #include "../util/time.h"
 #include "../windows.h"
 #include "window-properties.h"
@@ -24,10 +25,9 @@ void setWindowTitle(WindowID win, const char* title) {
 void setWindowTypes(WindowID win, xcb_atom_t* atoms, int num) {
     xcb_ewmh_set_wm_window_type(ewmh, win, num, atoms);
 }
-bool getClassInfo(WindowID win, char* className, char* instanceName) {
+static bool getClassInfoReply(xcb_get_property_cookie_t cookie, char* className, char* instanceName) {
     xcb_icccm_get_wm_class_reply_t prop;
-    xcb_get_property_cookie_t cookie = xcb_icccm_get_wm_class(dis, win);
-    if(xcb_icccm_get_wm_class_reply(dis, cookie, &prop, NULL)) {
+    if(X_REPLY(xcb_icccm_get_wm_class_reply(dis, cookie, &prop, NULL))) {
         strcpy(className, prop.class_name);
         strcpy(instanceName, prop.instance_name);
         xcb_icccm_get_wm_class_reply_wipe(&prop);
@@ -35,41 +35,51 @@ bool getClassInfo(WindowID win, char* className, char* instanceName) {
     }
     return 0;
 }
-bool getWindowTitle(WindowID win, char* title) {
+bool getClassInfo(WindowID win, char* className, char* instanceName) {
+    countXRoundTrip();
+    return getClassInfoReply(xcb_icccm_get_wm_class(dis, win), className, instanceName);
+}
+/// Loads the EWMH title or, if it is not set, the ICCCM one; both replies are always consumed
+static bool getWindowTitleReply(xcb_get_property_cookie_t cookie, xcb_get_property_cookie_t legacyCookie,
+    char* title) {
     xcb_ewmh_get_utf8_strings_reply_t wtitle;
-    xcb_get_property_cookie_t cookie = xcb_ewmh_get_wm_name(ewmh, win);
-    if(xcb_ewmh_get_wm_name_reply(ewmh, cookie, &wtitle, NULL)) {
+    xcb_icccm_get_text_property_reply_t icccName;
+    if(X_REPLY(xcb_ewmh_get_wm_name_reply(ewmh, cookie, &wtitle, NULL))) {
+        xcb_discard_reply(dis, legacyCookie.sequence);
         strncpy(title, wtitle.strings, MIN_NAME_LEN(wtitle.strings_len));
         title[MIN_NAME_LEN(wtitle.strings_len)] = 0;
         xcb_ewmh_get_utf8_strings_reply_wipe(&wtitle);
         return 1;
     }
-    else {
-        xcb_icccm_get_text_property_reply_t icccName;
-        cookie = xcb_icccm_get_wm_name(dis, win);
-        if(xcb_icccm_get_wm_name_reply(dis, cookie, &icccName, NULL)) {
-            strncpy(title, icccName.name, MIN_NAME_LEN(icccName.name_len));
-            title[MIN_NAME_LEN(icccName.name_len)] = 0;
-            xcb_icccm_get_text_property_reply_wipe(&icccName);
-            return 1;
-        }
+    else if(X_REPLY(xcb_icccm_get_wm_name_reply(dis, legacyCookie, &icccName, NULL))) {
+        strncpy(title, icccName.name, MIN_NAME_LEN(icccName.name_len));
+        title[MIN_NAME_LEN(icccName.name_len)] = 0;
+        xcb_icccm_get_text_property_reply_wipe(&icccName);
+        return 1;
     }
     return 0;
 }
-xcb_atom_t getWindowType(WindowID win) {
+bool getWindowTitle(WindowID win, char* title) {
+    countXRoundTrip();
+    return getWindowTitleReply(xcb_ewmh_get_wm_name(ewmh, win), xcb_icccm_get_wm_name(dis, win), title);
+}
+static xcb_atom_t getWindowTypeReply(xcb_get_property_cookie_t cookie) {
     xcb_ewmh_get_atoms_reply_t name;
     xcb_atom_t atom = 0;
-    if(xcb_ewmh_get_wm_window_type_reply(ewmh,
-            xcb_ewmh_get_wm_window_type(ewmh, win), &name, NULL)) {
+    if(X_REPLY(xcb_ewmh_get_wm_window_type_reply(ewmh, cookie, &name, NULL))) {
         atom = name.atoms[0];
         xcb_ewmh_get_atoms_reply_wipe(&name);
     }
     return atom;
 }
+xcb_atom_t getWindowType(WindowID win) {
+    countXRoundTrip();
+    return getWindowTypeReply(xcb_ewmh_get_wm_window_type(ewmh, win));
+}
 
-void loadWindowHints(WindowInfo* winInfo) {
+static void loadWindowHintsReply(WindowInfo* winInfo, xcb_get_property_cookie_t cookie) {
     xcb_icccm_wm_hints_t hints;
-    if(xcb_icccm_get_wm_hints_reply(dis, xcb_icccm_get_wm_hints(dis, winInfo->id), &hints, NULL)) {
+    if(X_REPLY(xcb_icccm_get_wm_hints_reply(dis, cookie, &hints, NULL))) {
         if(xcb_icccm_wm_hints_get_urgency(&hints)) {
             addMask(winInfo, URGENT_MASK);
         }
@@ -80,7 +90,144 @@ void loadWindowHints(WindowInfo* winInfo) {
             removeMask(winInfo, INPUT_MASK);
     }
 }
+void loadWindowHints(WindowInfo* winInfo) {
+    countXRoundTrip();
+    loadWindowHintsReply(winInfo, xcb_icccm_get_wm_hints(dis, winInfo->id));
+}
+
+static void loadWindowProtocolsReply(WindowInfo* winInfo, xcb_get_property_cookie_t cookie) {
+    xcb_icccm_get_wm_protocols_reply_t reply;
+    winInfo->supportsDeleteWindow = 0;
+    if(X_REPLY(xcb_icccm_get_wm_protocols_reply(dis, cookie, &reply, NULL))) {
+        for(uint32_t i = 0; i < reply.atoms_len; i++)
+            if(reply.atoms[i] == WM_DELETE_WINDOW)
+                winInfo->supportsDeleteWindow = 1;
+        xcb_icccm_get_wm_protocols_reply_wipe(&reply);
+    }
+}
+void loadWindowProtocols(WindowInfo* winInfo) {
+    countXRoundTrip();
+    loadWindowProtocolsReply(winInfo, xcb_icccm_get_wm_protocols(dis, winInfo->id, ewmh->WM_PROTOCOLS));
+}
+
+static xcb_get_property_cookie_t requestWindowRole(WindowID win) {
+    return xcb_get_property(dis, 0, win, WM_WINDOW_ROLE, XCB_ATOM_STRING, 0, -1);
+}
+void requestWindowProperties(WindowID win, WindowPropertyCookies* cookies) {
+    *cookies = (WindowPropertyCookies) {
+        .classInfo = xcb_icccm_get_wm_class(dis, win),
+        .title = xcb_ewmh_get_wm_name(ewmh, win),
+        .legacyTitle = xcb_icccm_get_wm_name(dis, win),
+        .transientFor = xcb_icccm_get_wm_transient_for(dis, win),
+        .type = xcb_ewmh_get_wm_window_type(ewmh, win),
+        .hints = xcb_icccm_get_wm_hints(dis, win),
+        .protocols = xcb_icccm_get_wm_protocols(dis, win, ewmh->WM_PROTOCOLS),
+        .role = requestWindowRole(win),
+        .geometry = xcb_get_geometry(dis, win),
+    };
+}
+void collectWindowProperties(WindowInfo* winInfo, WindowPropertyCookies* cookies) {
+    TRACE("collecting window properties %d", winInfo->id);
+    WindowProperties* properties = getWindowProperties(winInfo);
+    char className[MAX_NAME_LEN], instanceName[MAX_NAME_LEN];
+    if(getClassInfoReply(cookies->classInfo, className, instanceName)) {
+        replaceInternedString(&properties->className, className);
+        replaceInternedString(&properties->instanceName, instanceName);
+    }
+    getWindowTitleReply(cookies->title, cookies->legacyTitle, properties->title);
+    xcb_window_t prop;
+    if(X_REPLY(xcb_icccm_get_wm_transient_for_reply(dis, cookies->transientFor, &prop, NULL)))
+        winInfo->transientFor = prop;
+    winInfo->type = getWindowTypeReply(cookies->type);
+    if(!winInfo->type) {
+        TRACE("could not read window type; using default based on transient being set to %d",
+            winInfo->transientFor);
+        winInfo->type = winInfo->transientFor ? ewmh->_NET_WM_WINDOW_TYPE_DIALOG : ewmh->_NET_WM_WINDOW_TYPE_NORMAL;
+        winInfo->implicitType = 1;
+    }
+    if(winInfo->type == ewmh->_NET_WM_WINDOW_TYPE_DOCK) {
+        DEBUG("Marking window as dock");
+        winInfo->dock = 1;
+    }
+    loadWindowHintsReply(winInfo, cookies->hints);
+    loadWindowProtocolsReply(winInfo, cookies->protocols);
+    // TODO loadWindowSizeHints(winInfo);
+    xcb_get_property_reply_t* role = X_REPLY(xcb_get_property_reply(dis, cookies->role, NULL));
+    if(role && xcb_get_property_value_length(role)) {
+        char buffer[MAX_NAME_LEN];
+        int len = MIN_NAME_LEN(xcb_get_property_value_length(role));
+        strncpy(buffer, xcb_get_property_value(role), len);
+        buffer[len] = 0;
+        replaceInternedString(&properties->role, buffer);
+    }
+    else
+        replaceInternedString(&properties->role, "");
+    free(role);
+    xcb_get_geometry_reply_t* geometry = cookies->geometry.sequence ?
+        X_REPLY(xcb_get_geometry_reply(dis, cookies->geometry, NULL)) : NULL;
+    if(geometry) {
+        setGeometry(winInfo, &geometry->x);
+        free(geometry);
+    }
+}
 
+WindowPropertyCookies* prefetchWindowProperties(WindowID win) {
+    TRACE("prefetching window properties %d", win);
+    WindowPropertyCookies* cookies = malloc(sizeof(WindowPropertyCookies));
+    requestWindowProperties(win, cookies);
+    return cookies;
+}
+void discardWindowPropertyCookies(WindowPropertyCookies* cookies) {
+    xcb_get_property_cookie_t* propertyCookies[] = {&cookies->classInfo, &cookies->title, &cookies->legacyTitle,
+            &cookies->transientFor, &cookies->type, &cookies->hints, &cookies->protocols, &cookies->role
+        };
+    for(int i = 0; i < LEN(propertyCookies); i++)
+        xcb_discard_reply(dis, propertyCookies[i]->sequence);
+    discardPrefetchedGeometry(cookies);
+    free(cookies);
+}
+/**
+ * The sequence number of an event is that of the last request the server processed before generating it, so a reply
+ * to a request that was processed after the event already reflects the change
+ *
+ * @return true if the reply of cookie predates the event with the given sequence number and was discarded
+ */
+static bool discardIfStale(xcb_get_property_cookie_t cookie, uint32_t sequence) {
+    // cookies can outlive far more than 32k requests so the 16-bit sequence of the event is not enough
+    if((int32_t)(sequence - cookie.sequence) < 0)
+        return 0;
+    xcb_discard_reply(dis, cookie.sequence);
+    return 1;
+}
+bool refreshStaleWindowPropertyCookie(WindowPropertyCookies* cookies, WindowID win, xcb_atom_t atom,
+    uint32_t sequence) {
+    if(atom == XCB_ATOM_WM_CLASS && discardIfStale(cookies->classInfo, sequence))
+        cookies->classInfo = xcb_icccm_get_wm_class(dis, win);
+    else if(atom == ewmh->_NET_WM_NAME && discardIfStale(cookies->title, sequence))
+        cookies->title = xcb_ewmh_get_wm_name(ewmh, win);
+    else if(atom == XCB_ATOM_WM_NAME && discardIfStale(cookies->legacyTitle, sequence))
+        cookies->legacyTitle = xcb_icccm_get_wm_name(dis, win);
+    else if(atom == XCB_ATOM_WM_TRANSIENT_FOR && discardIfStale(cookies->transientFor, sequence))
+        cookies->transientFor = xcb_icccm_get_wm_transient_for(dis, win);
+    else if(atom == ewmh->_NET_WM_WINDOW_TYPE && discardIfStale(cookies->type, sequence))
+        cookies->type = xcb_ewmh_get_wm_window_type(ewmh, win);
+    else if(atom == XCB_ATOM_WM_HINTS && discardIfStale(cookies->hints, sequence))
+        cookies->hints = xcb_icccm_get_wm_hints(dis, win);
+    else if(atom == ewmh->WM_PROTOCOLS && discardIfStale(cookies->protocols, sequence))
+        cookies->protocols = xcb_icccm_get_wm_protocols(dis, win, ewmh->WM_PROTOCOLS);
+    else if(atom == WM_WINDOW_ROLE && discardIfStale(cookies->role, sequence))
+        cookies->role = requestWindowRole(win);
+    else
+        return 0;
+    TRACE("Prefetched property %d of window %d was stale", atom, win);
+    return 1;
+}
+void discardPrefetchedGeometry(WindowPropertyCookies* cookies) {
+    if(cookies->geometry.sequence) {
+        xcb_discard_reply(dis, cookies->geometry.sequence);
+        cookies->geometry.sequence = 0;
+    }
+}
 
 /* TODO
 static void loadWindowSizeHints(WindowInfo* winInfo) {
@@ -92,31 +239,6 @@ static void loadWindowSizeHints(WindowInfo* winInfo) {
 }
 */
 
-/**
- * Load window protocols like WM_DELETE_WINDOW
- * @param winInfo
- */
-/*TODO
-static void loadProtocols(WindowInfo* winInfo) {
-    xcb_icccm_get_wm_protocols_reply_t reply;
-    if(xcb_icccm_get_wm_protocols_reply(dis,
-            xcb_icccm_get_wm_protocols(dis, winInfo->id, ewmh->WM_PROTOCOLS),
-            &reply, NULL)) {
-        TRACE("Found %d protocols", reply.atoms_len);
-        TRACE(getAtomsAsString(reply.atoms, reply.atoms_len));
-        for(uint32_t i = 0; i < reply.atoms_len; i++)
-            if(reply.atoms[i] == WM_DELETE_WINDOW)
-                addMask(winInfo, WM_DELETE_WINDOW_MASK);
-            else if(reply.atoms[i] == ewmh->_NET_WM_PING)
-                addMask(winInfo, WM_PING_MASK);
-            else if(reply.atoms[i] == WM_TAKE_FOCUS)
-                addMask(winInfo, WM_TAKE_FOCUS_MASK);
-            else
-                DEBUG("Unsupported protocol detected %d", reply.atoms[i]);
-        xcb_icccm_get_wm_protocols_reply_wipe(&reply);
-    }
-}
-*/
 
 void setWindowRole(WindowID wid, const char* s) {
     setWindowPropertyString(wid, WM_WINDOW_ROLE, XCB_ATOM_STRING, s);
@@ -150,26 +272,31 @@ void resetBorder(WindowID win) {
 }
 
 //TODO consider moving to devices
+void (*onFocusFailure)(WindowID win) = NULL;
+static void onFocusError(xcb_generic_error_t* e, void* arg) {
+    DEBUG("Failed to focus window %d", (WindowID)(uintptr_t)arg);
+    if(onFocusFailure)
+        onFocusFailure((WindowID)(uintptr_t)arg);
+}
 int focusWindowAsMaster(WindowID win, Master* master) {
     DEBUG("Trying to set focus to %d for master %d", win, master->id);
     assert(win);
-    xcb_void_cookie_t cookie = xcb_input_xi_set_focus_checked(dis, win, XCB_CURRENT_TIME, getKeyboardID(master));
-    return !catchError(cookie);
+    onXError(xcb_input_xi_set_focus(dis, win, XCB_CURRENT_TIME, getKeyboardID(master)), onFocusError,
+        (void*)(uintptr_t)win);
+    return 1;
 }
 int focusWindowInfoAsMaster(WindowInfo* winInfo, Master* master) {
     if(!hasPartOfMask(winInfo, INPUT_MASK))
         return 0;
-    if(focusWindowAsMaster(winInfo->id, master)) {
-        onWindowFocus(winInfo->id);
-        return 1;
-    }
-    return 0;
+    focusWindowAsMaster(winInfo->id, master);
+    onWindowFocusForMaster(winInfo->id, master);
+    return 1;
 }
 
 uint32_t getUserTime(WindowID win) {
     uint32_t timestamp = 1;
-    xcb_ewmh_get_wm_user_time_window_reply(ewmh, xcb_ewmh_get_wm_user_time_window(ewmh, win), &win, NULL);
-    xcb_ewmh_get_wm_user_time_reply(ewmh, xcb_ewmh_get_wm_user_time(ewmh, win), &timestamp, NULL);
+    X_ROUND_TRIP(xcb_ewmh_get_wm_user_time_window_reply(ewmh, xcb_ewmh_get_wm_user_time_window(ewmh, win), &win, NULL));
+    X_ROUND_TRIP(xcb_ewmh_get_wm_user_time_reply(ewmh, xcb_ewmh_get_wm_user_time(ewmh, win), &timestamp, NULL));
     return timestamp;
 }
 
@@ -192,33 +319,41 @@ WindowID createWindow(WindowID parent, xcb_window_class_t clazz, uint32_t mask,
 void destroyWindowInfo(WindowInfo* winInfo) {
     destroyWindow(winInfo->id);
 }
-int destroyWindow(WindowID win) {
+void destroyWindow(WindowID win) {
     assert(win);
     DEBUG("Destroying window %d", win);
-    return catchError(xcb_destroy_window_checked(dis, win));
+    trackRequest(xcb_destroy_window(dis, win));
 }
 WindowID mapWindow(WindowID id) {
     TRACE("Mapping %d", id);
-    xcb_map_window(dis, id);
+    trackRequest(xcb_map_window(dis, id));
     return id;
 }
 void unmapWindow(WindowID id) {
     TRACE("UnMapping %d", id);
-    xcb_unmap_window(dis, id);
+    trackRequest(xcb_unmap_window(dis, id));
 }
 
-int killClientOfWindow(WindowID win) {
+void killClientOfWindow(WindowID win) {
     assert(win);
     DEBUG("Killing window %d", win);
-    return catchError(xcb_kill_client_checked(dis, win));
+    trackRequest(xcb_kill_client(dis, win));
 }
-void killClientOfWindowInfo(WindowInfo* winInfo) {
-    killClientOfWindow(winInfo->id);
+void sendDeleteWindowRequest(WindowID win) {
+    DEBUG("Sending WM_DELETE_WINDOW to %d", win);
+    xcb_client_message_event_t event = {
+        .response_type = XCB_CLIENT_MESSAGE,
+        .format = 32,
+        .window = win,
+        .type = ewmh->WM_PROTOCOLS,
+        .data.data32 = {WM_DELETE_WINDOW, XCB_CURRENT_TIME},
+    };
+    trackRequest(xcb_send_event(dis, 0, win, XCB_EVENT_MASK_NO_EVENT, (char*)&event));
 }
 
 Rect getRealGeometry(WindowID id) {
     Rect rect = {0};
-    xcb_get_geometry_reply_t* reply = xcb_get_geometry_reply(dis, xcb_get_geometry(dis, id), NULL);
+    xcb_get_geometry_reply_t* reply = X_ROUND_TRIP(xcb_get_geometry_reply(dis, xcb_get_geometry(dis, id), NULL));
     if(reply) {
         rect = *(Rect*)&reply->x;
         free(reply);
@@ -227,7 +362,7 @@ Rect getRealGeometry(WindowID id) {
 }
 uint16_t getWindowBorder(WindowID id) {
     int border = 0;
-    xcb_get_geometry_reply_t* reply = xcb_get_geometry_reply(dis, xcb_get_geometry(dis, id), NULL);
+    xcb_get_geometry_reply_t* reply = X_ROUND_TRIP(xcb_get_geometry_reply(dis, xcb_get_geometry(dis, id), NULL));
     if(reply) {
         border = reply->border_width;
         free(reply);
@@ -51,6 +51,71 @@ void setWindowTypes(WindowID win, xcb_atom_t* atoms, int num);
  */
 static inline void setWindowType(WindowID win, xcb_atom_t atom) {setWindowTypes(win, &atom, 1);}
 
+/**
+ * The requests sent by requestWindowProperties
+ */
+typedef struct WindowPropertyCookies {
+    xcb_get_property_cookie_t classInfo;
+    /// the ICCCM title is requested with the EWMH one so falling back to it doesn't cost another round trip
+    xcb_get_property_cookie_t title;
+    xcb_get_property_cookie_t legacyTitle;
+    xcb_get_property_cookie_t transientFor;
+    xcb_get_property_cookie_t type;
+    xcb_get_property_cookie_t hints;
+    xcb_get_property_cookie_t protocols;
+    xcb_get_property_cookie_t role;
+    xcb_get_geometry_cookie_t geometry;
+} WindowPropertyCookies;
+/**
+ * Sends every request needed to load the properties of win without waiting for any reply
+ *
+ * @param win
+ * @param cookies
+ * @see collectWindowProperties
+ */
+void requestWindowProperties(WindowID win, WindowPropertyCookies* cookies);
+/**
+ * Waits for the replies to the requests sent by requestWindowProperties and stores them in winInfo.
+ * Everything but the name of the type is loaded and the geometry is skipped if it was discarded.
+ * The caller is responsible for counting the round trip.
+ *
+ * @param winInfo
+ * @param cookies
+ */
+void collectWindowProperties(WindowInfo* winInfo, WindowPropertyCookies* cookies);
+/**
+ * Sends the requests of requestWindowProperties ahead of time so loading the properties later only has to collect
+ * the replies
+ *
+ * @param win
+ * @return cookies to be stored in WindowInfo::pendingProperties
+ */
+WindowPropertyCookies* prefetchWindowProperties(WindowID win);
+/**
+ * Discards the replies of every request in cookies and frees it
+ *
+ * @param cookies the result of prefetchWindowProperties
+ */
+void discardWindowPropertyCookies(WindowPropertyCookies* cookies);
+/**
+ * Called when atom of win changed.
+ * If the prefetched reply for atom could have been generated before the change, it is discarded and requested again.
+ *
+ * @param cookies the result of prefetchWindowProperties
+ * @param win
+ * @param atom the property that changed
+ * @param sequence the full 32-bit sequence number of the PropertyNotify event reporting the change
+ * @return true if a request was resent
+ */
+bool refreshStaleWindowPropertyCookie(WindowPropertyCookies* cookies, WindowID win, xcb_atom_t atom,
+    uint32_t sequence);
+/**
+ * Discards the prefetched geometry; to be called once the geometry is known from a ConfigureNotify event
+ *
+ * @param cookies the result of prefetchWindowProperties
+ */
+void discardPrefetchedGeometry(WindowPropertyCookies* cookies);
+
 /**
  * Loads class and instance name for the given window
  * @param win
@@ -105,18 +170,29 @@ void resetBorder(WindowID win);
  */
 void setWorkspaceNames(char* names[], int numberOfNames);
 
+/**
+ * Called with the window when a focus request sent by focusWindowAsMaster fails
+ */
+extern void (*onFocusFailure)(WindowID win);
 /**
  * Focuses the given window
+ *
+ * The request is sent without waiting for a reply so a return value of 1 only means it was sent. If it fails,
+ * onFocusFailure is called when the error is processed.
+ *
  * @param win the window to focus
  * @param master the master who gets the focus
- * @return 1 iff no error was detected
+ * @return 1
  */
 int focusWindowAsMaster(WindowID win, Master* master);
 static inline int focusWindow(WindowID win) {return focusWindowAsMaster(win, getActiveMaster());}
 /**
  * Focus the given window
  * This method is different from focusWindow in that it allows different protocols for
- * focusing the window based on window masks
+ * focusing the window based on window masks.
+ * The window is recorded as focused by master right away; see focusWindowAsMaster for failures.
+ *
+ * @return 0 if the window doesn't accept input, otherwise 1 since the request can only fail asynchronously
  */
 int focusWindowInfoAsMaster(WindowInfo* winInfo, Master* master);
 static inline int focusWindowInfo(WindowInfo* winInfo) {return focusWindowInfoAsMaster(winInfo, getActiveMaster());}
@@ -138,6 +214,12 @@ xcb_size_hints_t* getWindowSizeHints(WindowInfo* winInfo);
  * @see loadWindowProperties
  */
 void loadWindowHints(WindowInfo* winInfo);
+/**
+ * Loads the WM_PROTOCOLS the window supports
+ * @param winInfo
+ * @see loadWindowProperties
+ */
+void loadWindowProtocols(WindowInfo* winInfo);
 
 /**
  * @param id
@@ -164,16 +246,15 @@ void setUserTime(WindowID win, uint32_t time);
 
 /**
  * Send a kill signal to the client with the window
+ * The request is not checked; any error will be logged when it arrives
  * @param win
- * @return 0 on success or the error
  */
-int killClientOfWindow(WindowID win);
+void killClientOfWindow(WindowID win);
 
 /**
- * Sends a WM_DELETE_WINDOW message or sends a kill requests
- * @param winInfo
- * @see killWindow();
+ * Asks the client of win to close it with a WM_DELETE_WINDOW message
+ * @param win a window that supports WM_DELETE_WINDOW
  */
-void killClientOfWindowInfo(WindowInfo* winInfo);
+void sendDeleteWindowRequest(WindowID win);
 
 #endif
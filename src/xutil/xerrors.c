@@ -10,6 +10,7 @@
 #include "../system.h"
 #include "../util/debug.h"
 #include "../util/logger.h"
+#include "../xevent.h"
 #include "xsession.h"
 
 #define _ADD_EVENT_TYPE_CASE(TYPE) case TYPE: return #TYPE
@@ -29,7 +30,7 @@ const char* opcodeToString(int opcode) {
 }
 
 int catchError(xcb_void_cookie_t cookie) {
-    xcb_generic_error_t* e = xcb_request_check(dis, cookie);
+    xcb_generic_error_t* e = X_ROUND_TRIP(xcb_request_check(dis, cookie));
     int errorCode = 0;
     if(e) {
         errorCode = e->error_code;
@@ -39,7 +40,7 @@ int catchError(xcb_void_cookie_t cookie) {
     return errorCode;
 }
 int catchErrorSilent(xcb_void_cookie_t cookie) {
-    xcb_generic_error_t* e = xcb_request_check(dis, cookie);
+    xcb_generic_error_t* e = X_ROUND_TRIP(xcb_request_check(dis, cookie));
     int errorCode = 0;
     if(e) {
         errorCode = e->error_code;
@@ -47,6 +48,61 @@ int catchErrorSilent(xcb_void_cookie_t cookie) {
     }
     return errorCode;
 }
+/// A request that was sent unchecked along with what to do if it fails
+typedef struct {
+    /// the full sequence number of the request; the 16-bit one wraps too quickly to be compared
+    uint32_t sequence;
+    ErrorHandler handler;
+    void* arg;
+} PendingErrorHandler;
+/// ring of handlers in the order their requests were sent
+static PendingErrorHandler pendingErrorHandlers[MAX_PENDING_ERROR_HANDLERS];
+static uint32_t pendingErrorHandlersStart;
+static uint32_t numPendingErrorHandlers;
+
+static inline PendingErrorHandler* getOldestPendingErrorHandler() {
+    return &pendingErrorHandlers[pendingErrorHandlersStart];
+}
+static inline void removeOldestPendingErrorHandler() {
+    pendingErrorHandlersStart = (pendingErrorHandlersStart + 1) % MAX_PENDING_ERROR_HANDLERS;
+    numPendingErrorHandlers--;
+}
+/**
+ * Errors and events are processed in the order the server sent them, so once something for a later request has been
+ * processed, older requests can no longer fail
+ */
+static void pruneErrorHandlers() {
+    uint32_t sequence = getCurrentFullSequenceNumber();
+    while(numPendingErrorHandlers && (int32_t)(sequence - getOldestPendingErrorHandler()->sequence) > 0)
+        removeOldestPendingErrorHandler();
+}
+void onXError(xcb_void_cookie_t cookie, ErrorHandler handler, void* arg) {
+    trackRequest(cookie);
+    pruneErrorHandlers();
+    if(numPendingErrorHandlers == MAX_PENDING_ERROR_HANDLERS) {
+        WARN("Too many requests waiting for errors; forgetting the handler for seq %d",
+            getOldestPendingErrorHandler()->sequence);
+        removeOldestPendingErrorHandler();
+    }
+    pendingErrorHandlers[(pendingErrorHandlersStart + numPendingErrorHandlers++) % MAX_PENDING_ERROR_HANDLERS] =
+        (PendingErrorHandler) {cookie.sequence, handler, arg};
+}
+uint32_t getNumberOfPendingErrorHandlers(void) {
+    pruneErrorHandlers();
+    return numPendingErrorHandlers;
+}
+void clearErrorHandlers(void) {
+    pendingErrorHandlersStart = numPendingErrorHandlers = 0;
+}
+/// Runs and removes the handler registered for the request that caused e if any
+static void runErrorHandler(xcb_generic_error_t* e) {
+    pruneErrorHandlers();
+    if(numPendingErrorHandlers && getOldestPendingErrorHandler()->sequence == e->full_sequence) {
+        PendingErrorHandler pending = *getOldestPendingErrorHandler();
+        removeOldestPendingErrorHandler();
+        pending.handler(e, pending.arg);
+    }
+}
 void logError(xcb_generic_error_t* e) {
     ERROR("error occurred with seq %d resource %d. Error code: %d %s (%d %d)", e->sequence, e->resource_id, e->error_code,
         opcodeToString(e->major_code), e->major_code, e->minor_code);
@@ -55,4 +111,5 @@ void logError(xcb_generic_error_t* e) {
         LOG_RUN(LOG_LEVEL_DEBUG, printSummary());
         quit(X_ERROR);
     }
+    runErrorHandler(e);
 }
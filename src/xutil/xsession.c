@@ -45,6 +45,20 @@ const int defaultScreenNumber = 0;
 static WindowID compliantWindowManagerIndicatorWindow;
 
 
+uint32_t numberOfXRoundTrips;
+uint32_t lastTrackedRequestSequence;
+static TimeStamp xRoundTripTime;
+TimeStamp getXRoundTripTime(void) {
+    return xRoundTripTime;
+}
+void endXRoundTrip(TimeStamp start, const char* caller) {
+    TimeStamp end = getTimeNs();
+    if(PROFILE_RULES)
+        xRoundTripTime += end - start;
+    if(isTimelineEnabled())
+        addTimelineSpan(caller, "x-reply", start, end);
+}
+
 WindowID getPrivateWindow(void) {
     if(!compliantWindowManagerIndicatorWindow) {
         compliantWindowManagerIndicatorWindow = createOverrideRedirectWindow(XCB_WINDOW_CLASS_INPUT_ONLY);
@@ -111,6 +125,16 @@ int getAtomsFromMask(WindowMask mask, bool action, xcb_atom_t* arr) {
     return count;
 }
 
+/// AtomBindings added by addAtomsToCreate
+static ArrayList extraAtoms;
+void addAtomsToCreate(const AtomBinding* bindings, int num) {
+    for(int i = 0; i < num; i++)
+        if(getIndexOfPtr(&extraAtoms, &bindings[i]) == -1)
+            addElement(&extraAtoms, (void*)&bindings[i]);
+    if(ewmh)
+        createAtoms(bindings, num);
+}
+
 bool hasXConnectionBeenOpened() {
     return dis ? 1 : 0;
 }
@@ -127,30 +151,38 @@ void openXDisplay(void) {
     bool applyRule = ewmh == NULL;
     ewmh = (xcb_ewmh_connection_t*)malloc(sizeof(xcb_ewmh_connection_t));
     cookie = xcb_ewmh_init_atoms(dis, ewmh);
+    char wmSelectionName[32], mpxSelectionName[32];
+    sprintf(wmSelectionName, "WM_S%d", defaultScreenNumber);
+    sprintf(mpxSelectionName, "MPX_WM_S%d", defaultScreenNumber);
+    AtomBinding atoms[] = {
+        ATOM_BINDING(MPX_IDLE_PROPERTY),
+        ATOM_BINDING(MPX_RESTART_COUNTER),
+        ATOM_BINDING(MPX_WM_INTERPROCESS_COM),
+        ATOM_BINDING(MPX_WM_INTERPROCESS_COM_STATUS),
+        ATOM_BINDING(MPX_WM_STATE_CENTER_X),
+        ATOM_BINDING(MPX_WM_STATE_CENTER_Y),
+        ATOM_BINDING(MPX_WM_STATE_NO_TILE),
+        ATOM_BINDING(MPX_WM_STATE_ROOT_FULLSCREEN),
+        ATOM_BINDING(OPTION_NAME),
+        ATOM_BINDING(OPTION_VALUES),
+        ATOM_BINDING(WM_CHANGE_STATE),
+        ATOM_BINDING(WM_DELETE_WINDOW),
+        ATOM_BINDING(WM_STATE),
+        ATOM_BINDING(WM_WINDOW_ROLE),
+        {wmSelectionName, &WM_SELECTION_ATOM},
+        {mpxSelectionName, &MPX_WM_SELECTION_ATOM},
+    };
+    AtomBinding allAtoms[LEN(atoms) + extraAtoms.size];
+    memcpy(allAtoms, atoms, sizeof(atoms));
+    for(int i = 0; i < extraAtoms.size; i++)
+        allAtoms[LEN(atoms) + i] = *(AtomBinding*)getElement(&extraAtoms, i);
+    // our requests are queued behind the EWMH ones so all atoms are interned with a single round trip
+    createAtoms(allAtoms, LEN(allAtoms));
     xcb_ewmh_init_atoms_replies(ewmh, cookie, NULL);
-    CREATE_ATOM(MPX_IDLE_PROPERTY);
-    CREATE_ATOM(MPX_RESTART_COUNTER);
-    CREATE_ATOM(MPX_WM_INTERPROCESS_COM);
-    CREATE_ATOM(MPX_WM_INTERPROCESS_COM_STATUS);
-    CREATE_ATOM(MPX_WM_STATE_CENTER_X);
-    CREATE_ATOM(MPX_WM_STATE_CENTER_Y);
-    CREATE_ATOM(MPX_WM_STATE_NO_TILE);
-    CREATE_ATOM(MPX_WM_STATE_ROOT_FULLSCREEN);
-    CREATE_ATOM(OPTION_NAME);
-    CREATE_ATOM(OPTION_VALUES);
-    CREATE_ATOM(WM_CHANGE_STATE);
-    CREATE_ATOM(WM_DELETE_WINDOW);
-    CREATE_ATOM(WM_STATE);
-    CREATE_ATOM(WM_WINDOW_ROLE);
     screen = ewmh->screens[0];
 
     setRootDims(screen->width_in_pixels, screen->height_in_pixels);
     root = screen->root;
-    char selectionName[32];
-    sprintf(selectionName, "WM_S%d", defaultScreenNumber);
-    WM_SELECTION_ATOM = getAtom(selectionName);
-    sprintf(selectionName, "MPX_WM_S%d", defaultScreenNumber);
-    MPX_WM_SELECTION_ATOM = getAtom(selectionName);
     compliantWindowManagerIndicatorWindow = 0;
     createMaskAtomMapping();
     if(applyRule)
@@ -163,6 +195,8 @@ void closeConnection(void) {
         xcb_ewmh_connection_wipe(ewmh);
         free(ewmh);
         ewmh = NULL;
+        clearAtomCache();
+        clearErrorHandlers();
         compliantWindowManagerIndicatorWindow = 0;
         xcb_disconnect(dis);
     }
@@ -11,6 +11,8 @@
 #include "../mywm-structs.h"
 #include "../util/rect.h"
 #include "../util/string-array.h"
+#include "../util/time.h"
+#include "../util/timeline.h"
 #include "../window-masks.h"
 #include <string.h>
 #include <xcb/xcb_ewmh.h>
@@ -28,6 +30,18 @@
  * @param name the name of the atom to init
  */
 #define CREATE_ATOM(name)name=getAtom(# name);
+/// An atom to be interned with createAtoms
+typedef struct AtomBinding {
+    /// the name of the atom
+    const char* name;
+    /// where to store the atom
+    xcb_atom_t* atom;
+} AtomBinding;
+/**
+ * Shorthand to bind an atom variable to its own name
+ * @param name the variable to init
+ */
+#define ATOM_BINDING(name) {# name, &name}
 /**
  * The max number of master devices the XServer can support.
  *
@@ -39,8 +53,64 @@
 /// the default screen index
 extern const int defaultScreenNumber;
 
+#if !defined(NO_RULE_PROFILER) || !defined(NO_TIMELINE)
+/**
+ * Evaluates CALL, a call that waits for the reply to a request whose round trip has already been counted.
+ * While PROFILE_RULES is set, the time spent blocked is added to getXRoundTripTime and while a timeline is being
+ * written, the wait is added as a span named after the calling function
+ */
+#define X_REPLY(CALL) ({ \
+        TimeStamp __start = PROFILE_RULES || isTimelineEnabled() ? getTimeNs() : 0; \
+        __typeof__(CALL) __result = CALL; \
+        if(__start) \
+            endXRoundTrip(__start, __func__); \
+        __result; \
+    })
+#else
+#define X_REPLY(CALL) (CALL)
+#endif
+/// the number of times the WM has waited on the X server
+extern uint32_t numberOfXRoundTrips;
+/// the sequence number of the newest request passed to trackRequest
+extern uint32_t lastTrackedRequestSequence;
+/**
+ * Records that the request of cookie was sent, so the number of requests sent so far is known without sending another
+ * request just to read the current sequence number.
+ * Only requests sent through XCALL, onXError and the xutil send functions are tracked, so it is a lower bound
+ *
+ * @return cookie
+ */
+static inline xcb_void_cookie_t trackRequest(xcb_void_cookie_t cookie) {
+    if((int32_t)(cookie.sequence - lastTrackedRequestSequence) > 0)
+        lastTrackedRequestSequence = cookie.sequence;
+    return cookie;
+}
+/**
+ * Counts a round trip for a group of requests that were sent together; their replies should then be collected with
+ * X_REPLY
+ */
+static inline void countXRoundTrip(void) {
+    numberOfXRoundTrips++;
+}
+/**
+ * Evaluates CALL, a call that blocks waiting for a reply from the X server, and counts it as a round trip
+ * @see X_REPLY
+ */
+#define X_ROUND_TRIP(CALL) (countXRoundTrip(), X_REPLY(CALL))
+/**
+ * @return the total time (ns) spent in X_ROUND_TRIP calls while PROFILE_RULES was set
+ */
+TimeStamp getXRoundTripTime(void);
+/**
+ * Accounts for a round trip that started at start and just finished
+ * @param start time (ns)
+ * @param caller the function that waited
+ */
+void endXRoundTrip(TimeStamp start, const char* caller);
+
 /**
- * The value of this property is the idle counter
+ * The value of this property is the idle counter followed by the number of X events processed, the number of X
+ * requests sent by the WM and the number of round trips it made
  */
 extern xcb_atom_t MPX_IDLE_PROPERTY;
 
@@ -138,15 +208,50 @@ static inline void flush(void) {
  * @return
  */
 xcb_atom_t getAtom(const char* name);
+/**
+ * Interns every atom in bindings with at most one round trip.
+ * Atoms are cached for the lifetime of the connection so names that are already known are not requested
+ *
+ * @param bindings
+ * @param num
+ */
+void createAtoms(const AtomBinding* bindings, int num);
+/**
+ * Adds atoms to be interned, in the same round trip as the WM's own atoms, every time the X connection is opened.
+ * They are interned immediately if the connection is already open
+ *
+ * @param bindings must remain valid for the life of the program
+ * @param num
+ */
+void addAtomsToCreate(const AtomBinding* bindings, int num);
+/**
+ * @param atom
+ * @return the name of atom if it is cached or NULL
+ */
+const char* getCachedAtomName(xcb_atom_t atom);
+/**
+ * Forgets every cached atom; atoms are only valid for the X server they were interned on
+ */
+void clearAtomCache(void);
 /**
  * Returns a name for the given atom and stores the pointer in value
  *
- * Note that an atom can have multiple names and this method just returns one of them
+ * Note that an atom can have multiple names and this method just returns one of them.
+ * Only the first lookup of an atom requires a round trip
  *
  * @param atom the atom whose name is wanted
  * @return the name of the atom
  */
 char* getAtomName(xcb_atom_t atom, char* buffer);
+/**
+ * Like getAtomName but for a request that has already been sent; the round trip is not counted
+ *
+ * @param atom
+ * @param cookie the result of xcb_get_atom_name(atom)
+ * @param buffer
+ * @return buffer
+ */
+char* getAtomNameReply(xcb_atom_t atom, xcb_get_atom_name_cookie_t cookie, char* buffer);
 
 /**
  *
@@ -200,8 +305,38 @@ int catchErrorSilent(xcb_void_cookie_t cookie);
  * @see logError
  */
 int catchError(xcb_void_cookie_t cookie);
+/// max number of requests that can be waiting for a possible error at once
+#define MAX_PENDING_ERROR_HANDLERS 256
+/**
+ * Called when a request registered with onXError fails
+ *
+ * @param e the error
+ * @param arg the value passed to onXError
+ */
+typedef void (*ErrorHandler)(xcb_generic_error_t* e, void* arg);
+/**
+ * Registers handler to be called if the request that returned cookie fails.
+ *
+ * Unlike catchError, this doesn't block. The request should be sent unchecked so the error arrives with the other
+ * events; logError then passes it to handler. Nothing is called if the request succeeds; the handler is forgotten
+ * once an event for a later request has been processed.
+ * If more than MAX_PENDING_ERROR_HANDLERS requests are waiting, the oldest handler is dropped.
+ *
+ * @param cookie the result of an unchecked xcb function
+ * @param handler
+ * @param arg passed to handler
+ */
+void onXError(xcb_void_cookie_t cookie, ErrorHandler handler, void* arg);
 /**
- * Prints info related to the error
+ * @return the number of requests registered with onXError that may still fail
+ */
+uint32_t getNumberOfPendingErrorHandlers(void);
+/**
+ * Forgets all handlers registered with onXError
+ */
+void clearErrorHandlers(void);
+/**
+ * Prints info related to the error and passes it to the handler registered with onXError for its request if any
  *
  * It may trigger an assert; @see CRASH_ON_ERRORS
  *
@@ -275,11 +410,11 @@ void unmapWindow(WindowID id);
  * Destroys win but not the underlying client.
  * The underlying client may choose to die if win is closed.
  *
- * @param win
+ * The request is not checked; any error will be logged when it arrives
  *
- * @return 0 on success or the error
+ * @param win
  */
-int destroyWindow(WindowID win);
+void destroyWindow(WindowID win);
 
 void destroyWindowInfo(WindowInfo* winInfo);
 
@@ -325,9 +460,9 @@ bool getWindowPropertyStrings(WindowID win, xcb_atom_t atom, xcb_atom_t type, ch
 
 /// When NDEBUG is set XCALL will call the checked version of X and check for errors
 #ifndef NDEBUG
-#define XCALL(X, args...) catchError(_CAT(X,_checked)(args))
+#define XCALL(X, args...) catchError(trackRequest(_CAT(X,_checked)(args)))
 #else
-#define XCALL(X, args...) X(args)
+#define XCALL(X, args...) trackRequest(X(args))
 #endif
 /**
  *